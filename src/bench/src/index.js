@@ -0,0 +1,19 @@
+import {run} from "@yaje/bench";
+
+import "./suites/property.js";
+import "./suites/calls.js";
+import "./suites/arrays.js";
+import "./suites/strings.js";
+import "./suites/regex.js";
+import "./suites/json.js";
+import "./suites/collections.js";
+import "./suites/promise.js";
+import "./suites/gc.js";
+import "./suites/io.js";
+import "./suites/richards.js";
+import "./suites/deltablue.js";
+import {verifyNavierStokes} from "./suites/navier-stokes.js";
+
+verifyNavierStokes();
+
+await run();
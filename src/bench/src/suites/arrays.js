@@ -0,0 +1,111 @@
+import {bench, group} from "@yaje/bench";
+
+const SIZE = 10000;
+
+const ints = [];
+const doubles = [];
+for (let i = 0; i < SIZE; i++) {
+    ints.push((i * 7919) % SIZE);
+    doubles.push(i * 0.5);
+}
+
+const float64 = new Float64Array(SIZE);
+const int32 = new Int32Array(SIZE);
+for (let i = 0; i < SIZE; i++) {
+    float64[i] = i * 0.5;
+    int32[i] = i;
+}
+
+group("array", () => {
+    bench("push and pop", () => {
+        const array = [];
+        for (let i = 0; i < 1000; i++) {
+            array.push(i);
+        }
+        while (array.length > 0) {
+            array.pop();
+        }
+    });
+
+    bench("indexed sum", () => {
+        let sum = 0;
+        for (let i = 0; i < ints.length; i++) {
+            sum += ints[i];
+        }
+        return sum;
+    });
+
+    bench("for-of sum", () => {
+        let sum = 0;
+        for (const value of ints) {
+            sum += value;
+        }
+        return sum;
+    });
+
+    bench("forEach", () => {
+        let sum = 0;
+        ints.forEach(value => {
+            sum += value;
+        });
+        return sum;
+    });
+
+    bench("map filter reduce", () => {
+        return doubles
+            .map(value => value * 2)
+            .filter(value => value > 100)
+            .reduce((sum, value) => sum + value, 0);
+    });
+
+    bench("sort numbers", () => ints.slice().sort((a, b) => a - b));
+
+    bench("indexOf", () => ints.indexOf(-1));
+
+    bench("includes", () => doubles.includes(-1));
+
+    bench("spread copy", () => [...ints]);
+
+    bench("slice", () => ints.slice(100, 9000));
+
+    bench("join", () => ints.join(","));
+
+    bench("destructuring", () => {
+        let sum = 0;
+        for (let i = 0; i < 1000; i++) {
+            const [a, b, c] = ints;
+            sum += a + b + c;
+        }
+        return sum;
+    });
+});
+
+group("typedarray", () => {
+    bench("Float64Array sum", () => {
+        let sum = 0;
+        for (let i = 0; i < float64.length; i++) {
+            sum += float64[i];
+        }
+        return sum;
+    });
+
+    bench("Int32Array write", () => {
+        for (let i = 0; i < int32.length; i++) {
+            int32[i] = i ^ 0x55;
+        }
+    });
+
+    bench("fill", () => float64.fill(1.5));
+
+    bench("set", () => int32.set(ints));
+
+    bench("sort", () => float64.slice().sort());
+
+    bench("subarray", () => {
+        let last;
+        for (let i = 0; i < 1000; i++) {
+            last = int32.subarray(i, i + 16);
+        }
+        return last;
+    });
+});
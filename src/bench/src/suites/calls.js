@@ -0,0 +1,119 @@
+import {bench, group} from "@yaje/bench";
+
+function add(a, b) {
+    return a + b;
+}
+
+function fib(n) {
+    return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+function sumArguments() {
+    let sum = 0;
+    for (let i = 0; i < arguments.length; i++) {
+        sum += arguments[i];
+    }
+    return sum;
+}
+
+function sumRest(...values) {
+    let sum = 0;
+    for (let i = 0; i < values.length; i++) {
+        sum += values[i];
+    }
+    return sum;
+}
+
+class Counter {
+    constructor() {
+        this.count = 0;
+    }
+
+    increment() {
+        this.count++;
+    }
+}
+
+function makeAdder(n) {
+    return (x) => x + n;
+}
+
+const counter = new Counter();
+const bound = add.bind(null, 1);
+const adder = makeAdder(1);
+
+group("calls", () => {
+    bench("function", () => {
+        let sum = 0;
+        for (let i = 0; i < 1000; i++) {
+            sum = add(sum, i);
+        }
+        return sum;
+    });
+
+    bench("method", () => {
+        for (let i = 0; i < 1000; i++) {
+            counter.increment();
+        }
+    });
+
+    bench("recursive fib(20)", () => fib(20));
+
+    bench("arguments", () => {
+        let sum = 0;
+        for (let i = 0; i < 1000; i++) {
+            sum += sumArguments(i, 1, 2, 3);
+        }
+        return sum;
+    });
+
+    bench("rest parameters", () => {
+        let sum = 0;
+        for (let i = 0; i < 1000; i++) {
+            sum += sumRest(i, 1, 2, 3);
+        }
+        return sum;
+    });
+
+    bench("spread call", () => {
+        const args = [1, 2];
+        let sum = 0;
+        for (let i = 0; i < 1000; i++) {
+            sum += add(...args);
+        }
+        return sum;
+    });
+
+    bench("bound function", () => {
+        let sum = 0;
+        for (let i = 0; i < 1000; i++) {
+            sum += bound(i);
+        }
+        return sum;
+    });
+
+    bench("closure call", () => {
+        let sum = 0;
+        for (let i = 0; i < 1000; i++) {
+            sum += adder(i);
+        }
+        return sum;
+    });
+
+    bench("closure creation", () => {
+        let last;
+        for (let i = 0; i < 1000; i++) {
+            last = makeAdder(i);
+        }
+        return last;
+    });
+
+    bench("mutable capture", () => {
+        let count = 0;
+        const increment = () => count++;
+        for (let i = 0; i < 1000; i++) {
+            increment();
+        }
+        return count;
+    });
+});
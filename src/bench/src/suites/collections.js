@@ -0,0 +1,102 @@
+import {bench, group} from "@yaje/bench";
+
+const SIZE = 1000;
+
+const keys = [];
+for (let i = 0; i < SIZE; i++) {
+    keys.push("key" + i);
+}
+
+const filledMap = new Map();
+const filledSet = new Set();
+for (let i = 0; i < SIZE; i++) {
+    filledMap.set(keys[i], i);
+    filledSet.add(i);
+}
+
+group("collections", () => {
+    bench("Map set int", () => {
+        const map = new Map();
+        for (let i = 0; i < SIZE; i++) {
+            map.set(i, i);
+        }
+        return map;
+    });
+
+    bench("Map set string", () => {
+        const map = new Map();
+        for (let i = 0; i < SIZE; i++) {
+            map.set(keys[i], i);
+        }
+        return map;
+    });
+
+    bench("Map get", () => {
+        let sum = 0;
+        for (let i = 0; i < SIZE; i++) {
+            sum += filledMap.get(keys[i]);
+        }
+        return sum;
+    });
+
+    bench("Map iterate", () => {
+        let sum = 0;
+        for (const [, value] of filledMap) {
+            sum += value;
+        }
+        return sum;
+    });
+
+    bench("Map delete", () => {
+        const map = new Map(filledMap);
+        for (let i = 0; i < SIZE; i++) {
+            map.delete(keys[i]);
+        }
+        return map;
+    });
+
+    bench("Set add", () => {
+        const set = new Set();
+        for (let i = 0; i < SIZE; i++) {
+            set.add(i);
+        }
+        return set;
+    });
+
+    bench("Set has", () => {
+        let count = 0;
+        for (let i = 0; i < SIZE * 2; i++) {
+            if (filledSet.has(i)) {
+                count++;
+            }
+        }
+        return count;
+    });
+
+    bench("Set iterate", () => {
+        let sum = 0;
+        for (const value of filledSet) {
+            sum += value;
+        }
+        return sum;
+    });
+
+    bench("WeakMap", () => {
+        const map = new WeakMap();
+        const objects = [];
+        for (let i = 0; i < SIZE; i++) {
+            const object = {};
+            objects.push(object);
+            map.set(object, i);
+        }
+        return map;
+    });
+
+    bench("object as map", () => {
+        const object = {};
+        for (let i = 0; i < SIZE; i++) {
+            object[keys[i]] = i;
+        }
+        return object;
+    });
+});
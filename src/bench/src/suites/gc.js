@@ -0,0 +1,88 @@
+import {bench, gc, group} from "@yaje/bench";
+
+class Node {
+    constructor(value, next) {
+        this.value = value;
+        this.next = next;
+    }
+}
+
+class TreeNode {
+    constructor(left, right) {
+        this.left = left;
+        this.right = right;
+    }
+}
+
+function buildTree(depth) {
+    return depth == 0 ? new TreeNode(null, null) : new TreeNode(buildTree(depth - 1), buildTree(depth - 1));
+}
+
+function checkTree(node) {
+    return node.left == null ? 1 : 1 + checkTree(node.left) + checkTree(node.right);
+}
+
+// Survives all benchmarks, so every collection has to walk it
+const retained = [];
+for (let i = 0; i < 10000; i++) {
+    retained.push({index: i, payload: [i, i + 1]});
+}
+
+group("gc", () => {
+    bench("short lived objects", () => {
+        let last;
+        for (let i = 0; i < 1000; i++) {
+            last = {a: i, b: [i], c: {d: i}};
+        }
+        return last;
+    });
+
+    bench("linked list", () => {
+        let head = null;
+        for (let i = 0; i < 1000; i++) {
+            head = new Node(i, head);
+        }
+        return head;
+    });
+
+    bench("binary trees", () => checkTree(buildTree(10)));
+
+    bench("cyclic garbage", () => {
+        for (let i = 0; i < 1000; i++) {
+            const a = {};
+            const b = {a};
+            a.b = b;
+        }
+    });
+
+    bench("string garbage", () => {
+        let last;
+        for (let i = 0; i < 1000; i++) {
+            last = "item-" + i + "-" + (i * 3);
+        }
+        return last;
+    });
+
+    bench("closure garbage", () => {
+        let last;
+        for (let i = 0; i < 1000; i++) {
+            const captured = [i];
+            last = () => captured;
+        }
+        return last;
+    });
+
+    bench("array growth", () => {
+        const arrays = [];
+        for (let i = 0; i < 100; i++) {
+            const array = [];
+            for (let j = 0; j < 100; j++) {
+                array.push(j);
+            }
+            arrays.push(array);
+        }
+        return arrays;
+    });
+
+    bench("full collection", () => gc(), {gc: false});
+});
@@ -0,0 +1,131 @@
+import {bench, getenv, group, redirectStdout, restoreStdout} from "@yaje/bench";
+import {readFileSync, sync, writeFileSync} from "@yaje/fs";
+
+const KB = 1024;
+const MB = 1024 * KB;
+const GB = 1024 * MB;
+
+const SIZES = [
+    ["1KB", KB],
+    ["64KB", 64 * KB],
+    ["1MB", MB],
+    ["16MB", 16 * MB],
+    ["256MB", 256 * MB],
+    ["1GB", GB],
+    ["10GB", 10 * GB]
+];
+
+// QuickJS strings are limited to 2^30 - 1 characters, larger files can only be streamed
+const MAX_STRING_SIZE = 256 * MB;
+const CHUNK_SIZE = MB;
+
+function parseSize(value) {
+    const match = /^(\d+)\s*([KMG]?)B?$/i.exec(value);
+    if (!match) {
+        throw new Error(`Invalid size '${value}'`);
+    }
+
+    const units = {"": 1, K: KB, M: MB, G: GB};
+    return Number(match[1]) * units[match[2].toUpperCase()];
+}
+
+// Large sizes need a lot of disk space and time, so they have to be requested explicitly
+const maxSize = parseSize(getenv("YAJE_BENCH_IO_MAX") ?? "16M");
+const directory = getenv("YAJE_BENCH_IO_DIR") ?? getenv("TMPDIR") ?? getenv("TEMP") ?? "/tmp";
+const dataFile = `${directory}/yaje-bench-io.tmp`;
+const consoleFile = `${directory}/yaje-bench-console.tmp`;
+
+function streamWrite(size) {
+    const chunk = "x".repeat(Math.min(size, CHUNK_SIZE));
+    const fd = sync.native.open(dataFile, "w");
+    for (let written = 0; written < size; written += chunk.length) {
+        sync.native.write(fd, chunk);
+    }
+    sync.native.close(fd);
+}
+
+function streamRead() {
+    const fd = sync.native.open(dataFile, "r");
+    let length = 0;
+    let chunk;
+    do {
+        chunk = sync.native.read(fd, CHUNK_SIZE);
+        length += chunk.length;
+    } while (chunk.length == CHUNK_SIZE);
+    sync.native.close(fd);
+    return length;
+}
+
+// Frees the disk space of the data file, the fs module has no unlink yet
+function truncate(file) {
+    writeFileSync(file, "");
+}
+
+function options(size, extra = {}) {
+    const base = {bytes: size, teardown: () => truncate(dataFile)};
+    if (size >= MAX_STRING_SIZE) {
+        // A single iteration takes seconds, calibration already serves as warmup
+        Object.assign(base, {warmup: 0, minSamples: 3, maxSamples: 3, gc: false});
+    }
+    return Object.assign(base, extra);
+}
+
+group("io", () => {
+    group("fs", () => {
+        for (const [label, size] of SIZES) {
+            if (size > maxSize) {
+                continue;
+            }
+
+            if (size <= MAX_STRING_SIZE) {
+                let content;
+                bench(`writeFileSync/${label}`, () => writeFileSync(dataFile, content), options(size, {
+                    setup: () => {
+                        content = "x".repeat(size);
+                    },
+                    teardown: () => {
+                        content = undefined;
+                        truncate(dataFile);
+                    }
+                }));
+
+                bench(`readFileSync/${label}`, () => readFileSync(dataFile), options(size, {
+                    setup: () => streamWrite(size)
+                }));
+            }
+
+            bench(`native write/${label}`, () => streamWrite(size), options(size));
+
+            bench(`native read/${label}`, () => streamRead(), options(size, {
+                setup: () => streamWrite(size)
+            }));
+        }
+    });
+
+    group("console", () => {
+        // 80 bytes per line including the newline
+        const line = "x".repeat(79);
+        const parts = ["x".repeat(26), "x".repeat(26), "x".repeat(25)];
+
+        bench("log/file", () => console.log(line), {
+            bytes: line.length + 1,
+            setup: () => redirectStdout(consoleFile),
+            teardown: () => {
+                restoreStdout();
+                truncate(consoleFile);
+            }
+        });
+
+        bench("log/pipe", () => console.log(line), {
+            bytes: line.length + 1,
+            setup: () => redirectStdout(),
+            teardown: () => restoreStdout()
+        });
+
+        bench("log 3 args/pipe", () => console.log(parts[0], parts[1], parts[2]), {
+            bytes: line.length + 1,
+            setup: () => redirectStdout(),
+            teardown: () => restoreStdout()
+        });
+    });
+});
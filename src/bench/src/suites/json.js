@@ -0,0 +1,36 @@
+import {bench, group} from "@yaje/bench";
+
+const small = {id: 1, name: "record", tags: ["a", "b", "c"], active: true, score: 12.5};
+
+const records = [];
+for (let i = 0; i < 1000; i++) {
+    records.push({
+        id: i,
+        name: `record ${i}`,
+        email: `user${i}@example.com`,
+        tags: ["alpha", "beta", "gamma"].slice(0, i % 3 + 1),
+        active: i % 2 == 0,
+        score: i * 1.25,
+        nested: {created: "2024-01-01T00:00:00Z", revision: i % 7}
+    });
+}
+
+const smallText = JSON.stringify(small);
+const largeText = JSON.stringify(records);
+const prettyText = JSON.stringify(records, null, 4);
+
+group("json", () => {
+    bench("parse small", () => JSON.parse(smallText));
+
+    bench("parse large", () => JSON.parse(largeText));
+
+    bench("parse pretty", () => JSON.parse(prettyText));
+
+    bench("stringify small", () => JSON.stringify(small));
+
+    bench("stringify large", () => JSON.stringify(records));
+
+    bench("stringify pretty", () => JSON.stringify(records, null, 4));
+
+    bench("parse reviver", () => JSON.parse(largeText, (key, value) => value));
+});
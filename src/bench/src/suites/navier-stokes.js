@@ -0,0 +1,351 @@
+// Port of the NavierStokes benchmark from the V8 benchmark suite (BSD license), a 2D fluid
+// solver by Oliver Hunt based on Jos Stam's "Real-Time Fluid Dynamics for Games".
+
+import {bench, group} from "@yaje/bench";
+
+function FluidField() {
+    let iterations = 10;
+    const dt = 0.1;
+    let dens;
+    let densPrev;
+    let u;
+    let uPrev;
+    let v;
+    let vPrev;
+    let width;
+    let height;
+    let rowSize;
+    let size;
+    let uiCallback = function () {};
+
+    function addFields(x, s, dt) {
+        for (let i = 0; i < size; i++) {
+            x[i] += dt * s[i];
+        }
+    }
+
+    function setBoundary(b, x) {
+        if (b === 1) {
+            for (let i = 1; i <= width; i++) {
+                x[i] = x[i + rowSize];
+                x[i + (height + 1) * rowSize] = x[i + height * rowSize];
+            }
+
+            for (let j = 1; j <= height; j++) {
+                x[j * rowSize] = -x[1 + j * rowSize];
+                x[(width + 1) + j * rowSize] = -x[width + j * rowSize];
+            }
+        } else if (b === 2) {
+            for (let i = 1; i <= width; i++) {
+                x[i] = -x[i + rowSize];
+                x[i + (height + 1) * rowSize] = -x[i + height * rowSize];
+            }
+
+            for (let j = 1; j <= height; j++) {
+                x[j * rowSize] = x[1 + j * rowSize];
+                x[(width + 1) + j * rowSize] = x[width + j * rowSize];
+            }
+        } else {
+            for (let i = 1; i <= width; i++) {
+                x[i] = x[i + rowSize];
+                x[i + (height + 1) * rowSize] = x[i + height * rowSize];
+            }
+
+            for (let j = 1; j <= height; j++) {
+                x[j * rowSize] = x[1 + j * rowSize];
+                x[(width + 1) + j * rowSize] = x[width + j * rowSize];
+            }
+        }
+        const maxEdge = (height + 1) * rowSize;
+        x[0] = 0.5 * (x[1] + x[rowSize]);
+        x[maxEdge] = 0.5 * (x[1 + maxEdge] + x[height * rowSize]);
+        x[(width + 1)] = 0.5 * (x[width] + x[(width + 1) + rowSize]);
+        x[(width + 1) + maxEdge] = 0.5 * (x[width + maxEdge] + x[(width + 1) + height * rowSize]);
+    }
+
+    function linearSolve(b, x, x0, a, c) {
+        if (a === 0 && c === 1) {
+            for (let j = 1; j <= height; j++) {
+                let currentRow = j * rowSize;
+                ++currentRow;
+                for (let i = 0; i < width; i++) {
+                    x[currentRow] = x0[currentRow];
+                    ++currentRow;
+                }
+            }
+            setBoundary(b, x);
+        } else {
+            const invC = 1 / c;
+            for (let k = 0; k < iterations; k++) {
+                for (let j = 1; j <= height; j++) {
+                    let lastRow = (j - 1) * rowSize;
+                    let currentRow = j * rowSize;
+                    let nextRow = (j + 1) * rowSize;
+                    let lastX = x[currentRow];
+                    ++currentRow;
+                    for (let i = 1; i <= width; i++) {
+                        lastX = x[currentRow] = (x0[currentRow] + a * (lastX + x[++currentRow] + x[++lastRow] + x[++nextRow])) * invC;
+                    }
+                }
+                setBoundary(b, x);
+            }
+        }
+    }
+
+    function diffuse(b, x, x0, dt) {
+        const a = 0;
+        linearSolve(b, x, x0, a, 1 + 4 * a);
+    }
+
+    function linearSolve2(x, x0, y, y0, a, c) {
+        if (a === 0 && c === 1) {
+            for (let j = 1; j <= height; j++) {
+                let currentRow = j * rowSize;
+                ++currentRow;
+                for (let i = 0; i < width; i++) {
+                    x[currentRow] = x0[currentRow];
+                    y[currentRow] = y0[currentRow];
+                    ++currentRow;
+                }
+            }
+            setBoundary(1, x);
+            setBoundary(2, y);
+        } else {
+            const invC = 1 / c;
+            for (let k = 0; k < iterations; k++) {
+                for (let j = 1; j <= height; j++) {
+                    let lastRow = (j - 1) * rowSize;
+                    let currentRow = j * rowSize;
+                    let nextRow = (j + 1) * rowSize;
+                    let lastX = x[currentRow];
+                    let lastY = y[currentRow];
+                    ++currentRow;
+                    for (let i = 1; i <= width; i++) {
+                        lastX = x[currentRow] = (x0[currentRow] + a * (lastX + x[currentRow] + x[lastRow] + x[nextRow])) * invC;
+                        lastY = y[currentRow] = (y0[currentRow] + a * (lastY + y[++currentRow] + y[++lastRow] + y[++nextRow])) * invC;
+                    }
+                }
+                setBoundary(1, x);
+                setBoundary(2, y);
+            }
+        }
+    }
+
+    function diffuse2(x, x0, y, y0, dt) {
+        const a = 0;
+        linearSolve2(x, x0, y, y0, a, 1 + 4 * a);
+    }
+
+    function advect(b, d, d0, u, v, dt) {
+        const wdt0 = dt * width;
+        const hdt0 = dt * height;
+        const wp5 = width + 0.5;
+        const hp5 = height + 0.5;
+        for (let j = 1; j <= height; j++) {
+            let pos = j * rowSize;
+            for (let i = 1; i <= width; i++) {
+                let x = i - wdt0 * u[++pos];
+                let y = j - hdt0 * v[pos];
+                if (x < 0.5) {
+                    x = 0.5;
+                } else if (x > wp5) {
+                    x = wp5;
+                }
+                const i0 = x | 0;
+                const i1 = i0 + 1;
+                if (y < 0.5) {
+                    y = 0.5;
+                } else if (y > hp5) {
+                    y = hp5;
+                }
+                const j0 = y | 0;
+                const j1 = j0 + 1;
+                const s1 = x - i0;
+                const s0 = 1 - s1;
+                const t1 = y - j0;
+                const t0 = 1 - t1;
+                const row1 = j0 * rowSize;
+                const row2 = j1 * rowSize;
+                d[pos] = s0 * (t0 * d0[i0 + row1] + t1 * d0[i0 + row2]) + s1 * (t0 * d0[i1 + row1] + t1 * d0[i1 + row2]);
+            }
+        }
+        setBoundary(b, d);
+    }
+
+    function project(u, v, p, div) {
+        const h = -0.5 / Math.sqrt(width * height);
+        for (let j = 1; j <= height; j++) {
+            const row = j * rowSize;
+            let previousRow = (j - 1) * rowSize;
+            let prevValue = row - 1;
+            let currentRow = row;
+            let nextValue = row + 1;
+            let nextRow = (j + 1) * rowSize;
+            for (let i = 1; i <= width; i++) {
+                div[++currentRow] = h * (u[++nextValue] - u[++prevValue] + v[++nextRow] - v[++previousRow]);
+                p[currentRow] = 0;
+            }
+        }
+        setBoundary(0, div);
+        setBoundary(0, p);
+
+        linearSolve(0, p, div, 1, 4);
+        const wScale = 0.5 * width;
+        const hScale = 0.5 * height;
+        for (let j = 1; j <= height; j++) {
+            let prevPos = j * rowSize - 1;
+            let currentPos = j * rowSize;
+            let nextPos = j * rowSize + 1;
+            let prevRow = (j - 1) * rowSize;
+            let nextRow = (j + 1) * rowSize;
+
+            for (let i = 1; i <= width; i++) {
+                u[++currentPos] -= wScale * (p[++nextPos] - p[++prevPos]);
+                v[currentPos] -= hScale * (p[++nextRow] - p[++prevRow]);
+            }
+        }
+        setBoundary(1, u);
+        setBoundary(2, v);
+    }
+
+    function densityStep(x, x0, u, v, dt) {
+        addFields(x, x0, dt);
+        diffuse(0, x0, x, dt);
+        advect(0, x, x0, u, v, dt);
+    }
+
+    function velocityStep(u, v, u0, v0, dt) {
+        addFields(u, u0, dt);
+        addFields(v, v0, dt);
+        let temp = u0;
+        u0 = u;
+        u = temp;
+        temp = v0;
+        v0 = v;
+        v = temp;
+        diffuse2(u, u0, v, v0, dt);
+        project(u, v, u0, v0);
+        temp = u0;
+        u0 = u;
+        u = temp;
+        temp = v0;
+        v0 = v;
+        v = temp;
+        advect(1, u, u0, u0, v0, dt);
+        advect(2, v, v0, u0, v0, dt);
+        project(u, v, u0, v0);
+    }
+
+    function Field(dens, u, v) {
+        this.setDensity = function (x, y, d) {
+            dens[(x + 1) + (y + 1) * rowSize] = d;
+        };
+        this.setVelocity = function (x, y, xv, yv) {
+            u[(x + 1) + (y + 1) * rowSize] = xv;
+            v[(x + 1) + (y + 1) * rowSize] = yv;
+        };
+    }
+
+    function queryUI(d, u, v) {
+        for (let i = 0; i < size; i++) {
+            u[i] = v[i] = d[i] = 0.0;
+        }
+        uiCallback(new Field(d, u, v));
+    }
+
+    function reset() {
+        rowSize = width + 2;
+        size = (width + 2) * (height + 2);
+        dens = new Array(size);
+        densPrev = new Array(size);
+        u = new Array(size);
+        uPrev = new Array(size);
+        v = new Array(size);
+        vPrev = new Array(size);
+        for (let i = 0; i < size; i++) {
+            densPrev[i] = uPrev[i] = vPrev[i] = dens[i] = u[i] = v[i] = 0;
+        }
+    }
+
+    this.update = function () {
+        queryUI(densPrev, uPrev, vPrev);
+        velocityStep(u, v, uPrev, vPrev, dt);
+        densityStep(dens, densPrev, u, v, dt);
+    };
+    this.setIterations = function (iters) {
+        if (iters > 0 && iters <= 100) {
+            iterations = iters;
+        }
+    };
+    this.setUICallback = function (callback) {
+        uiCallback = callback;
+    };
+    this.getDens = function () {
+        return dens;
+    };
+    this.setResolution = function (hRes, wRes) {
+        const res = wRes * hRes;
+        if (res > 0 && res < 1000000 && (wRes != width || hRes != height)) {
+            width = wRes;
+            height = hRes;
+            reset();
+            return true;
+        }
+        return false;
+    };
+    this.setResolution(64, 64);
+}
+
+function createSolver() {
+    let framesTillAddingPoints = 0;
+    let framesBetweenAddingPoints = 5;
+
+    function addPoints(field) {
+        const n = 64;
+        for (let i = 1; i <= n; i++) {
+            field.setVelocity(i, i, n, n);
+            field.setDensity(i, i, 5);
+            field.setVelocity(i, n - i, -n, -n);
+            field.setDensity(i, n - i, 20);
+            field.setVelocity(128 - i, n + i, -n, -n);
+            field.setDensity(128 - i, n + i, 30);
+        }
+    }
+
+    const solver = new FluidField();
+    solver.setResolution(128, 128);
+    solver.setIterations(20);
+    solver.setUICallback(field => {
+        if (framesTillAddingPoints == 0) {
+            addPoints(field);
+            framesTillAddingPoints = framesBetweenAddingPoints;
+            framesBetweenAddingPoints++;
+        } else {
+            framesTillAddingPoints--;
+        }
+    });
+    return solver;
+}
+
+// Runs the reference 15 frames once and compares against the known checksum
+export function verifyNavierStokes() {
+    const solver = createSolver();
+    for (let frame = 0; frame < 15; frame++) {
+        solver.update();
+    }
+
+    const dens = solver.getDens();
+    let result = 0;
+    for (let i = 7000; i < 7100; i++) {
+        result += ~~(dens[i] * 10);
+    }
+    if (result != 77) {
+        throw new Error(`NavierStokes: checksum failed (${result})`);
+    }
+}
+
+const solver = createSolver();
+
+group("classic", () => {
+    bench("NavierStokes", () => solver.update());
+});
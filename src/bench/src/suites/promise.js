@@ -0,0 +1,59 @@
+import {bench, group} from "@yaje/bench";
+
+async function identity(value) {
+    return value;
+}
+
+async function awaitChain(count) {
+    let sum = 0;
+    for (let i = 0; i < count; i++) {
+        sum += await i;
+    }
+    return sum;
+}
+
+async function awaitPromises(count) {
+    let sum = 0;
+    for (let i = 0; i < count; i++) {
+        sum += await Promise.resolve(i);
+    }
+    return sum;
+}
+
+group("promise", () => {
+    bench("then chain", () => {
+        let promise = Promise.resolve(0);
+        for (let i = 0; i < 100; i++) {
+            promise = promise.then(value => value + 1);
+        }
+        return promise;
+    });
+
+    bench("await value", () => awaitChain(100));
+
+    bench("await promise", () => awaitPromises(100));
+
+    bench("async call", async () => {
+        let sum = 0;
+        for (let i = 0; i < 100; i++) {
+            sum += await identity(i);
+        }
+        return sum;
+    });
+
+    bench("Promise.all", () => {
+        const promises = [];
+        for (let i = 0; i < 100; i++) {
+            promises.push(identity(i));
+        }
+        return Promise.all(promises);
+    });
+
+    bench("new Promise", () => {
+        let last;
+        for (let i = 0; i < 100; i++) {
+            last = new Promise(resolve => resolve(i));
+        }
+        return last;
+    });
+});
@@ -0,0 +1,102 @@
+import {bench, group} from "@yaje/bench";
+
+class Point {
+    constructor(x, y) {
+        this.x = x;
+        this.y = y;
+    }
+}
+
+const points = [];
+for (let i = 0; i < 1000; i++) {
+    points.push(new Point(i, i * 2));
+}
+
+// Same properties, four different shapes
+const polymorphic = [];
+for (let i = 0; i < 1000; i++) {
+    switch (i & 3) {
+        case 0: polymorphic.push({x: i, y: i}); break;
+        case 1: polymorphic.push({y: i, x: i}); break;
+        case 2: polymorphic.push({x: i, y: i, z: i}); break;
+        default: polymorphic.push({w: i, x: i, y: i}); break;
+    }
+}
+
+class Base {
+    get value() {
+        return 1;
+    }
+}
+
+class Level1 extends Base {}
+class Level2 extends Level1 {}
+class Level3 extends Level2 {}
+
+const deep = new Level3();
+
+group("property", () => {
+    bench("get monomorphic", () => {
+        let sum = 0;
+        for (let i = 0; i < points.length; i++) {
+            sum += points[i].x;
+        }
+        return sum;
+    });
+
+    bench("get polymorphic", () => {
+        let sum = 0;
+        for (let i = 0; i < polymorphic.length; i++) {
+            sum += polymorphic[i].x;
+        }
+        return sum;
+    });
+
+    bench("set", () => {
+        for (let i = 0; i < points.length; i++) {
+            points[i].y = i;
+        }
+    });
+
+    bench("prototype getter", () => {
+        let sum = 0;
+        for (let i = 0; i < 1000; i++) {
+            sum += deep.value;
+        }
+        return sum;
+    });
+
+    bench("object literal", () => {
+        let last;
+        for (let i = 0; i < 1000; i++) {
+            last = {id: i, name: "record", active: true, score: i * 0.5};
+        }
+        return last;
+    });
+
+    bench("constructor", () => {
+        let last;
+        for (let i = 0; i < 1000; i++) {
+            last = new Point(i, i);
+        }
+        return last;
+    });
+
+    bench("add and delete", () => {
+        const bag = {};
+        for (let i = 0; i < 1000; i++) {
+            bag["key" + (i & 63)] = i;
+            delete bag["key" + ((i + 32) & 63)];
+        }
+        return bag;
+    });
+
+    bench("keyed access", () => {
+        const keys = ["x", "y"];
+        let sum = 0;
+        for (let i = 0; i < points.length; i++) {
+            sum += points[i][keys[i & 1]];
+        }
+        return sum;
+    });
+});
@@ -0,0 +1,46 @@
+import {bench, group} from "@yaje/bench";
+
+const lines = [];
+for (let i = 0; i < 200; i++) {
+    lines.push(`2024-01-${String(i % 28 + 1).padStart(2, "0")}T12:${String(i % 60).padStart(2, "0")}:00Z INFO user${i}@example.com request=/api/v1/items/${i} status=200`);
+}
+
+const log = lines.join("\n");
+const emailPattern = /^[\w.+-]+@[\w-]+\.[\w.]+$/;
+const linePattern = /^(\d{4})-(\d{2})-(\d{2})T[\d:]+Z (\w+) (\S+) request=(\S+) status=(\d+)$/;
+
+group("regex", () => {
+    bench("test", () => {
+        let count = 0;
+        for (let i = 0; i < 1000; i++) {
+            if (emailPattern.test("user" + i + "@example.com")) {
+                count++;
+            }
+        }
+        return count;
+    });
+
+    bench("exec groups", () => {
+        let last;
+        for (const line of lines) {
+            last = linePattern.exec(line);
+        }
+        return last;
+    });
+
+    bench("replace global", () => log.replace(/\d+/g, "#"));
+
+    bench("split", () => log.split(/\s+/));
+
+    bench("matchAll", () => {
+        let count = 0;
+        for (const match of log.matchAll(/user(\d+)@/g)) {
+            count += match[1].length;
+        }
+        return count;
+    });
+
+    bench("unicode", () => /\p{L}+/u.exec("Grüße, 世界! Привет"));
+
+    bench("compile", () => new RegExp("status=(\\d+)", "g"));
+});
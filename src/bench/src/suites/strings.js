@@ -0,0 +1,75 @@
+import {bench, group} from "@yaje/bench";
+
+const words = [];
+for (let i = 0; i < 1000; i++) {
+    words.push("word" + i);
+}
+
+const sentence = words.join(" ");
+const csvLine = words.slice(0, 50).join(",");
+
+group("string", () => {
+    bench("concat", () => {
+        let result = "";
+        for (let i = 0; i < 1000; i++) {
+            result += words[i];
+        }
+        return result;
+    });
+
+    bench("template literal", () => {
+        let last;
+        for (let i = 0; i < 1000; i++) {
+            last = `${words[i]}: ${i} (${i * 2})`;
+        }
+        return last;
+    });
+
+    bench("array join builder", () => {
+        const parts = [];
+        for (let i = 0; i < 1000; i++) {
+            parts.push(words[i]);
+        }
+        return parts.join("");
+    });
+
+    bench("split", () => csvLine.split(","));
+
+    bench("indexOf", () => sentence.indexOf("word999"));
+
+    bench("replaceAll", () => sentence.replaceAll("word", "w"));
+
+    bench("charCodeAt", () => {
+        let hash = 0;
+        for (let i = 0; i < sentence.length; i++) {
+            hash = (hash * 31 + sentence.charCodeAt(i)) | 0;
+        }
+        return hash;
+    });
+
+    bench("toUpperCase", () => sentence.toUpperCase());
+
+    bench("slice", () => {
+        let last;
+        for (let i = 0; i < 1000; i++) {
+            last = sentence.slice(i, i + 20);
+        }
+        return last;
+    });
+
+    bench("padStart", () => {
+        let last;
+        for (let i = 0; i < 1000; i++) {
+            last = String(i).padStart(8, "0");
+        }
+        return last;
+    });
+
+    bench("number to string", () => {
+        let last;
+        for (let i = 0; i < 1000; i++) {
+            last = (i * 1.5).toString();
+        }
+        return last;
+    });
+});
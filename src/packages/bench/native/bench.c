@@ -0,0 +1,291 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#include "quickjs.h"
+#include "cutils.h"
+#include "yaje.h"
+
+// All timestamps are reported relative to module initialisation, which keeps them exact as doubles
+static uint64_t bench_time_origin;
+
+// State of a redirected stdout, the original descriptor is kept to restore it
+static struct {
+    bool active;
+    int saved_fd;
+    bool draining;
+    int drain_fd;
+    js_thread_t drain_thread;
+} bench_stdout_redirect;
+
+static JSValue bench_now(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    return JS_NewFloat64(ctx, (double)(js__hrtime_ns() - bench_time_origin));
+}
+
+static JSValue bench_gc(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    JS_RunGC(JS_GetRuntime(ctx));
+    return JS_UNDEFINED;
+}
+
+static JSValue bench_get_gc_threshold(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    size_t threshold = JS_GetGCThreshold(JS_GetRuntime(ctx));
+    if (threshold == (size_t)-1) {
+        return JS_NewInt32(ctx, -1);
+    }
+
+    return JS_NewFloat64(ctx, (double)threshold);
+}
+
+static JSValue bench_set_gc_threshold(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    double threshold;
+
+    if (argc < 1) {
+        return JS_ThrowTypeError(ctx, "Expected 1 argument: threshold");
+    }
+
+    if (JS_ToFloat64(ctx, &threshold, argv[0])) {
+        return JS_EXCEPTION;
+    }
+
+    // A negative threshold disables the automatic collector
+    JS_SetGCThreshold(JS_GetRuntime(ctx), threshold < 0 ? (size_t)-1 : (size_t)threshold);
+    return JS_UNDEFINED;
+}
+
+static JSValue bench_memory_usage(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    JSMemoryUsage usage;
+    JSValue result;
+
+    JS_ComputeMemoryUsage(JS_GetRuntime(ctx), &usage);
+
+    result = JS_NewObject(ctx);
+    if (JS_IsException(result)) {
+        return JS_EXCEPTION;
+    }
+
+    JS_SetPropertyStr(ctx, result, "mallocSize", JS_NewInt64(ctx, usage.malloc_size));
+    JS_SetPropertyStr(ctx, result, "mallocCount", JS_NewInt64(ctx, usage.malloc_count));
+    JS_SetPropertyStr(ctx, result, "memoryUsedSize", JS_NewInt64(ctx, usage.memory_used_size));
+    JS_SetPropertyStr(ctx, result, "objectCount", JS_NewInt64(ctx, usage.obj_count));
+    JS_SetPropertyStr(ctx, result, "stringCount", JS_NewInt64(ctx, usage.str_count));
+    JS_SetPropertyStr(ctx, result, "shapeCount", JS_NewInt64(ctx, usage.shape_count));
+
+    return result;
+}
+
+static JSValue bench_getenv(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    const char *name;
+    const char *value;
+
+    if (argc < 1) {
+        return JS_ThrowTypeError(ctx, "Expected 1 argument: name");
+    }
+
+    name = JS_ToCString(ctx, argv[0]);
+    if (!name) {
+        return JS_EXCEPTION;
+    }
+
+    value = getenv(name);
+    JS_FreeCString(ctx, name);
+
+    if (!value) {
+        return JS_UNDEFINED;
+    }
+
+    return JS_NewString(ctx, value);
+}
+
+static JSValue bench_write(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    int stream;
+    const char *data;
+    size_t length;
+    FILE *file;
+
+    if (argc < 2) {
+        return JS_ThrowTypeError(ctx, "Expected 2 arguments: stream and data");
+    }
+
+    if (JS_ToInt32(ctx, &stream, argv[0])) {
+        return JS_EXCEPTION;
+    }
+
+    if (stream != 1 && stream != 2) {
+        return JS_ThrowRangeError(ctx, "Stream must be 1 (stdout) or 2 (stderr)");
+    }
+
+    data = JS_ToCStringLen(ctx, &length, argv[1]);
+    if (!data) {
+        return JS_EXCEPTION;
+    }
+
+    file = stream == 1 ? stdout : stderr;
+    fwrite(data, 1, length, file);
+    fflush(file);
+    JS_FreeCString(ctx, data);
+
+    return JS_UNDEFINED;
+}
+
+static JSValue bench_io_counters(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef __linux__
+    // Accounts every thread of the process, including the bytes that never reached the disk
+    FILE *file = fopen("/proc/self/io", "r");
+    char key[32];
+    int64_t value;
+    int64_t read_bytes = -1;
+    int64_t write_bytes = -1;
+    int64_t read_calls = -1;
+    int64_t write_calls = -1;
+    JSValue result;
+
+    if (!file) {
+        return JS_NULL;
+    }
+
+    while (fscanf(file, "%31[^:]: %" SCNd64 "\n", key, &value) == 2) {
+        if (strcmp(key, "rchar") == 0) {
+            read_bytes = value;
+        } else if (strcmp(key, "wchar") == 0) {
+            write_bytes = value;
+        } else if (strcmp(key, "syscr") == 0) {
+            read_calls = value;
+        } else if (strcmp(key, "syscw") == 0) {
+            write_calls = value;
+        }
+    }
+    fclose(file);
+
+    if (read_bytes < 0 || write_bytes < 0 || read_calls < 0 || write_calls < 0) {
+        return JS_NULL;
+    }
+
+    result = JS_NewObject(ctx);
+    if (JS_IsException(result)) {
+        return JS_EXCEPTION;
+    }
+
+    JS_SetPropertyStr(ctx, result, "readCalls", JS_NewInt64(ctx, read_calls));
+    JS_SetPropertyStr(ctx, result, "writeCalls", JS_NewInt64(ctx, write_calls));
+    JS_SetPropertyStr(ctx, result, "readBytes", JS_NewInt64(ctx, read_bytes));
+    JS_SetPropertyStr(ctx, result, "writeBytes", JS_NewInt64(ctx, write_bytes));
+
+    return result;
+#else
+    return JS_NULL;
+#endif
+}
+
+#ifndef _WIN32
+static void bench_drain(void *arg) {
+    char buffer[65536];
+    int fd = (int)(intptr_t)arg;
+
+    while (true) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length == 0 || (length < 0 && errno != EINTR)) {
+            break;
+        }
+    }
+
+    close(fd);
+}
+#endif
+
+static JSValue bench_redirect_stdout(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Redirecting stdout is not supported on this platform");
+#else
+    const char *path = NULL;
+    int target;
+    int pipe_fds[2];
+
+    if (bench_stdout_redirect.active) {
+        return JS_ThrowInternalError(ctx, "stdout is already redirected");
+    }
+
+    if (argc > 0 && !JS_IsNull(argv[0]) && !JS_IsUndefined(argv[0])) {
+        path = JS_ToCString(ctx, argv[0]);
+        if (!path) {
+            return JS_EXCEPTION;
+        }
+    }
+
+    if (path) {
+        target = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        JS_FreeCString(ctx, path);
+        if (target < 0) {
+            return JS_ThrowInternalError(ctx, "Failed to open file: %s", strerror(errno));
+        }
+    } else {
+        // Without a path stdout goes into a pipe that is drained by a background thread
+        if (pipe(pipe_fds) < 0) {
+            return JS_ThrowInternalError(ctx, "Failed to create pipe: %s", strerror(errno));
+        }
+
+        if (js_thread_create(&bench_stdout_redirect.drain_thread, bench_drain, (void *)(intptr_t)pipe_fds[0], 0)) {
+            close(pipe_fds[0]);
+            close(pipe_fds[1]);
+            return JS_ThrowInternalError(ctx, "Failed to start pipe reader");
+        }
+
+        target = pipe_fds[1];
+    }
+
+    fflush(stdout);
+    bench_stdout_redirect.saved_fd = dup(STDOUT_FILENO);
+    dup2(target, STDOUT_FILENO);
+    close(target);
+
+    bench_stdout_redirect.active = true;
+    bench_stdout_redirect.draining = path == NULL;
+
+    return JS_UNDEFINED;
+#endif
+}
+
+static JSValue bench_restore_stdout(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifndef _WIN32
+    if (!bench_stdout_redirect.active) {
+        return JS_UNDEFINED;
+    }
+
+    // Closing the last write end lets the pipe reader see the end of the stream
+    fflush(stdout);
+    dup2(bench_stdout_redirect.saved_fd, STDOUT_FILENO);
+    close(bench_stdout_redirect.saved_fd);
+
+    if (bench_stdout_redirect.draining) {
+        js_thread_join(bench_stdout_redirect.drain_thread);
+    }
+
+    bench_stdout_redirect.active = false;
+#endif
+    return JS_UNDEFINED;
+}
+
+void yaje_bench_init(JSRuntime *rt, JSContext *ctx) {
+    JSValue bench = JS_NewObject(ctx);
+
+    bench_time_origin = js__hrtime_ns();
+
+    JS_SetPropertyStr(ctx, bench, "now", JS_NewCFunction(ctx, bench_now, "now", 0));
+    JS_SetPropertyStr(ctx, bench, "gc", JS_NewCFunction(ctx, bench_gc, "gc", 0));
+    JS_SetPropertyStr(ctx, bench, "getGCThreshold", JS_NewCFunction(ctx, bench_get_gc_threshold, "getGCThreshold", 0));
+    JS_SetPropertyStr(ctx, bench, "setGCThreshold", JS_NewCFunction(ctx, bench_set_gc_threshold, "setGCThreshold", 1));
+    JS_SetPropertyStr(ctx, bench, "memoryUsage", JS_NewCFunction(ctx, bench_memory_usage, "memoryUsage", 0));
+    JS_SetPropertyStr(ctx, bench, "getenv", JS_NewCFunction(ctx, bench_getenv, "getenv", 1));
+    JS_SetPropertyStr(ctx, bench, "write", JS_NewCFunction(ctx, bench_write, "write", 2));
+    JS_SetPropertyStr(ctx, bench, "ioCounters", JS_NewCFunction(ctx, bench_io_counters, "ioCounters", 0));
+    JS_SetPropertyStr(ctx, bench, "redirectStdout", JS_NewCFunction(ctx, bench_redirect_stdout, "redirectStdout", 1));
+    JS_SetPropertyStr(ctx, bench, "restoreStdout", JS_NewCFunction(ctx, bench_restore_stdout, "restoreStdout", 0));
+
+    yaje_core_register_native(ctx, JS_DupValue(ctx, bench), "bench");
+    JS_FreeValue(ctx, bench);
+}
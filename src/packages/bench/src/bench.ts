@@ -0,0 +1,528 @@
+import "@yaje/core";
+import {writeFileSync} from "@yaje/fs";
+
+import {formatTime, type Statistics, summarize} from "./stats.js";
+
+/**
+ * Interface for the native benchmark primitives.
+ */
+interface BenchNative {
+    /**
+     * Reads the monotonic high resolution clock.
+     *
+     * @returns The nanoseconds elapsed since the module was initialized.
+     */
+    now(): number;
+
+    /**
+     * Runs a full garbage collection cycle.
+     */
+    gc(): void;
+
+    /**
+     * Returns the allocation threshold that triggers the automatic garbage collector.
+     *
+     * @returns The threshold in bytes, or -1 if the automatic collector is disabled.
+     */
+    getGCThreshold(): number;
+
+    /**
+     * Sets the allocation threshold that triggers the automatic garbage collector.
+     *
+     * @param threshold - The threshold in bytes, or a negative value to disable the automatic collector.
+     */
+    setGCThreshold(threshold: number): void;
+
+    /**
+     * Returns the current memory usage of the runtime.
+     */
+    memoryUsage(): MemoryUsage;
+
+    /**
+     * Reads an environment variable.
+     *
+     * @param name - The name of the environment variable.
+     *
+     * @returns The value of the variable, or `undefined` if it is not set.
+     */
+    getenv(name: string): string | undefined;
+
+    /**
+     * Writes a string unbuffered to stdout or stderr.
+     *
+     * @param stream - 1 for stdout, 2 for stderr.
+     * @param data   - The data to write.
+     */
+    write(stream: 1 | 2, data: string): void;
+
+    /**
+     * Reads the I/O counters of the process.
+     *
+     * @returns The counters, or `null` if the platform does not provide them.
+     */
+    ioCounters(): IOCounters | null;
+
+    /**
+     * Redirects stdout until {@link restoreStdout} is called.
+     *
+     * @param path - The file stdout is written to, or `null` for a pipe that is drained in the background.
+     */
+    redirectStdout(path: string | null): void;
+
+    /**
+     * Restores stdout after {@link redirectStdout}.
+     */
+    restoreStdout(): void;
+}
+
+export interface MemoryUsage {
+    mallocSize: number;
+    mallocCount: number;
+    memoryUsedSize: number;
+    objectCount: number;
+    stringCount: number;
+    shapeCount: number;
+}
+
+export interface IOCounters {
+    readCalls: number;
+    writeCalls: number;
+    readBytes: number;
+    writeBytes: number;
+}
+
+export type BenchFunction = () => unknown;
+
+export interface BenchOptions {
+    /**
+     * Time in milliseconds the benchmark is run before samples are taken.
+     */
+    warmup?: number;
+    /**
+     * Time budget in milliseconds for taking samples.
+     */
+    time?: number;
+    /**
+     * Minimum number of samples, even if the time budget is exceeded.
+     */
+    minSamples?: number;
+    /**
+     * Maximum number of samples.
+     */
+    maxSamples?: number;
+    /**
+     * Target duration of a single sample in milliseconds, used to calibrate the iteration count.
+     */
+    sampleTime?: number;
+    /**
+     * Whether a full garbage collection is run before every sample.
+     */
+    gc?: boolean;
+    /**
+     * Whether the automatic garbage collector is disabled while a sample is taken.
+     */
+    pauseGC?: boolean;
+    /**
+     * Bytes processed per iteration. If set, throughput and syscalls per iteration are reported.
+     */
+    bytes?: number;
+    /**
+     * Called before the benchmark is calibrated, e.g. to create input files.
+     */
+    setup?: () => unknown;
+    /**
+     * Called after the last sample, even if the benchmark failed.
+     */
+    teardown?: () => unknown;
+}
+
+export interface BenchResult extends Statistics {
+    name: string;
+    /**
+     * Iterations per sample; all times are nanoseconds per iteration.
+     */
+    iterations: number;
+    opsPerSecond: number;
+    /**
+     * Only present if the benchmark declares the bytes processed per iteration.
+     */
+    bytesPerSecond?: number;
+    /**
+     * Only present if the benchmark declares the bytes processed per iteration and the platform has I/O counters.
+     */
+    syscallsPerOp?: {
+        read: number;
+        write: number;
+    };
+}
+
+export interface RunOptions {
+    /**
+     * Only benchmarks whose name contains this string are run. Defaults to `YAJE_BENCH_FILTER`.
+     */
+    filter?: string;
+    /**
+     * Path of the JSON report. Defaults to `YAJE_BENCH_JSON`.
+     */
+    json?: string;
+    /**
+     * Suppresses the text report.
+     */
+    quiet?: boolean;
+}
+
+export interface Report {
+    schema: 1;
+    timestamp: string;
+    results: BenchResult[];
+}
+
+interface RegisteredBench {
+    name: string;
+    fn: BenchFunction;
+    options: BenchOptions;
+}
+
+const DEFAULT_OPTIONS: Required<BenchOptions> = {
+    warmup: 100,
+    time: 1000,
+    minSamples: 10,
+    maxSamples: 1000,
+    sampleTime: 10,
+    gc: true,
+    pauseGC: false,
+    bytes: 0,
+    setup: () => {},
+    teardown: () => {}
+};
+
+const MAX_ITERATIONS: number = 1 << 30;
+
+const native: BenchNative = Native.getModule("bench");
+
+const registry: RegisteredBench[] = [];
+const groups: string[] = [];
+
+/**
+ * Reads the monotonic high resolution clock.
+ *
+ * @returns The nanoseconds elapsed since the runtime started.
+ */
+export function now(): number {
+    return native.now();
+}
+
+/**
+ * Runs a full garbage collection cycle.
+ */
+export function gc(): void {
+    native.gc();
+}
+
+/**
+ * Returns the current memory usage of the runtime.
+ */
+export function memoryUsage(): MemoryUsage {
+    return native.memoryUsage();
+}
+
+/**
+ * Reads an environment variable.
+ *
+ * @param name - The name of the environment variable.
+ *
+ * @returns The value of the variable, or `undefined` if it is not set.
+ */
+export function getenv(name: string): string | undefined {
+    return native.getenv(name);
+}
+
+/**
+ * Reads the I/O counters of the process.
+ *
+ * @returns The counters, or `null` if the platform does not provide them.
+ */
+export function ioCounters(): IOCounters | null {
+    return native.ioCounters();
+}
+
+/**
+ * Redirects stdout, e.g. to measure output throughput without flooding the terminal.
+ *
+ * @param path - The file stdout is written to. If omitted, stdout is a pipe that is drained in the background.
+ */
+export function redirectStdout(path?: string): void {
+    native.redirectStdout(path ?? null);
+}
+
+/**
+ * Restores stdout after {@link redirectStdout}.
+ */
+export function restoreStdout(): void {
+    native.restoreStdout();
+}
+
+/**
+ * Registers a benchmark that is executed by {@link run}.
+ *
+ * @param name    - The name of the benchmark.
+ * @param fn      - The function to measure. If it returns a promise, the promise is awaited.
+ * @param options - Options overriding the defaults.
+ */
+export function bench(name: string, fn: BenchFunction, options: BenchOptions = {}): void {
+    registry.push({
+        name: groups.concat(name).join("/"),
+        fn,
+        options
+    });
+}
+
+/**
+ * Prefixes the names of all benchmarks registered within `body`.
+ *
+ * @param name - The name of the group.
+ * @param body - A function registering benchmarks.
+ */
+export function group(name: string, body: () => void): void {
+    groups.push(name);
+    try {
+        body();
+    } finally {
+        groups.pop();
+    }
+}
+
+function isThenable(value: unknown): value is PromiseLike<unknown> {
+    return typeof value == "object" && value != null && typeof (value as PromiseLike<unknown>).then == "function";
+}
+
+/**
+ * Runs a benchmark function a number of times.
+ *
+ * @param fn         - The function to measure.
+ * @param iterations - The number of calls.
+ *
+ * @return The elapsed time in nanoseconds.
+ */
+async function invoke(fn: BenchFunction, iterations: number): Promise<number> {
+    const start: number = native.now();
+    for (let i: number = 0; i < iterations; i++) {
+        const result: unknown = fn();
+        if (isThenable(result)) {
+            await result;
+        }
+    }
+
+    return native.now() - start;
+}
+
+/**
+ * Finds the number of iterations a sample needs to last at least `targetTime`.
+ *
+ * @param fn         - The function to measure.
+ * @param targetTime - The target time of a sample in nanoseconds.
+ *
+ * @return The calibrated iteration count.
+ */
+async function calibrate(fn: BenchFunction, targetTime: number): Promise<number> {
+    let iterations: number = 1;
+
+    while (iterations < MAX_ITERATIONS) {
+        const elapsed: number = await invoke(fn, iterations);
+        if (elapsed >= targetTime) {
+            break;
+        }
+
+        // Extrapolate from the last run, but never grow by more than a factor of ten at once
+        const estimate: number = elapsed > 0 ? Math.ceil(iterations * targetTime / elapsed) : iterations * 10;
+        iterations = Math.min(MAX_ITERATIONS, Math.max(iterations * 2, Math.min(iterations * 10, estimate)));
+    }
+
+    return iterations;
+}
+
+/**
+ * Measures a single benchmark immediately.
+ *
+ * @param name    - The name of the benchmark.
+ * @param fn      - The function to measure. If it returns a promise, the promise is awaited.
+ * @param options - Options overriding the defaults.
+ *
+ * @return A promise that resolves to the result of the benchmark.
+ */
+export async function measure(name: string, fn: BenchFunction, options: BenchOptions = {}): Promise<BenchResult> {
+    const config: Required<BenchOptions> = {...DEFAULT_OPTIONS, ...options};
+
+    await config.setup();
+    try {
+        return await sample(name, fn, config);
+    } finally {
+        await config.teardown();
+    }
+}
+
+/**
+ * Calibrates, warms up and samples a benchmark.
+ *
+ * @param name   - The name of the benchmark.
+ * @param fn     - The function to measure.
+ * @param config - The complete options.
+ *
+ * @return A promise that resolves to the result of the benchmark.
+ */
+async function sample(name: string, fn: BenchFunction, config: Required<BenchOptions>): Promise<BenchResult> {
+    const sampleTime: number = config.sampleTime * 1e6;
+
+    let iterations: number = await calibrate(fn, sampleTime);
+
+    const warmupEnd: number = native.now() + config.warmup * 1e6;
+    while (native.now() < warmupEnd) {
+        const elapsed: number = await invoke(fn, iterations);
+        if (elapsed > 0 && elapsed < sampleTime / 2) {
+            iterations = Math.min(MAX_ITERATIONS, iterations * 2);
+        }
+    }
+
+    const threshold: number = native.getGCThreshold();
+    const samples: number[] = [];
+    const deadline: number = native.now() + config.time * 1e6;
+    const countersBefore: IOCounters | null = config.bytes > 0 ? native.ioCounters() : null;
+
+    while (samples.length < config.minSamples || (samples.length < config.maxSamples && native.now() < deadline)) {
+        if (config.gc) {
+            native.gc();
+        }
+        if (config.pauseGC) {
+            native.setGCThreshold(-1);
+        }
+
+        let elapsed: number;
+        try {
+            elapsed = await invoke(fn, iterations);
+        } finally {
+            if (config.pauseGC) {
+                native.setGCThreshold(threshold);
+            }
+        }
+
+        samples.push(elapsed / iterations);
+    }
+
+    const countersAfter: IOCounters | null = countersBefore ? native.ioCounters() : null;
+    const statistics: Statistics = summarize(samples);
+    const result: BenchResult = {
+        name,
+        iterations,
+        opsPerSecond: statistics.mean > 0 ? 1e9 / statistics.mean : Infinity,
+        ...statistics
+    };
+
+    if (config.bytes > 0) {
+        result.bytesPerSecond = statistics.mean > 0 ? config.bytes * 1e9 / statistics.mean : Infinity;
+    }
+
+    if (countersBefore && countersAfter) {
+        const total: number = samples.length * iterations;
+        result.syscallsPerOp = {
+            read: (countersAfter.readCalls - countersBefore.readCalls) / total,
+            write: (countersAfter.writeCalls - countersBefore.writeCalls) / total
+        };
+    }
+
+    return result;
+}
+
+const COLUMNS: string[] = ["benchmark", "mean", "± rme", "median", "stddev", "p75", "p99", "ops/s", "samples"];
+const IO_COLUMNS: string[] = ["MB/s", "syscalls r/w"];
+
+function formatIO(result: BenchResult): string[] {
+    return [
+        result.bytesPerSecond != undefined ? (result.bytesPerSecond / 1e6).toFixed(2) : "",
+        result.syscallsPerOp ? `${result.syscallsPerOp.read.toFixed(2)}/${result.syscallsPerOp.write.toFixed(2)}` : ""
+    ];
+}
+
+function formatRow(result: BenchResult): string[] {
+    return [
+        result.name,
+        formatTime(result.mean),
+        `${result.rme.toFixed(2)}%`,
+        formatTime(result.median),
+        formatTime(result.stddev),
+        formatTime(result.p75),
+        formatTime(result.p99),
+        Math.round(result.opsPerSecond).toString(),
+        result.samples.toString()
+    ];
+}
+
+/**
+ * Formats benchmark results as an aligned text table.
+ *
+ * @param results - The results to format.
+ *
+ * @return The formatted table.
+ */
+export function formatReport(results: BenchResult[]): string {
+    // The I/O columns are only shown if at least one benchmark declared its throughput
+    const io: boolean = results.some(result => result.bytesPerSecond != undefined);
+    const columns: string[] = io ? COLUMNS.concat(IO_COLUMNS) : COLUMNS;
+    const rows: string[][] = [columns].concat(results.map(result => io ? formatRow(result).concat(formatIO(result)) : formatRow(result)));
+    const widths: number[] = columns.map((_, column) => Math.max(...rows.map(row => row[column]!.length)));
+
+    return rows
+        .map(row => row.map((cell, column) => column == 0 ? cell.padEnd(widths[column]!) : cell.padStart(widths[column]!)).join("  "))
+        .join("\n") + "\n";
+}
+
+/**
+ * Creates a machine readable report, suitable for regression tracking.
+ *
+ * @param results - The results to include.
+ *
+ * @return The report object.
+ */
+export function createReport(results: BenchResult[]): Report {
+    return {
+        schema: 1,
+        timestamp: new Date().toISOString(),
+        results
+    };
+}
+
+/**
+ * Runs all registered benchmarks.
+ *
+ * @param options - Options for filtering and reporting.
+ *
+ * @return A promise that resolves to the results of all executed benchmarks.
+ */
+export async function run(options: RunOptions = {}): Promise<BenchResult[]> {
+    const filter: string | undefined = options.filter ?? native.getenv("YAJE_BENCH_FILTER");
+    const json: string | undefined = options.json ?? native.getenv("YAJE_BENCH_JSON");
+    const results: BenchResult[] = [];
+
+    for (const entry of registry) {
+        if (filter && !entry.name.includes(filter)) {
+            continue;
+        }
+
+        const result: BenchResult = await measure(entry.name, entry.fn, entry.options);
+        results.push(result);
+
+        if (!options.quiet) {
+            const throughput: string = result.bytesPerSecond != undefined ? ` (${(result.bytesPerSecond / 1e6).toFixed(2)} MB/s)` : "";
+            native.write(2, `${entry.name}: ${formatTime(result.mean)} ± ${result.rme.toFixed(2)}%${throughput}\n`);
+        }
+    }
+
+    if (!options.quiet) {
+        native.write(1, formatReport(results));
+    }
+
+    if (json) {
+        writeFileSync(json, JSON.stringify(createReport(results), null, 4));
+    }
+
+    return results;
+}
@@ -0,0 +1,2 @@
+export * from "./bench.js";
+export * from "./stats.js";
\ No newline at end of file
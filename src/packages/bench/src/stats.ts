@@ -0,0 +1,121 @@
+/**
+ * Summary statistics of a series of samples.
+ */
+export interface Statistics {
+    samples: number;
+    mean: number;
+    median: number;
+    stddev: number;
+    min: number;
+    max: number;
+    p75: number;
+    p99: number;
+    p999: number;
+    /**
+     * Relative margin of error of the mean at a 95% confidence level, in percent.
+     */
+    rme: number;
+}
+
+// Two-sided 95% critical values of the Student's t-distribution for 1 to 30 degrees of freedom
+const T_TABLE: number[] = [
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+];
+
+/**
+ * Returns the two-sided 95% critical value for the given degrees of freedom.
+ *
+ * @param degreesOfFreedom - The degrees of freedom of the sample.
+ *
+ * @return The critical value.
+ */
+function criticalValue(degreesOfFreedom: number): number {
+    if (degreesOfFreedom < 1) {
+        return NaN;
+    }
+
+    return T_TABLE[degreesOfFreedom - 1] ?? 1.96;
+}
+
+/**
+ * Computes a percentile of an ascending sorted series using linear interpolation.
+ *
+ * @param sorted - The samples, sorted in ascending order.
+ * @param p      - The percentile in the range [0, 1].
+ *
+ * @return The interpolated percentile value.
+ */
+export function percentile(sorted: number[], p: number): number {
+    if (sorted.length == 0) {
+        return NaN;
+    }
+
+    const position: number = (sorted.length - 1) * p;
+    const lower: number = Math.floor(position);
+    const upper: number = Math.ceil(position);
+    const weight: number = position - lower;
+
+    return sorted[lower]! * (1 - weight) + sorted[upper]! * weight;
+}
+
+/**
+ * Computes summary statistics of a series of samples.
+ *
+ * @param values - The samples to summarize.
+ *
+ * @return The summary statistics.
+ */
+export function summarize(values: number[]): Statistics {
+    const sorted: number[] = values.slice().sort((a, b) => a - b);
+    const count: number = sorted.length;
+
+    let sum: number = 0;
+    for (const value of sorted) {
+        sum += value;
+    }
+    const mean: number = count > 0 ? sum / count : NaN;
+
+    let squares: number = 0;
+    for (const value of sorted) {
+        squares += (value - mean) * (value - mean);
+    }
+    const stddev: number = count > 1 ? Math.sqrt(squares / (count - 1)) : 0;
+    const sem: number = count > 0 ? stddev / Math.sqrt(count) : NaN;
+    const rme: number = count > 1 && mean != 0 ? criticalValue(count - 1) * sem / mean * 100 : 0;
+
+    return {
+        samples: count,
+        mean: mean,
+        median: percentile(sorted, 0.5),
+        stddev: stddev,
+        min: count > 0 ? sorted[0]! : NaN,
+        max: count > 0 ? sorted[count - 1]! : NaN,
+        p75: percentile(sorted, 0.75),
+        p99: percentile(sorted, 0.99),
+        p999: percentile(sorted, 0.999),
+        rme: rme
+    };
+}
+
+/**
+ * Formats a duration for display.
+ *
+ * @param ns - The duration in nanoseconds.
+ *
+ * @return The formatted duration with a unit suffix.
+ */
+export function formatTime(ns: number): string {
+    if (ns < 1e3) {
+        return `${ns.toFixed(2)} ns`;
+    }
+    if (ns < 1e6) {
+        return `${(ns / 1e3).toFixed(2)} µs`;
+    }
+    if (ns < 1e9) {
+        return `${(ns / 1e6).toFixed(2)} ms`;
+    }
+
+    return `${(ns / 1e9).toFixed(2)} s`;
+}
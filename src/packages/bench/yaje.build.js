@@ -0,0 +1,9 @@
+import {CFG} from "@yaje/core/builder";
+
+const cfg = new CFG();
+
+cfg.addSource("./native");
+cfg.addIncludeDir("./native");
+cfg.setLoadingFunctions("yaje_bench_init");
+
+export default cfg;
\ No newline at end of file
@@ -3,7 +3,7 @@ import * as fs from "fs";
 import * as crypto from "crypto";
 
 import chalk from "chalk";
-import ora from "ora";
+import ora, {type Ora} from "ora";
 
 import {type CFGResult, generateOutputInformation, type OutputInformation, type TargetTriple} from "@yaje/core/builder";
 import {CBG} from "@yaje/core/bundler";
@@ -11,11 +11,72 @@ import {CBG} from "@yaje/core/bundler";
 import * as builder from "../builder.js";
 import * as compiler from "../compiler.js";
 import * as bundler from "../bundler.js";
+import * as timings from "../timings.js";
+import * as subprocess from "../subprocess.js";
 import {type NativeTrackedPackage, PackageCollection, type PackageJSON, type TrackedPackage} from "../package.js";
 import {getTargetTripleString} from "../compiler.js";
 
-export function getBaseCFlags(target: TargetTriple): string[] {
-    return [
+/**
+ * Options for linking the executable.
+ */
+export interface LinkOptions {
+    /**
+     * The linker clang uses (e.g. "lld" or "mold"), null keeps the default one.
+     */
+    linker: string | null;
+    /**
+     * Links all libraries including the C library statically, the executable then starts without the dynamic loader.
+     */
+    static: boolean;
+    /**
+     * "now" resolves all symbols when the executable is loaded, "lazy" on their first call, null keeps the default.
+     */
+    binding: "now" | "lazy" | null;
+    /**
+     * Builds a position independent executable, without it the code is compiled for a fixed address and needs no
+     * relocations at startup.
+     */
+    pie: boolean;
+}
+
+/**
+ * Returns the link options used if none are given, musl targets are linked statically.
+ *
+ * @param target - The target triple to build for.
+ *
+ * @return The default link options.
+ */
+export function getDefaultLinkOptions(target: TargetTriple): LinkOptions {
+    return {
+        linker: null,
+        static: target.platform == "linux" && target.abi == "musl",
+        binding: null,
+        pie: true
+    };
+}
+
+/**
+ * Checks whether the link options can be used for a target.
+ *
+ * @param target - The target triple to build for.
+ * @param link   - The link options.
+ *
+ * @return An error message, or `null` if the options are valid.
+ */
+export function validateLinkOptions(target: TargetTriple, link: LinkOptions): string | null {
+    if (link.binding !== null && link.binding != "now" && link.binding != "lazy") {
+        return `Unknown binding '${link.binding}', expected 'now' or 'lazy'`;
+    }
+
+    if (target.platform != "linux" && (link.static || link.binding !== null || !link.pie)) {
+        return "Static linking, binding modes and non-PIE executables are only supported for Linux targets";
+    }
+
+    return null;
+}
+
+export function getBaseCFlags(target: TargetTriple, link: LinkOptions | null = null): string[] {
+    const flags: string[] = [
         "-std=gnu11",
         "-Wall",
         "-Wextra",
@@ -34,12 +95,60 @@ export function getBaseCFlags(target: TargetTriple): string[] {
         getTargetTripleString(target),
         "-c"
     ];
+
+    // Static executables are not position independent either
+    if (link && (link.static || !link.pie)) {
+        flags.push("-fno-pie");
+    }
+
+    return flags;
 }
 
-export function getBaseLFlags(target: TargetTriple): string[] {
-    return [
-        "-g"
+export function getBaseLFlags(target: TargetTriple, link: LinkOptions | null = null): string[] {
+    const flags: string[] = [
+        "-g",
+        "-target",
+        getTargetTripleString(target)
     ];
+
+    if (!link) {
+        return flags;
+    }
+
+    if (link.linker) {
+        flags.push(`-fuse-ld=${link.linker}`);
+    }
+
+    if (link.static) {
+        flags.push("-static");
+    } else if (!link.pie) {
+        flags.push("-no-pie");
+    }
+
+    if (link.binding) {
+        flags.push(`-Wl,-z,${link.binding}`);
+    }
+
+    return flags;
+}
+
+/**
+ * Starts a spinner for a build step.
+ *
+ * Targets that are built concurrently can't share the terminal line, their spinners only print a line when they start
+ * and finish, labelled with the target.
+ *
+ * @param text  - The text of the spinner.
+ * @param label - The label of the target, or `null` if only one target is built.
+ *
+ * @return The started spinner.
+ */
+function startSpinner(text: string, label: string | null): Ora {
+    return ora({
+        text: label ? `${text} ${chalk.dim(`[${label}]`)}` : text,
+        color: 'cyan',
+        ...(label ? {isEnabled: false} : {})
+    }).start();
 }
 
 /**
@@ -49,14 +158,18 @@ export function getBaseLFlags(target: TargetTriple): string[] {
  * @param root    - The root directory of the project.
  * @param fromDir - The directory to start the search from.
  *
- * @return The absolute path to the resolved package directory.
+ * @return A promise that resolves to the absolute path of the package directory.
  */
-export function resolvePackageDir(name: string, root: string, fromDir: string): string {
+export async function resolvePackageDir(name: string, root: string, fromDir: string): Promise<string> {
     let dir: string = fromDir;
     while (true) {
         const resolvePath: string = path.join(dir, "node_modules", name);
-        if (fs.existsSync(resolvePath) && fs.statSync(resolvePath).isDirectory()) {
-            return resolvePath;
+        try {
+            if ((await fs.promises.stat(resolvePath)).isDirectory()) {
+                return resolvePath;
+            }
+        } catch (e) {
+            // Continue in the parent directory
         }
 
         let parentDir: string = path.dirname(dir);
@@ -68,27 +181,41 @@ export function resolvePackageDir(name: string, root: string, fromDir: string):
 }
 
 /**
- * Checks and parses the package.json file of a directory and recursively processes its dependencies.
+ * A loaded package together with the directories its dependencies were resolved to.
+ */
+interface ResolvedPackage {
+    pkg: TrackedPackage | NativeTrackedPackage;
+    dependencies: {name: string, dir: string}[];
+}
+
+/**
+ * Loads the package.json and build instructions of a directory and starts resolving its dependencies, every directory
+ * is only loaded once.
  *
  * @param root     - The root directory of the project.
- * @param dir      - The directory to check for a package.json file.
+ * @param dir      - The directory of the package.
  * @param target   - The target triple for which the build is being performed.
- * @param packages - The collection of packages being built.
+ * @param resolved - The packages that are loaded or being loaded, by directory.
+ * @param cache    - The cache for build instructions.
  *
- * @return A promise that resolves to the name of the package.
+ * @return A promise that resolves to the loaded package.
  */
-export async function checkPackageJSON(
+async function resolvePackage(
     root: string,
     dir: string,
     target: TargetTriple,
-    packages: PackageCollection
-): Promise<string> {
+    resolved: Map<string, Promise<ResolvedPackage>>,
+    cache: builder.InstructionCache | null
+): Promise<ResolvedPackage> {
     const packageJSONPath: string = path.join(dir, "package.json");
-    if (!fs.existsSync(packageJSONPath) || !fs.statSync(packageJSONPath).isFile()) {
+
+    let content: string;
+    try {
+        content = await fs.promises.readFile(packageJSONPath, "utf-8");
+    } catch (e) {
         throw new Error(`Directory '${dir}' contains no package.json`);
     }
 
-    const content: string = fs.readFileSync(packageJSONPath, "utf-8");
     let json: PackageJSON;
     try {
         json = JSON.parse(content);
@@ -96,42 +223,95 @@ export async function checkPackageJSON(
         throw new Error(`Failed to parse JSON in '${packageJSONPath}'`, {cause: e});
     }
 
-    packages.set({
+    let instructions: CFGResult | null;
+    try {
+        instructions = await builder.loadBuildInstructions(dir, target, json.name, cache);
+    } catch (e) {
+        throw new Error(`Failed to load build instructions '${json.name}'`, {cause: e});
+    }
+
+    const pkg: TrackedPackage | NativeTrackedPackage = instructions ? {
+        packageJSON: json,
+        packageFolder: dir,
+        isNative: true,
+        instructions: instructions,
+        isBundler: json.yaje?.bundler ?? false
+    } : {
         packageJSON: json,
         packageFolder: dir,
         isNative: false,
         isBundler: json.yaje?.bundler ?? false
-    })
+    };
 
-    try {
-        const instructions: CFGResult | null = await builder.loadBuildInstructions(dir, target, json.name);
-        if (instructions) {
-            packages.set({
-                packageJSON: json,
-                packageFolder: dir,
-                isNative: true,
-                instructions: instructions,
-                isBundler: json.yaje?.bundler ?? false
-            });
+    if (!json.dependencies || !("@yaje/core" in json.dependencies)) {
+        return {pkg, dependencies: []};
+    }
+
+    const names: string[] = Object.keys(json.dependencies);
+    const dirs: string[] = await Promise.all(names.map(name => resolvePackageDir(name, root, dir)));
+
+    // Dependencies are not awaited here, a cycle would wait for itself
+    for (const dependencyDir of dirs) {
+        if (!resolved.has(dependencyDir)) {
+            const promise: Promise<ResolvedPackage> = resolvePackage(root, dependencyDir, target, resolved, cache);
+            promise.catch(() => undefined);
+            resolved.set(dependencyDir, promise);
         }
-    } catch (e) {
-        throw new Error(`Failed to load build instructions '${json.name}'`, {cause: e});
     }
 
-    if (!json.dependencies || !("@yaje/core" in json.dependencies)) {
-        return json.name;
+    return {pkg, dependencies: names.map((name, i) => ({name, dir: dirs[i]!}))};
+}
+
+/**
+ * Checks and parses the package.json file of a directory and processes its dependencies.
+ *
+ * All packages are loaded concurrently, but they are added to the collection depth first in the order of their
+ * dependencies, so the link order stays the same between builds.
+ *
+ * @param root     - The root directory of the project.
+ * @param dir      - The directory to check for a package.json file.
+ * @param target   - The target triple for which the build is being performed.
+ * @param packages - The collection of packages being built.
+ * @param cache    - The cache for build instructions, `null` loads every build file.
+ *
+ * @return A promise that resolves to the name of the package.
+ */
+export async function checkPackageJSON(
+    root: string,
+    dir: string,
+    target: TargetTriple,
+    packages: PackageCollection,
+    cache: builder.InstructionCache | null = null
+): Promise<string> {
+    const resolved: Map<string, Promise<ResolvedPackage>> = new Map<string, Promise<ResolvedPackage>>();
+    resolved.set(dir, resolvePackage(root, dir, target, resolved, cache));
+
+    // Loaded packages add their dependencies to the map, it is complete once a round adds nothing
+    let count: number = 0;
+    while (count != resolved.size) {
+        count = resolved.size;
+        await Promise.all(resolved.values());
     }
 
-    if (json.dependencies) for (const name of Object.keys(json.dependencies)) {
-        if (packages.has(name)) {
-            continue;
+    const loaded: Map<string, ResolvedPackage> = new Map<string, ResolvedPackage>();
+    for (const [packageDir, promise] of resolved) {
+        loaded.set(packageDir, await promise);
+    }
+
+    const visit = (resolvedPackage: ResolvedPackage): void => {
+        packages.set(resolvedPackage.pkg);
+
+        for (const dependency of resolvedPackage.dependencies) {
+            if (!packages.has(dependency.name)) {
+                visit(loaded.get(dependency.dir)!);
+            }
         }
+    };
 
-        const dependencyDir: string = resolvePackageDir(name, root, dir);
-        await checkPackageJSON(root, dependencyDir, target, packages);
-    }
+    const rootPackage: ResolvedPackage = loaded.get(dir)!;
+    visit(rootPackage);
 
-    return json.name;
+    return rootPackage.pkg.packageJSON.name;
 }
 
 /**
@@ -142,6 +322,8 @@ export async function checkPackageJSON(
  * @param target      - The target triple to compile for.
  * @param output      - Information about the output configuration.
  * @param cacheFolder - Cache folder
+ * @param link        - The options the executable is linked with.
+ * @param pch         - The precompiled core header, or `null` if there is none.
  *
  * @return A promise that resolves to the path of the generated static library.
  */
@@ -150,9 +332,11 @@ async function compileModule(
     packages: PackageCollection,
     target: TargetTriple,
     output: OutputInformation,
-    cacheFolder: string
+    cacheFolder: string,
+    link: LinkOptions,
+    pch: string | null
 ): Promise<string> {
-    const flags: string[] = getBaseCFlags(target);
+    const flags: string[] = getBaseCFlags(target, link);
     const dependencies: CFGResult[] = [];
 
 
@@ -170,31 +354,94 @@ async function compileModule(
         fs.mkdirSync(outputFolder, {recursive: true});
     }
 
+    const core: NativeTrackedPackage = packages.getCore();
+    const usePCH: boolean = pch !== null
+        && module !== core
+        && dependencies.includes(core.instructions)
+        && hasSameMacros(dependencies.concat(module.instructions), core.instructions);
+
     return await compiler.compileModule(
         module.instructions,
         dependencies,
         outputFolder,
         output.modFolder,
         cacheFolder,
-        flags
+        flags,
+        usePCH ? pch : null
     );
 }
 
+/**
+ * Checks whether the macros defined for a module and its dependencies are exactly the ones of the core module.
+ *
+ * A precompiled header can only be used with the macros it was compiled with, clang rejects it if one of them is
+ * missing and additional ones would not apply to the headers it contains.
+ *
+ * @param modules - The module and its dependencies.
+ * @param core    - The core module.
+ *
+ * @return True if the macros are the same.
+ */
+function hasSameMacros(modules: CFGResult[], core: CFGResult): boolean {
+    const macros: Map<string, boolean | number | string> = new Map();
+    for (const module of modules) {
+        for (const [macroName, macroValue] of Object.entries(module.defineMacros)) {
+            macros.set(macroName, macroValue);
+        }
+    }
+
+    const coreMacros: [string, boolean | number | string][] = Object.entries(core.defineMacros);
+    return macros.size == coreMacros.length && coreMacros.every(([macroName, macroValue]) => macros.get(macroName) === macroValue);
+}
+
+/**
+ * Precompiles the header of the core module that every native module includes (quickjs.h and cutils.h).
+ *
+ * @param packages - The collection of all tracked packages.
+ * @param target   - The target triple to compile for.
+ * @param output   - Information about the output configuration.
+ * @param link     - The options the executable is linked with.
+ *
+ * @return A promise that resolves to the path of the precompiled header, or `null` if the core module has no header.
+ */
+async function precompileCoreHeader(
+    packages: PackageCollection,
+    target: TargetTriple,
+    output: OutputInformation,
+    link: LinkOptions
+): Promise<string | null> {
+    const core: NativeTrackedPackage = packages.getCore();
+    const header: string = path.join(core.packageFolder, "native", "yaje.h");
+    if (!fs.existsSync(header)) {
+        return null;
+    }
+
+    const outputFolder: string = path.join(output.objFolder, "pch");
+    if (!fs.existsSync(outputFolder) || !fs.statSync(outputFolder).isDirectory()) {
+        fs.mkdirSync(outputFolder, {recursive: true});
+    }
+
+    return await compiler.precompileHeader(core.instructions, header, outputFolder, getBaseCFlags(target, link));
+}
+
 /**
  * Generates the main entry point C source file for the executable.
  *
  * @param sourceFile       - The path where the generated C source file will be saved.
  * @param loadingFunctions - An array of module loading function names to call.
+ * @param bundleBytecode   - Whether the embedded bundle is bytecode instead of source.
  */
-function generateEntryPoint(sourceFile: string, loadingFunctions: string[]): void {
+function generateEntryPoint(sourceFile: string, loadingFunctions: string[], bundleBytecode: boolean): void {
     fs.writeFileSync(sourceFile, `#include "quickjs.h"
 #include "yaje.h"
 
+const bool JS_BUNDLE_IS_BYTECODE = ${bundleBytecode};
+
 ${loadingFunctions.map(fn => `extern void ${fn}(JSRuntime *rt, JSContext *ctx);`).join("\n")}
 
 void yaje_core_load_modules(JSRuntime *rt, JSContext *ctx) {
     
-${loadingFunctions.map(fn => `    ${fn}(rt, ctx);`).join("\n")}
+${loadingFunctions.map(fn => `    ${fn}(rt, ctx);\n    yaje_core_trace("load:${fn}");`).join("\n")}
 
 }
 
@@ -202,6 +449,7 @@ int main(int argc, char **argv) {
     JSRuntime *rt = NULL;
     JSContext *ctx = NULL;
     
+    yaje_core_trace("main");
     yaje_core_ctor(&rt, &ctx);
     
     yaje_core_load_modules(rt, ctx);
@@ -217,26 +465,32 @@ int main(int argc, char **argv) {
  * Builds the object file for the main entry point of the executable.
  *
  * @param packages         - The collection of tracked packages.
+ * @param target           - The target triple to compile for.
  * @param output           - Information about the output configuration.
  * @param loadingFunctions - An array of module loading function names.
+ * @param bundleBytecode   - Whether the embedded bundle is bytecode instead of source.
+ * @param link             - The options the executable is linked with.
  *
  * @return A promise that resolves to the path of the generated entry point object file.
  */
 async function buildEntryPoint(
     packages: PackageCollection,
+    target: TargetTriple,
     output: OutputInformation,
-    loadingFunctions: string[]
+    loadingFunctions: string[],
+    bundleBytecode: boolean,
+    link: LinkOptions
 ): Promise<string> {
     const coreModule: NativeTrackedPackage = packages.getCore();
 
     const entryPointSource: string = path.join(output.genFolder, "main.c");
-    generateEntryPoint(entryPointSource, loadingFunctions);
+    generateEntryPoint(entryPointSource, loadingFunctions, bundleBytecode);
 
     const entryPointObject: string = path.join(output.modFolder, "main.o");
     const args: string[] = coreModule.instructions.includeDirs
         .map(includeDir => ["-I", includeDir])
         .flat()
-        .concat(["-g", "-fwrapv", "-Wall", "-c"]);
+        .concat(getBaseCFlags(target, link));
 
     const entryPointHashFile: string = path.join(output.cacheFolder, "main.hash");
     const sourceDeps: string[] = await compiler.getDependencies(args, entryPointSource);
@@ -258,6 +512,55 @@ async function buildEntryPoint(
     return entryPointObject;
 }
 
+/**
+ * Compiles the JavaScript bundle to bytecode, so the executable does not have to parse it on every start.
+ *
+ * The bundle compiler is linked against the core library of the target, which is why this is only possible if the
+ * target can run on the host.
+ *
+ * @param packages     - The collection of tracked packages.
+ * @param target       - The target triple to build for.
+ * @param bundleFile   - The path to the JavaScript bundle file.
+ * @param coreLibrary  - The path to the compiled core library.
+ * @param libraries    - The linker flags of the libraries the core library depends on.
+ * @param output       - Information about the output configuration.
+ * @param bytecodeFile - The path to write the bytecode to.
+ * @param link         - The options the executable is linked with.
+ *
+ * @return A promise that resolves when the bytecode has been written.
+ */
+async function compileBundle(
+    packages: PackageCollection,
+    target: TargetTriple,
+    bundleFile: string,
+    coreLibrary: string,
+    libraries: string[],
+    output: OutputInformation,
+    bytecodeFile: string,
+    link: LinkOptions
+): Promise<void> {
+    const coreModule: NativeTrackedPackage = packages.getCore();
+
+    const compilerSource: string = path.join(coreModule.packageFolder, "tools", "compile.c");
+    const compilerObject: string = path.join(output.modFolder, "compile.o");
+    const compilerFile: string = path.join(output.modFolder, "compile") + (target.platform == "windows" ? ".exe" : "");
+
+    // The core library is compiled for the executable, so the bundle compiler has to be linked the same way
+    const args: string[] = compiler.generateCompilerArguments([], coreModule.instructions, getBaseCFlags(target, link));
+    await compiler.compileFile(args, compilerSource, compilerObject);
+    await compiler.linkFiles([compilerObject, coreLibrary], compilerFile, getBaseLFlags(target, link).concat(libraries));
+
+    const result = await subprocess.run(compilerFile, [bundleFile, bytecodeFile], {
+        name: "compile bundle",
+        category: "bundle",
+        detail: bundleFile
+    });
+
+    if (result.code != 0) {
+        throw new Error(result.stderr);
+    }
+}
+
 /**
  * Links the compiled object files and libraries into an executable.
  *
@@ -278,10 +581,19 @@ async function linkModules(modules: string[], executableFile: string, linkerFlag
  * @param target     - The target triple to build for.
  * @param bundleFile - The path to the JavaScript bundle file to embed.
  * @param output     - Information about the output configuration.
+ * @param link       - The options to link the executable with.
+ * @param label      - The label of the target if several targets are built concurrently, `null` otherwise.
  *
  * @return A promise that resolves to `true` if the native build was successful, `false` otherwise.
  */
-async function buildNativeCode(packages: PackageCollection, target: TargetTriple, bundleFile: string, output: OutputInformation): Promise<boolean> {
+async function buildNativeCode(
+    packages: PackageCollection,
+    target: TargetTriple,
+    bundleFile: string,
+    output: OutputInformation,
+    link: LinkOptions,
+    label: string | null
+): Promise<boolean> {
     if (!await compiler.isClangInstalled()) {
         console.log(chalk.red("Could not find clang. Ensure it is in your PATH environment"));
         return false;
@@ -294,8 +606,23 @@ async function buildNativeCode(packages: PackageCollection, target: TargetTriple
     const loadingFunctions: string[] = [];
     const modules: string[] = [];
     const libraries: Set<string> = new Set<string>();
+    let coreLibrary: string | null = null;
+    let pch: string | null = null;
+
+    if (!label) {
+        console.log(chalk.blue.bold("Compiling Native Code"));
+    }
 
-    console.log(chalk.blue.bold("Compiling Native Code"));
+    // The header only needs the instructions of core, so it is built before any module, including those that come
+    // before core. Modules are still compiled without it if clang can't build one
+    const pchSpinner: Ora = startSpinner(`  ${chalk.dim("Precompile header")} ${chalk.white("yaje.h")}`, label);
+    try {
+        pch = await timings.span("precompile yaje.h", "module", () => precompileCoreHeader(packages, target, output, link));
+        pchSpinner.succeed();
+    } catch (e) {
+        pchSpinner.warn();
+        console.log(chalk.yellow(`Could not precompile 'yaje.h', compiling without it: ${e}`));
+    }
 
     for (const module of packages) {
         if (!module.isNative) {
@@ -307,13 +634,16 @@ async function buildNativeCode(packages: PackageCollection, target: TargetTriple
             libraries.add(`-l${lib}`);
         }
 
-        const spinner = ora({
-            text: `  ${chalk.dim("Compile module")} ${chalk.white(module.packageJSON.name)}`,
-            color: 'cyan'
-        }).start();
+        const spinner: Ora = startSpinner(`  ${chalk.dim("Compile module")} ${chalk.white(module.packageJSON.name)}`, label);
 
         try {
-            modules.push(await compileModule(module, packages, target, output, output.cacheFolder));
+            const library: string = await timings.span(`module ${module.packageJSON.name}`, "module", () => {
+                return compileModule(module, packages, target, output, output.cacheFolder, link, pch);
+            });
+            if (module === packages.getCore()) {
+                coreLibrary = library;
+            }
+            modules.push(library);
             spinner.succeed();
         } catch (e) {
             spinner.fail();
@@ -322,17 +652,24 @@ async function buildNativeCode(packages: PackageCollection, target: TargetTriple
         }
     }
 
-    console.log();
-    const bundleSpinner = ora({
-        text: `  ${chalk.dim("Embed bundle")}`,
-        color: 'cyan'
-    }).start();
+    // Bytecode can only be produced by running the core library, so cross builds embed the source
+    const bundleBytecode: boolean = coreLibrary !== null
+        && compiler.getTargetTripleString(target) == compiler.getTargetTripleString(compiler.getHostTargetTriple());
+
+    if (!label) {
+        console.log();
+    }
+    const bundleSpinner: Ora = startSpinner(`  ${chalk.dim(bundleBytecode ? "Compile and embed bundle" : "Embed bundle")}`, label);
 
     try {
-        const bundleContent: Buffer = fs.readFileSync(bundleFile);
         const bundleObject: string = path.join(output.modFolder, "bundle.o");
         const bundleHashFile: string = path.join(output.cacheFolder, "bundle.hash");
-        const currentHash: string = crypto.createHash("sha256").update(bundleContent).digest("hex");
+        const hash: crypto.Hash = crypto.createHash("sha256").update(fs.readFileSync(bundleFile));
+        if (bundleBytecode) {
+            // The bytecode format depends on the engine, so a changed core library invalidates it as well
+            hash.update(fs.readFileSync(coreLibrary!));
+        }
+        const currentHash: string = hash.digest("hex");
 
         let skip = false;
         if (fs.existsSync(bundleObject) && fs.existsSync(bundleHashFile)) {
@@ -343,6 +680,15 @@ async function buildNativeCode(packages: PackageCollection, target: TargetTriple
         }
 
         if (!skip) {
+            let bundleContent: Buffer;
+            if (bundleBytecode) {
+                const bytecodeFile: string = path.join(output.genFolder, "bundle.bin");
+                await compileBundle(packages, target, bundleFile, coreLibrary!, Array.from(libraries), output, bytecodeFile, link);
+                bundleContent = fs.readFileSync(bytecodeFile);
+            } else {
+                bundleContent = fs.readFileSync(bundleFile);
+            }
+
             await compiler.embedFile(bundleContent, bundleObject, "JS_BUNDLE", target, ["-g"]);
             fs.writeFileSync(bundleHashFile, currentHash);
         }
@@ -355,13 +701,12 @@ async function buildNativeCode(packages: PackageCollection, target: TargetTriple
         return false;
     }
 
-    const entryPointSpinner = ora({
-        text: `  ${chalk.dim("Compile entry point")}`,
-        color: 'cyan'
-    }).start();
+    const entryPointSpinner: Ora = startSpinner(`  ${chalk.dim("Compile entry point")}`, label);
 
     try {
-        const entryPointObject: string = await buildEntryPoint(packages, output, loadingFunctions);
+        const entryPointObject: string = await timings.span("entry point", "module", () => {
+            return buildEntryPoint(packages, target, output, loadingFunctions, bundleBytecode, link);
+        });
         modules.push(entryPointObject);
         entryPointSpinner.succeed();
     } catch (e) {
@@ -370,16 +715,15 @@ async function buildNativeCode(packages: PackageCollection, target: TargetTriple
         return false;
     }
 
-    console.log();
-    console.log(chalk.blue.bold("Create Executable"));
+    if (!label) {
+        console.log();
+        console.log(chalk.blue.bold("Create Executable"));
+    }
     const executableFile: string = path.join(output.targetFolder, "a") + (target.platform == "windows" ? ".exe" : "");
 
-    const linkSpinner = ora({
-        text: `  ${chalk.dim("Linking modules")}`,
-        color: 'cyan'
-    }).start();
+    const linkSpinner: Ora = startSpinner(`  ${chalk.dim("Linking modules")}`, label);
 
-    const lFlags: string[] = getBaseLFlags(target).concat(Array.from(libraries));
+    const lFlags: string[] = getBaseLFlags(target, link).concat(Array.from(libraries));
 
     try {
         await linkModules(modules, executableFile, lFlags);
@@ -422,7 +766,9 @@ async function buildManagedCode(packages: PackageCollection, rootPKGName: string
         console.log();
         console.log(chalk.blue.bold("Bundling Project"));
         bundlerPkg = packages.getBundler();
-        gateway = await bundler.loadBundler(bundlerPkg, output);
+        gateway = await timings.span(`load bundler ${bundlerPkg.packageJSON.name}`, "bundle", () => {
+            return bundler.loadBundler(bundlerPkg, output);
+        });
     } catch (e) {
         console.log(chalk.red(`Could not bundle code: ${e}`));
         return false;
@@ -434,8 +780,11 @@ async function buildManagedCode(packages: PackageCollection, rootPKGName: string
     }).start();
 
     try {
-        await gateway.init();
-        const bundleFile = await gateway.bundle(rootPkg.packageJSON.main);
+        const main: string = rootPkg.packageJSON.main;
+        const bundleFile: string = await timings.span(`bundle ${rootPkg.packageJSON.name}`, "bundle", async () => {
+            await gateway.init();
+            return await gateway.bundle(main);
+        });
         bundleSpinner.succeed();
         return bundleFile;
     } catch (e) {
@@ -445,19 +794,109 @@ async function buildManagedCode(packages: PackageCollection, rootPKGName: string
     }
 }
 
+/**
+ * A target to build, together with the options to link its executable.
+ */
+export interface BuildTarget {
+    target: TargetTriple;
+    link: LinkOptions;
+}
+
 /**
  * The main build function that handles both managed and native code compilation.
  *
- * @param target - The target triple to build the project for.
+ * @param target      - The target triple to build the project for.
+ * @param withTimings - Whether every build step is timed and a report is written to the target folder.
+ * @param link        - The options to link the executable with, defaults to {@link getDefaultLinkOptions}.
+ *
+ * @return A promise that resolves to the exit code (0 for success, 1 for failure).
+ */
+export async function build(target: TargetTriple, withTimings: boolean = false, link: LinkOptions = getDefaultLinkOptions(target)): Promise<number> {
+    return await buildTargets([{target, link}], withTimings);
+}
+
+/**
+ * Builds the project for several targets at once. The JavaScript bundle is built once and shared, the native code of
+ * all targets is compiled concurrently into the folder of each target.
+ *
+ * @param targets     - The targets to build the project for.
+ * @param withTimings - Whether every build step is timed and a report is written to the folder of the first target.
+ *
+ * @return A promise that resolves to the exit code (0 for success, 1 for failure).
+ */
+export async function buildTargets(targets: BuildTarget[], withTimings: boolean = false): Promise<number> {
+    for (const {target, link} of targets) {
+        const linkError: string | null = validateLinkOptions(target, link);
+        if (linkError) {
+            console.log(chalk.red(`${compiler.getTargetTripleString(target)}: ${linkError}`));
+            return 1;
+        }
+    }
+
+    if (!withTimings) {
+        return await buildProject(targets);
+    }
+
+    timings.startRecording();
+    let code: number = 1;
+    try {
+        code = await timings.span("build", "build", () => buildProject(targets));
+    } finally {
+        const report: timings.TimingReport | null = timings.stopRecording();
+        if (report) {
+            printTimings(report, targets[0]!.target);
+        }
+    }
+
+    return code;
+}
+
+/**
+ * Prints a summary of the recorded build steps and writes the full report.
+ *
+ * @param report - The recorded timings.
+ * @param target - The target triple the project was built for.
+ */
+function printTimings(report: timings.TimingReport, target: TargetTriple): void {
+    const output: OutputInformation = generateOutputInformation(process.cwd(), compiler.getTargetTripleString(target));
+    const htmlFile: string = timings.writeReport(report, output.targetFolder);
+
+    console.log();
+    console.log(`${chalk.blue.bold("Build timings")} ${chalk.dim(`${report.total.toFixed(0)} ms total, ${report.criticalPath.toFixed(0)} ms critical path`)}`);
+
+    for (const [category, duration] of timings.summarizeCategories(report)) {
+        console.log(`  ${category.padEnd(12)} ${`${duration.toFixed(0)} ms`.padStart(10)} ${chalk.dim(`${(duration / report.total * 100).toFixed(1)}%`)}`);
+    }
+
+    const slowest: timings.TimingSpan[] = report.spans
+        .filter(span => span.critical && span.category != "build")
+        .sort((a, b) => (b.end - b.start) - (a.end - a.start))
+        .slice(0, 5);
+
+    if (slowest.length > 0) {
+        console.log(chalk.dim("  Slowest steps on the critical path:"));
+        for (const span of slowest) {
+            console.log(`    ${span.name} ${chalk.dim(`${(span.end - span.start).toFixed(0)} ms`)}`);
+        }
+    }
+
+    console.log(chalk.dim(`  Report written to ${htmlFile}`));
+}
+
+/**
+ * Resolves, bundles, compiles and links the project.
+ *
+ * @param targets - The targets to build the project for.
  *
  * @return A promise that resolves to the exit code (0 for success, 1 for failure).
  */
-export async function build(target: TargetTriple): Promise<number> {
-    const targetString: string = compiler.getTargetTripleString(target);
-    console.log(`${chalk.blue.bold("Building project for")} ${chalk.cyan.bold(targetString)}`);
+async function buildProject(targets: BuildTarget[]): Promise<number> {
+    const targetStrings: string[] = targets.map(({target}) => compiler.getTargetTripleString(target));
+    console.log(`${chalk.blue.bold("Building project for")} ${targetStrings.map(targetString => chalk.cyan.bold(targetString)).join(", ")}`);
 
-    const packages: PackageCollection = new PackageCollection();
     const cwd: string = process.cwd();
+    const outputs: OutputInformation[] = targetStrings.map(targetString => generateOutputInformation(cwd, targetString));
+    const packages: PackageCollection[] = targets.map(() => new PackageCollection());
 
     let rootPackage: string;
 
@@ -467,7 +906,16 @@ export async function build(target: TargetTriple): Promise<number> {
     }).start();
 
     try {
-        rootPackage = await checkPackageJSON(cwd, cwd, target, packages);
+        // Build files may configure every target differently, so each target resolves its own tree
+        const rootPackages: string[] = await timings.span("dependency tree", "resolve", () => {
+            return Promise.all(targets.map(async ({target}, i) => {
+                const cache: builder.InstructionCache = await builder.InstructionCache.load(path.join(outputs[i]!.cacheFolder, "instructions.json"));
+                const name: string = await checkPackageJSON(cwd, cwd, target, packages[i]!, cache);
+                await cache.save();
+                return name;
+            }));
+        });
+        rootPackage = rootPackages[0]!;
         dependencySpinner.succeed();
     } catch (e) {
         dependencySpinner.fail();
@@ -475,15 +923,20 @@ export async function build(target: TargetTriple): Promise<number> {
         return 1;
     }
 
-    const output: OutputInformation = generateOutputInformation(cwd, compiler.getTargetTripleString(target));
-    const bundleFile: string | false = await buildManagedCode(packages, rootPackage, output);
+    // The bundle does not depend on the target, it is built once into the folder of the first target
+    const bundleFile: string | false = await buildManagedCode(packages[0]!, rootPackage, outputs[0]!);
     if (!bundleFile) {
         return 1;
     }
 
     console.log();
 
-    if (!await buildNativeCode(packages, target, bundleFile, output)) {
+    const results: boolean[] = await Promise.all(targets.map(({target, link}, i) => {
+        const label: string | null = targets.length > 1 ? targetStrings[i]! : null;
+        return buildNativeCode(packages[i]!, target, bundleFile, outputs[i]!, link, label);
+    }));
+
+    if (results.includes(false)) {
         return 1;
     }
 
@@ -0,0 +1,137 @@
+import * as fs from "fs";
+
+import chalk from "chalk";
+
+import {formatTime} from "@yaje/bench/stats";
+
+interface BenchResult {
+    name: string;
+    mean: number;
+    rme: number;
+    samples: number;
+}
+
+interface BenchReport {
+    schema: number;
+    timestamp: string;
+    results: BenchResult[];
+}
+
+interface Comparison {
+    name: string;
+    baseline: BenchResult;
+    current: BenchResult;
+    change: number;
+    significant: boolean;
+}
+
+/**
+ * Reads a JSON report written by `@yaje/bench`.
+ *
+ * @param file - The path to the report.
+ *
+ * @return The parsed report.
+ */
+function readReport(file: string): BenchReport {
+    let json: BenchReport;
+    try {
+        json = JSON.parse(fs.readFileSync(file, "utf-8"));
+    } catch (e) {
+        throw new Error(`Failed to read benchmark report '${file}'`, {cause: e});
+    }
+
+    if (json.schema != 1 || !Array.isArray(json.results)) {
+        throw new Error(`'${file}' is not a @yaje/bench report`);
+    }
+
+    return json;
+}
+
+/**
+ * Compares two benchmark reports and prints the change of every benchmark present in both.
+ *
+ * A change counts as significant if it exceeds both the threshold and the combined margin of error of the two runs.
+ *
+ * @param baselineFile - The report of the baseline build.
+ * @param currentFile  - The report of the build under test.
+ * @param threshold    - The minimum change in percent that is reported as a regression or improvement.
+ *
+ * @return A promise that resolves to 0 if no benchmark regressed, or 1 otherwise.
+ */
+export default async function compare(baselineFile: string, currentFile: string, threshold: number): Promise<number> {
+    let baseline: BenchReport;
+    let current: BenchReport;
+
+    try {
+        baseline = readReport(baselineFile);
+        current = readReport(currentFile);
+    } catch (e) {
+        console.log(chalk.red(`${e}`));
+        return 1;
+    }
+
+    const baselineResults: Map<string, BenchResult> = new Map(baseline.results.map((result): [string, BenchResult] => [result.name, result]));
+    const comparisons: Comparison[] = [];
+    const added: string[] = [];
+
+    for (const result of current.results) {
+        const base: BenchResult | undefined = baselineResults.get(result.name);
+        baselineResults.delete(result.name);
+        if (!base) {
+            added.push(result.name);
+            continue;
+        }
+
+        const change: number = (result.mean - base.mean) / base.mean * 100;
+        const noise: number = Math.sqrt(base.rme * base.rme + result.rme * result.rme);
+
+        comparisons.push({
+            name: result.name,
+            baseline: base,
+            current: result,
+            change,
+            significant: Math.abs(change) > Math.max(threshold, noise)
+        });
+    }
+
+    console.log(`${chalk.blue.bold("Comparing")} ${chalk.white(baselineFile)} ${chalk.dim("→")} ${chalk.white(currentFile)}`);
+    console.log();
+
+    const nameWidth: number = Math.max(9, ...comparisons.map(comparison => comparison.name.length));
+    console.log(chalk.dim(`  ${"benchmark".padEnd(nameWidth)}  ${"baseline".padStart(12)}  ${"current".padStart(12)}  ${"change".padStart(9)}`));
+
+    let regressions: number = 0;
+    let improvements: number = 0;
+
+    for (const comparison of comparisons) {
+        const change: string = `${comparison.change >= 0 ? "+" : ""}${comparison.change.toFixed(2)}%`.padStart(9);
+        let status: string = chalk.dim(change);
+
+        // Times are per iteration, so a positive change is a slowdown
+        if (comparison.significant && comparison.change > 0) {
+            status = chalk.red.bold(change);
+            regressions++;
+        } else if (comparison.significant) {
+            status = chalk.green.bold(change);
+            improvements++;
+        }
+
+        console.log(`  ${comparison.name.padEnd(nameWidth)}  ${formatTime(comparison.baseline.mean).padStart(12)}  ${formatTime(comparison.current.mean).padStart(12)}  ${status}`);
+    }
+
+    for (const name of added) {
+        console.log(chalk.dim(`  ${name} (only in current)`));
+    }
+    for (const name of baselineResults.keys()) {
+        console.log(chalk.dim(`  ${name} (only in baseline)`));
+    }
+
+    console.log();
+    if (regressions > 0) {
+        console.log(chalk.red.bold(`${regressions} regression(s)`) + chalk.dim(`, ${improvements} improvement(s)`));
+        return 1;
+    }
+
+    console.log(chalk.green.bold("No regressions") + chalk.dim(`, ${improvements} improvement(s)`));
+    return 0;
+}
@@ -7,23 +7,99 @@ import type {TargetTriple} from "@yaje/core/builder";
 import * as compiler from "../compiler.js";
 import packageJSON from "../../package.json" with { type: "json" };
 
-import {build} from "./build.js";
+import {build, buildTargets, type BuildTarget, getDefaultLinkOptions, type LinkOptions} from "./build.js";
 import init from "./init.js";
 import cdb from "./cdb.js";
+import compare from "./compare.js";
+import benchStartup from "./startup.js";
 import path from "path";
 
 const program = new Command();
 
+/**
+ * Adds the options that control how the executable is linked.
+ *
+ * @param command - The command to add the options to.
+ *
+ * @return The command for chaining.
+ */
+function addLinkOptions(command: Command): Command {
+    return command
+        .option("--linker <linker>", "Link with another linker, e.g. lld or mold")
+        .option("--static", "Link all libraries statically, the default for musl targets")
+        .option("--no-static", "Link dynamically, even for musl targets")
+        .option("--binding <mode>", "Bind symbols 'now' at load time or 'lazy' on first call")
+        .option("--no-pie", "Build a position dependent executable");
+}
+
+/**
+ * Collects the link options of a command, options that are not given keep the defaults of the target.
+ *
+ * @param target  - The target triple to build for.
+ * @param options - The parsed command options.
+ *
+ * @return The link options.
+ */
+function getLinkOptions(target: TargetTriple, options: any): LinkOptions {
+    const link: LinkOptions = getDefaultLinkOptions(target);
+
+    if (options.linker) {
+        link.linker = options.linker;
+    }
+    if (options.static !== undefined) {
+        link.static = options.static;
+    }
+    if (options.binding) {
+        link.binding = options.binding;
+    }
+    link.pie = options.pie;
+
+    return link;
+}
+
 program
     .name("yaje")
     .description("YAJE CLI tool")
     .version(packageJSON.version);
 
-program
+addLinkOptions(program
     .command("build")
     .description("Build the project")
     .option("-t --target <target>", "A valid Clang target triple")
+    .option("--targets <targets>", "Comma separated target triples that are built together and share one bundle")
+    .option("--timings", "Record every build step and write a timing report"))
     .action(async (options) => {
+        if (options.targets) {
+            if (options.target) {
+                console.log(chalk.red("Use either --target or --targets."));
+                return;
+            }
+
+            const targets: BuildTarget[] = [];
+            const seen: Set<string> = new Set<string>();
+            for (const triple of (options.targets as string).split(",").map(triple => triple.trim()).filter(triple => triple.length > 0)) {
+                const target: TargetTriple | null = compiler.parseTargetTriple(triple);
+                if (!target) {
+                    console.log(chalk.red(`Failed to parse target triple '${triple}'.`));
+                    return;
+                }
+
+                // Targets written differently but resolving to the same triple share their output folder
+                const targetString: string = compiler.getTargetTripleString(target);
+                if (!seen.has(targetString)) {
+                    seen.add(targetString);
+                    targets.push({target, link: getLinkOptions(target, options)});
+                }
+            }
+
+            if (targets.length == 0) {
+                console.log(chalk.red("No target triple given."));
+                return;
+            }
+
+            process.exit(await buildTargets(targets, options.timings ?? false));
+        }
+
         const target: TargetTriple | null = options.target
             ? compiler.parseTargetTriple(options.target)
             : compiler.getHostTargetTriple();
@@ -33,7 +109,7 @@ program
             return;
         }
 
-        process.exit(await build(target));
+        process.exit(await build(target, options.timings ?? false, getLinkOptions(target, options)));
     });
 
 program
@@ -63,4 +139,48 @@ program
         process.exit(await cdb(target, out));
     });
 
+program
+    .command("bench-compare")
+    .description("Compare two @yaje/bench JSON reports")
+    .argument("<baseline>", "Report of the baseline build")
+    .argument("<current>", "Report of the build under test")
+    .option("--threshold <percent>", "Minimum change reported as regression or improvement", "5")
+    .action(async (baseline: string, current: string, options) => {
+        const threshold: number = Number(options.threshold);
+        if (Number.isNaN(threshold) || threshold < 0) {
+            console.log(chalk.red("Threshold must be a positive number."));
+            return;
+        }
+
+        process.exit(await compare(baseline, current, threshold));
+    });
+
+addLinkOptions(program
+    .command("bench-startup")
+    .description("Build the project and measure the startup latency of the executable")
+    .option("-t --target <target>", "A valid Clang target triple")
+    .option("-n --runs <count>", "Number of measured runs", "20")
+    .option("--warmup <count>", "Number of discarded warmup runs", "2")
+    .option("--no-build", "Measure the existing executable without rebuilding")
+    .option("--json <path>", "Write a @yaje/bench compatible report"))
+    .action(async (options) => {
+        const target: TargetTriple | null = options.target
+            ? compiler.parseTargetTriple(options.target)
+            : compiler.getHostTargetTriple();
+
+        if (!target) {
+            console.log(chalk.red("Failed to parse target triple."));
+            return;
+        }
+
+        const runs: number = Number(options.runs);
+        const warmup: number = Number(options.warmup);
+        if (!Number.isInteger(runs) || runs < 1 || !Number.isInteger(warmup) || warmup < 0) {
+            console.log(chalk.red("Runs and warmup must be whole numbers."));
+            return;
+        }
+
+        process.exit(await benchStartup(target, runs, warmup, options.build, options.json ?? null, getLinkOptions(target, options)));
+    });
+
 program.parse();
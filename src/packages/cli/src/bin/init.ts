@@ -143,6 +143,7 @@ export default async function init(): Promise<number> {
                 {title: "@yaje/core", value: "@yaje/core", disabled: true, selected: true},
                 {title: "@yaje/console", value: "@yaje/console"},
                 {title: "@yaje/fs", value: "@yaje/fs"},
+                {title: "@yaje/path", value: "@yaje/path"},
             ]
         }
     ]);
@@ -0,0 +1,224 @@
+import * as path from "path";
+import * as fs from "fs";
+import * as os from "os";
+import * as child_process from "child_process";
+
+import chalk from "chalk";
+
+import {generateOutputInformation, type OutputInformation, type TargetTriple} from "@yaje/core/builder";
+import {formatTime, type Statistics, summarize} from "@yaje/bench/stats";
+
+import * as compiler from "../compiler.js";
+import {build, type LinkOptions} from "./build.js";
+
+interface TraceMark {
+    label: string;
+    time: bigint;
+}
+
+interface StartupRun {
+    wall: number;
+    phases: Map<string, number>;
+}
+
+interface PhaseSummary extends Statistics {
+    name: string;
+}
+
+// Display names of the marks the runtime records, see yaje_core_trace
+const PHASE_NAMES: Record<string, string> = {
+    exec: "exec / page-in",
+    ctor: "yaje_core_ctor",
+    compile: "bundle compile",
+    evaluate: "module evaluation",
+    jobs: "pending jobs",
+    free: "teardown",
+    exit: "process exit"
+};
+
+/**
+ * Returns the display name of a startup phase.
+ *
+ * @param phase - The label recorded by the runtime.
+ *
+ * @return The display name.
+ */
+function phaseName(phase: string): string {
+    if (phase.startsWith("load:")) {
+        return `load ${phase.substring(5)}`;
+    }
+
+    return PHASE_NAMES[phase] ?? phase;
+}
+
+/**
+ * Parses a trace file written by the runtime when `YAJE_STARTUP_TRACE` is set.
+ *
+ * @param file - The path to the trace file.
+ *
+ * @return The recorded marks in order.
+ */
+function readTrace(file: string): TraceMark[] {
+    return fs.readFileSync(file, "utf-8")
+        .split("\n")
+        .filter(line => line.length > 0)
+        .map(line => {
+            const [label, time] = line.split("\t");
+            return {label: label ?? "", time: BigInt(time ?? "0")};
+        });
+}
+
+/**
+ * Runs the executable once with startup tracing enabled.
+ *
+ * @param executableFile - The path to the executable.
+ * @param traceFile      - The file the runtime writes its marks to.
+ *
+ * @return A promise that resolves to the wall time and the duration of every phase in nanoseconds.
+ */
+async function runOnce(executableFile: string, traceFile: string): Promise<StartupRun> {
+    if (fs.existsSync(traceFile)) {
+        fs.rmSync(traceFile);
+    }
+
+    const env: NodeJS.ProcessEnv = {...process.env, YAJE_STARTUP_TRACE: traceFile};
+
+    // Both timestamps use the monotonic clock the runtime uses for its marks
+    const spawned: bigint = process.hrtime.bigint();
+    const exited: bigint = await new Promise<bigint>((resolve, reject) => {
+        const child = child_process.spawn(executableFile, [], {env, stdio: "ignore"});
+        child.on("error", reject);
+        child.on("exit", code => {
+            const end: bigint = process.hrtime.bigint();
+            if (code != 0) {
+                reject(new Error(`Executable exited with code ${code}`));
+                return;
+            }
+            resolve(end);
+        });
+    });
+
+    if (!fs.existsSync(traceFile)) {
+        throw new Error("Executable did not write a startup trace, rebuild it with the current runtime");
+    }
+
+    const marks: TraceMark[] = readTrace(traceFile);
+    const phases: Map<string, number> = new Map();
+    const wall: number = Number(exited - spawned);
+
+    const first: TraceMark | undefined = marks[0];
+    if (first) {
+        const exec: number = Number(first.time - spawned);
+        // Only meaningful if the child shares our clock, otherwise it's absorbed into the wall time
+        if (exec >= 0 && exec <= wall) {
+            phases.set("exec", exec);
+        }
+    }
+
+    for (let i = 1; i < marks.length; i++) {
+        const previous: TraceMark = marks[i - 1]!;
+        const current: TraceMark = marks[i]!;
+        phases.set(current.label, (phases.get(current.label) ?? 0) + Number(current.time - previous.time));
+    }
+
+    const last: TraceMark | undefined = marks[marks.length - 1];
+    if (last && last.time <= exited) {
+        phases.set("exit", Number(exited - last.time));
+    }
+
+    return {wall, phases};
+}
+
+/**
+ * Builds the project and measures the startup latency of the executable.
+ *
+ * The runtime records a timestamp after every startup step when `YAJE_STARTUP_TRACE` is set, the wall time of every
+ * run is broken down into these steps. The JSON report uses the `@yaje/bench` format and can be passed to
+ * `yaje bench-compare`.
+ *
+ * @param target  - The target triple to build for, must be runnable on the host.
+ * @param runs    - The number of measured runs.
+ * @param warmup  - The number of runs discarded to warm up the page cache.
+ * @param rebuild - Whether to build the project before measuring.
+ * @param json    - An optional path to write the report to.
+ * @param link    - The options to link the executable with when rebuilding.
+ *
+ * @return A promise that resolves to the exit code (0 for success, 1 for failure).
+ */
+export default async function benchStartup(target: TargetTriple, runs: number, warmup: number, rebuild: boolean, json: string | null, link: LinkOptions): Promise<number> {
+    const targetString: string = compiler.getTargetTripleString(target);
+    if (targetString != compiler.getTargetTripleString(compiler.getHostTargetTriple())) {
+        console.log(chalk.red(`Cannot run executables for ${targetString} on this host.`));
+        return 1;
+    }
+
+    if (rebuild) {
+        const code: number = await build(target, false, link);
+        if (code != 0) {
+            return code;
+        }
+        console.log();
+    }
+
+    const output: OutputInformation = generateOutputInformation(process.cwd(), targetString);
+    const executableFile: string = path.join(output.targetFolder, "a") + (target.platform == "windows" ? ".exe" : "");
+    if (!fs.existsSync(executableFile)) {
+        console.log(chalk.red(`Could not find executable '${executableFile}', build the project first.`));
+        return 1;
+    }
+
+    const traceFolder: string = fs.mkdtempSync(path.join(os.tmpdir(), "yaje-startup-"));
+    const traceFile: string = path.join(traceFolder, "trace");
+    const samples: StartupRun[] = [];
+
+    console.log(`${chalk.blue.bold("Measuring startup of")} ${chalk.white(executableFile)} ${chalk.dim(`(${runs} runs, ${warmup} warmup)`)}`);
+
+    try {
+        for (let i = 0; i < warmup + runs; i++) {
+            const run: StartupRun = await runOnce(executableFile, traceFile);
+            if (i >= warmup) {
+                samples.push(run);
+            }
+        }
+    } catch (e) {
+        console.log(chalk.red(`Startup run failed: ${e}`));
+        return 1;
+    } finally {
+        fs.rmSync(traceFolder, {recursive: true, force: true});
+    }
+
+    // Phase order follows the first run, later runs record the same marks
+    const order: string[] = Array.from(samples[0]?.phases.keys() ?? []);
+    const exec: number = order.indexOf("exec");
+    if (exec > 0) {
+        order.splice(exec, 1);
+        order.unshift("exec");
+    }
+
+    const phases: PhaseSummary[] = order.map(phase => ({name: phase, ...summarize(samples.map(run => run.phases.get(phase) ?? 0))}));
+    const wall: PhaseSummary = {name: "wall", ...summarize(samples.map(run => run.wall))};
+
+    console.log();
+    const nameWidth: number = Math.max(5, ...phases.map(phase => phaseName(phase.name).length));
+    console.log(chalk.dim(`  ${"phase".padEnd(nameWidth)}  ${"median".padStart(11)}  ${"mean".padStart(11)}  ${"min".padStart(11)}  ${"share".padStart(6)}`));
+
+    for (const phase of phases) {
+        const share: string = `${(phase.median / wall.median * 100).toFixed(1)}%`;
+        console.log(`  ${phaseName(phase.name).padEnd(nameWidth)}  ${formatTime(phase.median).padStart(11)}  ${formatTime(phase.mean).padStart(11)}  ${formatTime(phase.min).padStart(11)}  ${chalk.dim(share.padStart(6))}`);
+    }
+
+    console.log(chalk.bold(`  ${"wall".padEnd(nameWidth)}  ${formatTime(wall.median).padStart(11)}  ${formatTime(wall.mean).padStart(11)}  ${formatTime(wall.min).padStart(11)}`));
+
+    if (json) {
+        const report = {
+            schema: 1,
+            timestamp: new Date().toISOString(),
+            results: [wall, ...phases].map(phase => ({...phase, name: `startup/${phase.name}`}))
+        };
+        fs.writeFileSync(json, JSON.stringify(report, null, 2));
+        console.log();
+        console.log(chalk.dim(`Report written to ${json}`));
+    }
+
+    return 0;
+}
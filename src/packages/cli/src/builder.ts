@@ -1,58 +1,276 @@
 import * as path from "path";
 import * as fs from "fs";
+import * as crypto from "crypto";
+import * as url from "url";
 
 import {CFG, type CFGResult, type TargetTriple} from "@yaje/core/builder";
 
+import * as timings from "./timings.js";
+import {getTargetTripleString} from "./compiler.js";
+
 const BUILD_FILES: string[] = [
     "yaje.build.js",
     "yaje.build.mjs"
 ]
 
+// Increased whenever the layout of the instruction cache changes
+const INSTRUCTION_CACHE_VERSION: number = 1;
+
+/**
+ * Build instructions together with the state of the files they were loaded from.
+ */
+interface CachedInstructions {
+    packageJSONMtime: number;
+    buildFile: string;
+    buildFileMtime: number;
+    listingHash: string;
+    instructions: CFGResult;
+}
+
+/**
+ * The content of the instruction cache file.
+ */
+interface InstructionCacheFile {
+    version: string;
+    entries: Record<string, CachedInstructions>;
+}
+
+/**
+ * Caches the results of build files between builds, so packages whose build file, package.json and source folders are
+ * unchanged don't have to be imported again.
+ */
+export class InstructionCache {
+    private readonly file: string;
+    private readonly version: string;
+    private readonly entries: Map<string, CachedInstructions>;
+    private dirty: boolean = false;
+
+    private constructor(file: string, version: string, entries: Map<string, CachedInstructions>) {
+        this.file = file;
+        this.version = version;
+        this.entries = entries;
+    }
+
+    /**
+     * Loads the cache from a file. A missing or unreadable file, or one written by another version of the cache or of
+     * the core builder, results in an empty cache.
+     *
+     * @param file - The path to the cache file.
+     *
+     * @return The cache.
+     */
+    public static async load(file: string): Promise<InstructionCache> {
+        // The instructions are produced by the CFG class of @yaje/core, a changed CFG may produce other ones
+        const builderFile: string = url.fileURLToPath(import.meta.resolve("@yaje/core/builder"));
+        const builderHash: string = crypto.hash("SHA256", await fs.promises.readFile(builderFile), "base64");
+        const version: string = `${INSTRUCTION_CACHE_VERSION}:${builderHash}`;
+
+        let entries: Record<string, CachedInstructions> = {};
+        try {
+            const content: InstructionCacheFile = JSON.parse(await fs.promises.readFile(file, "utf-8"));
+            if (content.version == version) {
+                entries = content.entries;
+            }
+        } catch (e) {
+            // Rebuilt from scratch
+        }
+
+        return new InstructionCache(file, version, new Map(Object.entries(entries)));
+    }
+
+    /**
+     * Returns the cached instructions of a package if none of the files they depend on changed.
+     *
+     * @param projectDir - The path to the package directory.
+     * @param buildFile  - The path to the build file of the package.
+     *
+     * @return The cached instructions, or `null` if they are missing or outdated.
+     */
+    public async get(projectDir: string, buildFile: string): Promise<CFGResult | null> {
+        const entry: CachedInstructions | undefined = this.entries.get(projectDir);
+        if (!entry || entry.buildFile != buildFile) {
+            return null;
+        }
+
+        const [packageJSONMtime, buildFileMtime, listingHash] = await Promise.all([
+            getMtime(path.join(projectDir, "package.json")),
+            getMtime(buildFile),
+            hashListings(entry.instructions.sourceDirs)
+        ]);
+
+        if (packageJSONMtime != entry.packageJSONMtime || buildFileMtime != entry.buildFileMtime || listingHash != entry.listingHash) {
+            return null;
+        }
+
+        return entry.instructions;
+    }
+
+    /**
+     * Stores the instructions of a package together with the current state of its files.
+     *
+     * @param projectDir   - The path to the package directory.
+     * @param buildFile    - The path to the build file of the package.
+     * @param instructions - The instructions loaded from the build file.
+     */
+    public async set(projectDir: string, buildFile: string, instructions: CFGResult): Promise<void> {
+        const [packageJSONMtime, buildFileMtime, listingHash] = await Promise.all([
+            getMtime(path.join(projectDir, "package.json")),
+            getMtime(buildFile),
+            hashListings(instructions.sourceDirs)
+        ]);
+
+        this.entries.set(projectDir, {packageJSONMtime, buildFile, buildFileMtime, listingHash, instructions});
+        this.dirty = true;
+    }
+
+    /**
+     * Writes the cache back to its file if it changed.
+     */
+    public async save(): Promise<void> {
+        if (!this.dirty) {
+            return;
+        }
+
+        const content: InstructionCacheFile = {version: this.version, entries: Object.fromEntries(this.entries)};
+        await fs.promises.writeFile(this.file, JSON.stringify(content));
+        this.dirty = false;
+    }
+}
+
+/**
+ * Returns the modification time of a file.
+ *
+ * @param filePath - The path to the file.
+ *
+ * @return The modification time in milliseconds, or -1 if the file does not exist.
+ */
+async function getMtime(filePath: string): Promise<number> {
+    try {
+        return (await fs.promises.stat(filePath)).mtimeMs;
+    } catch (e) {
+        return -1;
+    }
+}
+
+/**
+ * Hashes the names and types of the entries of directories, so added, removed or renamed sources are detected.
+ *
+ * @param dirs - The paths to the directories.
+ *
+ * @return The hash string.
+ */
+async function hashListings(dirs: string[]): Promise<string> {
+    const listings: fs.Dirent[][] = await Promise.all(dirs.map(dir => {
+        return fs.promises.readdir(dir, {withFileTypes: true}).catch(() => []);
+    }));
+
+    const hash: crypto.Hash = crypto.createHash("sha256");
+    for (let i: number = 0; i < dirs.length; i++) {
+        hash.update(dirs[i]!);
+
+        const entries: string[] = listings[i]!.map(entry => `${entry.name}:${entry.isDirectory() ? "d" : "f"}`).sort();
+        for (const entry of entries) {
+            hash.update("\0");
+            hash.update(entry);
+        }
+        hash.update("\n");
+    }
+
+    return hash.digest("hex");
+}
+
 /**
  * Searches for a build configuration file in the specified project directory.
  *
  * @param projectDir - The path to the project directory to search in.
  *
- * @return The file URL of the build configuration file if found, or `null` otherwise.
+ * @return The path of the build configuration file if found, or `null` otherwise.
  */
-function getBuildFile(projectDir: string): string | null {
+async function getBuildFile(projectDir: string): Promise<string | null> {
     for (const fileName of BUILD_FILES) {
         const filePath: string = path.join(projectDir, fileName);
 
-        if (fs.existsSync(filePath) && fs.statSync(filePath).isFile()) {
-            return `file:///${filePath}`;
+        try {
+            if ((await fs.promises.stat(filePath)).isFile()) {
+                return filePath;
+            }
+        } catch (e) {
+            // Try the next name
         }
     }
 
     return null;
 }
 
+// Build files configure the CFG through its static fields, so only one of them may be evaluated at a time
+let importQueue: Promise<unknown> = Promise.resolve();
+
+/**
+ * Imports a build file and completes the CFG it exports, waiting for imports that are already running.
+ *
+ * @param projectDir - The path to the project directory containing the build file.
+ * @param buildFile  - The path to the build file.
+ * @param target     - The target triple for which to load the build instructions.
+ * @param name       - The name of the module.
+ *
+ * @return A promise that resolves to the CFGResult.
+ */
+function importBuildFile(projectDir: string, buildFile: string, target: TargetTriple, name: string): Promise<CFGResult> {
+    const result: Promise<CFGResult> = importQueue.then(async () => {
+        CFG.projectDir = projectDir;
+        CFG.target = target;
+        CFG.moduleName = name;
+
+        // Build files depend on the target, the query makes every target evaluate its own instance
+        const url: string = `file:///${buildFile}?target=${getTargetTripleString(target)}`;
+        const module: any = await timings.span(`import ${name}`, "build-file", () => import(url), buildFile);
+        if (!("default" in module)) {
+            throw new Error("Build file contains no default export");
+        }
+
+        if (!(module.default instanceof CFG)) {
+            throw new Error("Default export is not of type 'CFG'");
+        }
+
+        return module.default.complete();
+    });
+
+    importQueue = result.catch(() => undefined);
+    return result;
+}
+
 /**
  * Loads build instructions from a build configuration file in the specified project directory.
  *
  * @param projectDir - The path to the project directory containing the build file.
  * @param target     - The target triple for which to load the build instructions.
+ * @param name       - The name of the module.
+ * @param cache      - The cache to take unchanged instructions from and to store loaded ones in.
  *
  * @return A promise that resolves to the CFGResult if successful, or `null` if no build file is found.
  */
-export async function loadBuildInstructions(projectDir: string, target: TargetTriple, name: string = "unnamed"): Promise<CFGResult | null> {
-    CFG.projectDir = projectDir;
-    CFG.target = target;
-    CFG.moduleName = name;
-
-    const buildFile: string | null = getBuildFile(projectDir);
+export async function loadBuildInstructions(
+    projectDir: string,
+    target: TargetTriple,
+    name: string = "unnamed",
+    cache: InstructionCache | null = null
+): Promise<CFGResult | null> {
+    const buildFile: string | null = await getBuildFile(projectDir);
     if (!buildFile) {
         return null;
     }
 
-    const module: any = await import(buildFile);
-    if (!("default" in module)) {
-        throw new Error("Build file contains no default export");
+    if (cache) {
+        const cached: CFGResult | null = await cache.get(projectDir, buildFile);
+        if (cached) {
+            return cached;
+        }
     }
 
-    if (!(module.default instanceof CFG)) {
-        throw new Error("Default export is not of type 'CFG'");
+    const instructions: CFGResult = await importBuildFile(projectDir, buildFile, target, name);
+    if (cache) {
+        await cache.set(projectDir, buildFile, instructions);
     }
 
-    return module.default.complete();
+    return instructions;
 }
\ No newline at end of file
@@ -3,10 +3,10 @@ import * as fs from "fs";
 import * as crypto from "crypto";
 
 import type {CFGResult, TargetTriple} from "@yaje/core/builder";
-import * as child_process from "node:child_process";
 import type {Writable} from "node:stream";
 
 import * as subprocess from "./subprocess.js";
+import * as timings from "./timings.js";
 
 /**
  * Checks if Clang is installed and available in the system path.
@@ -222,7 +222,11 @@ export function generateCompilerArguments(dependencies: CFGResult[], module: CFG
  * @return True if compilation was successful.
  */
 export async function compileFile(args: string[], source: string, object: string): Promise<boolean> {
-    const result = await subprocess.run("clang", args.concat(source, "-o", object));
+    const result = await subprocess.run("clang", args.concat(source, "-o", object), {
+        name: `clang ${path.basename(source)}`,
+        category: "compile",
+        detail: source
+    });
 
     if (result.code != 0) {
         throw new Error(result.stderr);
@@ -256,12 +260,16 @@ export async function getDependencies(args: string[], source: string): Promise<s
         }
     }
 
-    const result = await subprocess.run("clang", ["-MM", ...finalArgs, source]);
+    const result = await subprocess.run("clang", ["-MM", ...finalArgs, source], {
+        name: `clang -MM ${path.basename(source)}`,
+        category: "deps",
+        detail: source
+    });
     if (result.code != 0) {
         return [];
     }
 
-    const output = result.stdout.replace(/\\\r?\n/g, "").replace(`${path.basename(source, ".c")}.o:`, "");
+    const output = result.stdout.replace(/\\\r?\n/g, "").replace(`${path.basename(source, path.extname(source))}.o:`, "");
     return output.split(/\s+/).filter(file => file.length > 0).map(file => path.resolve(path.dirname(source), file));
 }
 
@@ -299,15 +307,17 @@ function streamFileToHash(filePath: string, hash: crypto.Hash): Promise<void> {
  * @return The calculated hash string.
  */
 export async function calculateHash(source: string, dependencies: string[], args: string[]): Promise<string> {
-    const hash: crypto.Hash = crypto.createHash("sha256");
-    hash.update(args.join(" "));
-    await streamFileToHash(source, hash);
-    for (const dep of dependencies) {
-        if (fs.existsSync(dep)) {
-            await streamFileToHash(dep, hash);
+    return await timings.span(`hash ${path.basename(source)}`, "hash", async () => {
+        const hash: crypto.Hash = crypto.createHash("sha256");
+        hash.update(args.join(" "));
+        await streamFileToHash(source, hash);
+        for (const dep of dependencies) {
+            if (fs.existsSync(dep)) {
+                await streamFileToHash(dep, hash);
+            }
         }
-    }
-    return hash.digest("hex");
+        return hash.digest("hex");
+    }, source);
 }
 
 /**
@@ -319,7 +329,11 @@ export async function calculateHash(source: string, dependencies: string[], args
  * @return True if bundling was successful.
  */
 async function bundleFiles(objects: string[], archive: string): Promise<boolean> {
-    const result = await subprocess.run("llvm-ar", ["rcs", archive, ...objects]);
+    const result = await subprocess.run("llvm-ar", ["rcs", archive, ...objects], {
+        name: `llvm-ar ${path.basename(archive)}`,
+        category: "archive",
+        detail: archive
+    });
 
     if (result.code != 0) {
         throw new Error(result.stderr);
@@ -328,6 +342,72 @@ async function bundleFiles(objects: string[], archive: string): Promise<boolean>
     return true;
 }
 
+/**
+ * Writes a source file that includes the given sources of a module, so they are compiled as one translation unit. The
+ * file is only rewritten if its content changes.
+ *
+ * @param sources   - The paths to the source files.
+ * @param unityFile - The path to the generated source file.
+ *
+ * @return The path to the generated source file.
+ */
+function generateUnitySource(sources: string[], unityFile: string): string {
+    const content: string = sources
+        .map(source => `#include "${path.resolve(source).split(path.sep).join("/")}"\n`)
+        .join("");
+
+    if (!fs.existsSync(unityFile) || fs.readFileSync(unityFile, "utf-8") != content) {
+        fs.writeFileSync(unityFile, content);
+    }
+
+    return unityFile;
+}
+
+/**
+ * Precompiles a header, so modules including it don't have to parse it again.
+ *
+ * The header is compiled with the arguments of the module that provides it. The name of the precompiled header contains
+ * the hash of the header, its dependencies and the arguments, so every target and flag set gets its own file and the
+ * hashes of the objects compiled with it change whenever it is rebuilt.
+ *
+ * @param module       - The CFGResult object representing the module that provides the header.
+ * @param header       - The path to the header file.
+ * @param objectFolder - The directory where the precompiled header should be stored.
+ * @param flags        - CFlags that should be used for compiling
+ *
+ * @return The path to the precompiled header.
+ */
+export async function precompileHeader(module: CFGResult, header: string, objectFolder: string, flags: string[]): Promise<string> {
+    const args: string[] = generateCompilerArguments([], module, flags);
+    const name: string = path.basename(header, path.extname(header));
+
+    const headerDeps: string[] = await getDependencies(args, header);
+    const currentHash: string = await calculateHash(header, headerDeps, args);
+    const pch: string = path.join(objectFolder, `${name}-${currentHash.substring(0, 12)}.pch`);
+    if (fs.existsSync(pch)) {
+        return pch;
+    }
+
+    // Headers precompiled for previous states of the header or other flags are no longer used
+    for (const file of fs.readdirSync(objectFolder)) {
+        if (file.startsWith(`${name}-`) && file.endsWith(".pch")) {
+            fs.rmSync(path.join(objectFolder, file));
+        }
+    }
+
+    const result = await subprocess.run("clang", ["-x", "c-header", ...args, header, "-o", pch], {
+        name: `clang ${path.basename(header)}`,
+        category: "compile",
+        detail: header
+    });
+
+    if (result.code != 0) {
+        throw new Error(result.stderr);
+    }
+
+    return pch;
+}
+
 /**
  * Compiles a module and its dependencies into a static library.
  *
@@ -337,6 +417,7 @@ async function bundleFiles(objects: string[], archive: string): Promise<boolean>
  * @param libraryFolder - The directory where the resulting library should be stored.
  * @param cacheFolder   - The directory where cache files should be stored.
  * @param flags         - CFlgas that should be used for compiling
+ * @param pch           - A precompiled header that is included before every source, or `null`.
  *
  * @return The path to the generated static library archive.
  */
@@ -346,19 +427,36 @@ export async function compileModule(
     objectFolder: string,
     libraryFolder: string,
     cacheFolder: string,
-    flags: string[]
+    flags: string[],
+    pch: string | null = null
 ): Promise<string> {
     const args: string[] = generateCompilerArguments(dependencies, module, flags);
+    if (pch) {
+        // The path contains the hash of the precompiled header, so objects are recompiled when it is rebuilt
+        args.push("-include-pch", pch);
+    }
 
     const nameTable: Map<string, number> = new Map<string, number>();
-    const objects: string[] = [];
 
     const moduleCacheFolder = path.join(cacheFolder, module.name);
     if (!fs.existsSync(moduleCacheFolder)) {
         fs.mkdirSync(moduleCacheFolder, {recursive: true});
     }
 
-    for (const source of module.sources) {
+    const unitySources: string[] = module.unityDir ? module.sources.filter(source => {
+        const relative: string = path.relative(module.unityDir!, source);
+        return !relative.startsWith("..") && !path.isAbsolute(relative);
+    }) : [];
+
+    // The headers reported for the unity source include every source in it, so its hash covers all of them
+    const sources: string[] = unitySources.length > 1
+        ? [
+            generateUnitySource(unitySources, path.join(objectFolder, "unity.c")),
+            ...module.sources.filter(source => !unitySources.includes(source)),
+        ]
+        : module.sources;
+
+    const names: string[] = sources.map(source => {
         let name: string = path.basename(source, ".c");
         let index: number | undefined = nameTable.get(name);
         if (index) {
@@ -369,8 +467,13 @@ export async function compileModule(
             nameTable.set(name, 1);
         }
 
-        const object: string = path.join(objectFolder, name + ".o");
-        const hashFile: string = path.join(moduleCacheFolder, name + ".hash");
+        return name;
+    });
+
+    // Sources are compiled concurrently, the subprocess pool limits how many clang processes run at once
+    const objects: string[] = await Promise.all(sources.map(async (source, i) => {
+        const object: string = path.join(objectFolder, names[i] + ".o");
+        const hashFile: string = path.join(moduleCacheFolder, names[i] + ".hash");
 
         const sourceDeps: string[] = await getDependencies(args, source);
         const currentHash: string = await calculateHash(source, sourceDeps, args);
@@ -389,8 +492,9 @@ export async function compileModule(
             }
             fs.writeFileSync(hashFile, currentHash);
         }
-        objects.push(object);
-    }
+
+        return object;
+    }));
 
     const archiveHash: string = crypto.hash("SHA256", objectFolder, "base64").replace("=", "").substring(0, 12);
     const archiveName: string = `lib_${archiveHash}.a`;
@@ -414,44 +518,41 @@ export async function compileModule(
  * @return A promise that resolves when the embedding is complete.
  */
 export async function embedFile(content: Buffer, object: string, prefix: string, target: TargetTriple, flags: string[]): Promise<void> {
-    return new Promise((resolve, reject) => {
-        const process = child_process.spawn("clang", flags.concat("-x", "c", "-c", "-target", getTargetTripleString(target), "-", "-o", object), {
-            stdio: [undefined, "pipe", "pipe"]
-        });
-        const stdin: Writable = process.stdin;
-
-        let stderr = "";
-        process.stderr?.on("data", (data) => {
-            stderr += data.toString();
-        });
+    const result = await subprocess.run("clang", flags.concat("-x", "c", "-c", "-target", getTargetTripleString(target), "-", "-o", object), {
+        name: `embed ${prefix}`,
+        category: "embed",
+        detail: object
+    }, {
+        input: stdin => writeEmbeddedContent(stdin, content, prefix)
+    });
 
-        stdin.write("size_t ");
-        stdin.write(prefix);
-        stdin.write("_LENGTH = ");
-        stdin.write(content.length.toString());
-        stdin.write(";\n\n");
-        stdin.write("unsigned char ");
-        stdin.write(prefix);
-        stdin.write("_DATA[] = {");
-
-        for (let i: number = 0; i < content.length; i++) {
-            stdin.write("0x");
-            stdin.write(content[i]!.toString(16).padStart(2, "0"));
-            stdin.write(",");
-        }
+    if (result.code != 0) {
+        throw new Error(`Clang exited with code ${result.code}\n${result.stderr}`);
+    }
+}
 
-        stdin.write("0x00");
-        stdin.write("};")
-        stdin.end();
+/**
+ * Writes the content as a C array into the standard input of Clang, see {@link embedFile}.
+ */
+function writeEmbeddedContent(stdin: Writable, content: Buffer, prefix: string): void {
+    stdin.write("size_t ");
+    stdin.write(prefix);
+    stdin.write("_LENGTH = ");
+    stdin.write(content.length.toString());
+    stdin.write(";\n\n");
+    stdin.write("unsigned char ");
+    stdin.write(prefix);
+    stdin.write("_DATA[] = {");
+
+    for (let i: number = 0; i < content.length; i++) {
+        stdin.write("0x");
+        stdin.write(content[i]!.toString(16).padStart(2, "0"));
+        stdin.write(",");
+    }
 
-        process.on("close", (code) => {
-            if (code != 0) {
-                reject(new Error(`Clang exited with code ${code}\n${stderr}`));
-            } else {
-                resolve();
-            }
-        });
-    });
+    stdin.write("0x00");
+    stdin.write("};")
+    stdin.end();
 }
 
 /**
@@ -464,7 +565,11 @@ export async function embedFile(content: Buffer, object: string, prefix: string,
  * @return True if linking was successful.
  */
 export async function linkFiles(modules: string[], executableFiles: string, flags: string[]): Promise<boolean> {
-    const result = await subprocess.run("clang", modules.concat(flags).concat("-o", executableFiles));
+    const result = await subprocess.run("clang", modules.concat(flags).concat("-o", executableFiles), {
+        name: `link ${path.basename(executableFiles)}`,
+        category: "link",
+        detail: executableFiles
+    });
 
     if (result.code != 0) {
         throw new Error(result.stderr);
@@ -1,4 +1,8 @@
 import * as child_process from "node:child_process";
+import * as os from "node:os";
+import type {Writable} from "node:stream";
+
+import * as timings from "./timings.js";
 
 export interface SubprocessResult {
     stdout: string;
@@ -7,21 +11,101 @@ export interface SubprocessResult {
 }
 
 /**
- * Runs a command as a subprocess and captures its output.
+ * The timing span a subprocess is recorded as, see {@link timings.span}.
+ */
+export interface SubprocessSpan {
+    name: string;
+    category: string;
+    detail?: string;
+}
+
+/**
+ * Spawn options for {@link run}, the standard input of the subprocess is ignored unless `input` writes it.
+ */
+export interface SubprocessOptions extends child_process.SpawnOptions {
+    input?: (stdin: Writable) => void;
+}
+
+// Subprocesses of all concurrently built modules and targets share one pool, so the machine is not oversubscribed
+const MAX_JOBS: number = os.availableParallelism();
+
+let runningJobs: number = 0;
+const waitingJobs: (() => void)[] = [];
+
+/**
+ * Waits until a job slot is free and takes it.
+ *
+ * @return A promise that resolves once the slot is taken.
+ */
+function acquireJob(): Promise<void> {
+    if (runningJobs < MAX_JOBS) {
+        runningJobs++;
+        return Promise.resolve();
+    }
+
+    return new Promise<void>(resolve => waitingJobs.push(resolve));
+}
+
+/**
+ * Hands a job slot to the next waiting job, or frees it.
+ */
+function releaseJob(): void {
+    const next: (() => void) | undefined = waitingJobs.shift();
+    if (next) {
+        next();
+    } else {
+        runningJobs--;
+    }
+}
+
+/**
+ * Runs a command as a subprocess and captures its output. At most one subprocess per CPU runs at a time, further calls
+ * wait for a free slot.
  *
  * @param command - The command to execute.
  * @param args    - An array of arguments to pass to the command.
+ * @param span    - The timing span to record the subprocess as, or `null`.
  * @param options - Optional spawn options.
  *
  * @return A promise that resolves to a SubprocessResult object containing stdout, stderr, and the exit code.
  */
-export async function run(command: string, args: string[], options: child_process.SpawnOptions = {}): Promise<SubprocessResult> {
+export async function run(
+    command: string,
+    args: string[],
+    span: SubprocessSpan | null = null,
+    options: SubprocessOptions = {}
+): Promise<SubprocessResult> {
+    await acquireJob();
+    try {
+        // The span only starts once the slot is taken, the time spent waiting for it is no work of the subprocess
+        if (span) {
+            return await timings.span(span.name, span.category, () => spawn(command, args, options), span.detail);
+        }
+
+        return await spawn(command, args, options);
+    } finally {
+        releaseJob();
+    }
+}
+
+/**
+ * Spawns the subprocess for {@link run}.
+ */
+function spawn(command: string, args: string[], options: SubprocessOptions): Promise<SubprocessResult> {
+    const {input, ...spawnOptions} = options;
+
     return new Promise((resolve, reject) => {
         const proc = child_process.spawn(command, args, {
-            ...options,
-            stdio: ["ignore", "pipe", "pipe"]
+            ...spawnOptions,
+            stdio: [input ? "pipe" : "ignore", "pipe", "pipe"]
         });
 
+        if (input && proc.stdin) {
+            // A subprocess that exits early closes its input, the exit code reports the failure instead
+            proc.stdin.on("error", () => {});
+            input(proc.stdin);
+        }
+
         let stdout = "";
         let stderr = "";
 
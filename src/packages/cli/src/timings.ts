@@ -0,0 +1,274 @@
+import * as path from "path";
+import * as fs from "fs";
+import {AsyncLocalStorage} from "node:async_hooks";
+import {performance} from "node:perf_hooks";
+
+export interface TimingSpan {
+    id: number;
+    parent: number | null;
+    name: string;
+    category: string;
+    /**
+     * Milliseconds since the recording started.
+     */
+    start: number;
+    end: number;
+    detail?: string;
+    critical: boolean;
+}
+
+export interface TimingReport {
+    schema: 1;
+    timestamp: string;
+    total: number;
+    criticalPath: number;
+    spans: TimingSpan[];
+}
+
+interface Recorder {
+    origin: number;
+    spans: TimingSpan[];
+    nextId: number;
+}
+
+const CATEGORY_COLORS: Record<string, string> = {
+    build: "#6b7280",
+    resolve: "#0ea5e9",
+    "build-file": "#8b5cf6",
+    bundle: "#f59e0b",
+    module: "#9ca3af",
+    deps: "#14b8a6",
+    hash: "#a3a3a3",
+    compile: "#3b82f6",
+    archive: "#84cc16",
+    embed: "#ec4899",
+    link: "#ef4444"
+};
+
+const parentSpan: AsyncLocalStorage<number> = new AsyncLocalStorage<number>();
+let recorder: Recorder | null = null;
+
+/**
+ * Starts recording spans, until then {@link span} only runs its function.
+ */
+export function startRecording(): void {
+    recorder = {
+        origin: performance.now(),
+        spans: [],
+        nextId: 0
+    };
+}
+
+/**
+ * Stops recording and marks the critical path.
+ *
+ * @return The report of all recorded spans, or `null` if nothing was recorded.
+ */
+export function stopRecording(): TimingReport | null {
+    if (!recorder) {
+        return null;
+    }
+
+    const spans: TimingSpan[] = recorder.spans.sort((a, b) => a.start - b.start);
+    recorder = null;
+
+    const criticalPath: number = markCriticalPath(spans);
+    const total: number = spans.reduce((max, span) => Math.max(max, span.end), 0);
+
+    return {
+        schema: 1,
+        timestamp: new Date().toISOString(),
+        total,
+        criticalPath,
+        spans
+    };
+}
+
+/**
+ * Runs a build step and records its duration if recording is active. Spans started within `fn` become its children.
+ *
+ * @param name     - The name of the step.
+ * @param category - The kind of step, used for grouping and coloring.
+ * @param fn       - The step itself.
+ * @param detail   - Optional details, e.g. the full command line.
+ *
+ * @return A promise that resolves to the result of `fn`.
+ */
+export async function span<T>(name: string, category: string, fn: () => T | Promise<T>, detail?: string): Promise<T> {
+    const active: Recorder | null = recorder;
+    if (!active) {
+        return await fn();
+    }
+
+    const entry: TimingSpan = {
+        id: active.nextId++,
+        parent: parentSpan.getStore() ?? null,
+        name,
+        category,
+        start: performance.now() - active.origin,
+        end: 0,
+        critical: false
+    };
+    if (detail !== undefined) {
+        entry.detail = detail;
+    }
+    active.spans.push(entry);
+
+    try {
+        return await parentSpan.run(entry.id, fn);
+    } finally {
+        entry.end = performance.now() - active.origin;
+    }
+}
+
+/**
+ * Marks the chain of steps that determined the build time.
+ *
+ * Only leaf spans do actual work. Starting with the one that finished last, the path is extended with the leaf that
+ * finished last before the current one started, as nothing after that point could have started it earlier.
+ *
+ * @param spans - All spans, sorted by start time.
+ *
+ * @return The summed duration of the critical path in milliseconds.
+ */
+function markCriticalPath(spans: TimingSpan[]): number {
+    const parents: Set<number> = new Set(spans.map(span => span.parent).filter((parent): parent is number => parent !== null));
+    const leaves: TimingSpan[] = spans.filter(span => !parents.has(span.id)).sort((a, b) => b.end - a.end);
+
+    let duration: number = 0;
+    let current: TimingSpan | undefined = leaves[0];
+
+    while (current) {
+        current.critical = true;
+        duration += current.end - current.start;
+
+        const start: number = current.start;
+        current = leaves.find(leaf => leaf.end <= start);
+    }
+
+    // Ancestors of critical steps are highlighted as well, so the path can be followed from the top
+    const byId: Map<number, TimingSpan> = new Map(spans.map((span): [number, TimingSpan] => [span.id, span]));
+    for (const span of spans) {
+        if (!span.critical || span.parent === null) {
+            continue;
+        }
+
+        let parent: TimingSpan | undefined = byId.get(span.parent);
+        while (parent && !parent.critical) {
+            parent.critical = true;
+            parent = parent.parent !== null ? byId.get(parent.parent) : undefined;
+        }
+    }
+
+    return duration;
+}
+
+/**
+ * Sums the time spent per category, counting only leaf spans so that nested steps are not counted twice.
+ *
+ * @param report - The timing report.
+ *
+ * @return The total duration per category in milliseconds, sorted descending.
+ */
+export function summarizeCategories(report: TimingReport): [string, number][] {
+    const parents: Set<number> = new Set(report.spans.map(span => span.parent).filter((parent): parent is number => parent !== null));
+    const totals: Map<string, number> = new Map();
+
+    for (const span of report.spans) {
+        if (parents.has(span.id)) {
+            continue;
+        }
+
+        totals.set(span.category, (totals.get(span.category) ?? 0) + span.end - span.start);
+    }
+
+    return Array.from(totals.entries()).sort((a, b) => b[1] - a[1]);
+}
+
+function escapeHTML(text: string): string {
+    return text
+        .replace(/&/g, "&amp;")
+        .replace(/</g, "&lt;")
+        .replace(/>/g, "&gt;")
+        .replace(/"/g, "&quot;");
+}
+
+/**
+ * Renders the report as a self-contained HTML page with a timeline of all spans.
+ *
+ * @param report - The timing report.
+ *
+ * @return The HTML document.
+ */
+function renderHTML(report: TimingReport): string {
+    const total: number = Math.max(report.total, 1);
+    const depths: Map<number, number> = new Map();
+
+    const rows: string = report.spans.map(span => {
+        const depth: number = span.parent !== null ? (depths.get(span.parent) ?? 0) + 1 : 0;
+        depths.set(span.id, depth);
+
+        const left: string = (span.start / total * 100).toFixed(3);
+        const width: string = Math.max((span.end - span.start) / total * 100, 0.1).toFixed(3);
+        const color: string = CATEGORY_COLORS[span.category] ?? "#6b7280";
+        const title: string = escapeHTML(`${span.name} (${span.category}) ${(span.end - span.start).toFixed(1)} ms${span.detail ? `\n${span.detail}` : ""}`);
+
+        return `<div class="row${span.critical ? " critical" : ""}" title="${title}">`
+            + `<div class="label" style="padding-left:${depth}em">${escapeHTML(span.name)}</div>`
+            + `<div class="track"><div class="bar" style="left:${left}%;width:${width}%;background:${color}"></div></div>`
+            + `<div class="time">${(span.end - span.start).toFixed(1)} ms</div>`
+            + `</div>`;
+    }).join("\n");
+
+    const categories: string = summarizeCategories(report)
+        .map(([category, duration]) => `<tr><td><span class="swatch" style="background:${CATEGORY_COLORS[category] ?? "#6b7280"}"></span>${escapeHTML(category)}</td><td>${duration.toFixed(1)} ms</td></tr>`)
+        .join("\n");
+
+    return `<!DOCTYPE html>
+<html lang="en">
+<head>
+<meta charset="utf-8">
+<title>YAJE build timings</title>
+<style>
+body { font: 13px system-ui, sans-serif; margin: 2em; color: #111827; }
+table { border-collapse: collapse; margin-bottom: 2em; }
+td { padding: 2px 1em 2px 0; }
+.swatch { display: inline-block; width: 10px; height: 10px; margin-right: 6px; }
+.row { display: flex; align-items: center; height: 18px; }
+.row:hover { background: #f3f4f6; }
+.label { width: 28em; overflow: hidden; white-space: nowrap; text-overflow: ellipsis; }
+.track { position: relative; flex: 1; height: 12px; }
+.bar { position: absolute; height: 100%; opacity: 0.45; }
+.time { width: 7em; text-align: right; color: #6b7280; }
+.critical .label { font-weight: bold; color: #b91c1c; }
+.critical .bar { opacity: 1; outline: 1px solid #b91c1c; }
+</style>
+</head>
+<body>
+<h2>Build timings</h2>
+<p>Total ${report.total.toFixed(1)} ms, critical path ${report.criticalPath.toFixed(1)} ms (highlighted). Recorded ${escapeHTML(report.timestamp)}.</p>
+<table>
+${categories}
+</table>
+${rows}
+</body>
+</html>
+`;
+}
+
+/**
+ * Writes the report as `timings.json` and `timings.html`.
+ *
+ * @param report - The timing report.
+ * @param folder - The folder to write to.
+ *
+ * @return The path of the HTML report.
+ */
+export function writeReport(report: TimingReport, folder: string): string {
+    const htmlFile: string = path.join(folder, "timings.html");
+
+    fs.writeFileSync(path.join(folder, "timings.json"), JSON.stringify(report, null, 4));
+    fs.writeFileSync(htmlFile, renderHTML(report));
+
+    return htmlFile;
+}
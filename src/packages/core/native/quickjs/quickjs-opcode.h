@@ -263,6 +263,10 @@ DEF(     strict_neq, 1, 2, 1, none)
 DEF(is_undefined_or_null, 1, 1, 1, none)
 DEF(     private_in, 1, 2, 1, none)
 DEF(push_bigint_i32, 5, 0, 1, i32)
+DEF(object_template, 5, 0, 1, const) /* object literal with the shape of a template */
+DEF(define_template_field, 5, 2, 1, u32) /* obj value -> obj, u32 is the property index */
+DEF(       get_argc, 1, 0, 1, none) /* arguments.length without arguments object */
+DEF(     get_arg_el, 1, 1, 1, none) /* index -> arguments[index] without arguments object */
 /* must be the last non short and non temporary opcode */
 DEF(            nop, 1, 0, 0, none)
 
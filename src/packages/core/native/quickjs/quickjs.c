@@ -320,6 +320,12 @@ struct JSRuntime {
     void *host_promise_rejection_tracker_opaque;
 
     struct list_head job_list; /* list of JSJobEntry.link */
+    /* recycled JSJobEntry with JS_JOB_CACHED_ARGC arguments and
+       JSPromiseReactionData, which are allocated for each await */
+    struct list_head job_free_list;
+    int job_free_count;
+    struct list_head promise_reaction_free_list;
+    int promise_reaction_free_count;
 
     JSModuleNormalizeFunc *module_normalize_func;
     bool module_loader_has_attr;
@@ -875,6 +881,9 @@ typedef struct JSAsyncFunctionState {
 typedef struct JSAsyncFunctionData {
     JSGCObjectHeader header; /* must come first */
     JSValue resolving_funcs[2];
+    /* functions resuming the function after await, created by the
+       first await and reused by the next ones */
+    JSValue await_funcs[2];
     bool is_active; /* true if the async function state is valid */
     JSAsyncFunctionState func_state;
 } JSAsyncFunctionData;
@@ -980,6 +989,12 @@ typedef struct JSJobEntry {
     JSValue argv[];
 } JSJobEntry;
 
+/* jobs with at most this number of arguments are recycled (5 is the
+   argument count of promise_reaction_job) */
+#define JS_JOB_CACHED_ARGC 5
+/* maximum number of recycled jobs or promise reactions */
+#define JS_FREE_LIST_MAX_SIZE 64
+
 typedef struct JSProperty {
     union {
         JSValue value;      /* JS_PROP_NORMAL */
@@ -1000,6 +1015,10 @@ typedef struct JSProperty {
 
 #define JS_PROP_INITIAL_SIZE 2
 #define JS_PROP_INITIAL_HASH_SIZE 4 /* must be a power of two */
+/* objects reaching this number of properties are likely used as
+   dictionaries: they get their own shape which is no longer shared nor
+   inserted in the shape hash table */
+#define JS_PROP_DICT_THRESHOLD 64
 #define JS_ARRAY_INITIAL_SIZE 2
 
 typedef struct JSShapeProperty {
@@ -1025,6 +1044,17 @@ struct JSShape {
     JSShapeProperty prop[]; /* prop_size elements */
 };
 
+/* Element kinds of fast arrays. The elements of a JS_CLASS_ARRAY
+   fast array are stored unboxed as long as they are all int32 or all
+   numbers. The kind only widens: an int32 array becomes a float64
+   array when a non int32 number is stored and a JSValue array when
+   any other value is stored. */
+typedef enum {
+    JS_ARRAY_KIND_INT32,    /* u.array.u.int32_ptr */
+    JS_ARRAY_KIND_FLOAT64,  /* u.array.u.double_ptr */
+    JS_ARRAY_KIND_VALUE,    /* u.array.u.values */
+} JSArrayKindEnum;
+
 struct JSObject {
     union {
         JSGCObjectHeader header;
@@ -1092,23 +1122,24 @@ struct JSObject {
                 struct JSTypedArray *typed_array; /* JS_CLASS_UINT8C_ARRAY..JS_CLASS_FLOAT64_ARRAY */
             } u1;
             union {
-                JSValue *values;        /* JS_CLASS_ARRAY, JS_CLASS_ARGUMENTS */
+                JSValue *values;        /* JS_CLASS_ARRAY (JS_ARRAY_KIND_VALUE), JS_CLASS_ARGUMENTS */
                 JSVarRef **var_refs;    /* JS_CLASS_MAPPED_ARGUMENTS */
                 void *ptr;              /* JS_CLASS_UINT8C_ARRAY..JS_CLASS_FLOAT64_ARRAY */
                 int8_t *int8_ptr;       /* JS_CLASS_INT8_ARRAY */
                 uint8_t *uint8_ptr;     /* JS_CLASS_UINT8_ARRAY, JS_CLASS_UINT8C_ARRAY */
                 int16_t *int16_ptr;     /* JS_CLASS_INT16_ARRAY */
                 uint16_t *uint16_ptr;   /* JS_CLASS_UINT16_ARRAY */
-                int32_t *int32_ptr;     /* JS_CLASS_INT32_ARRAY */
+                int32_t *int32_ptr;     /* JS_CLASS_INT32_ARRAY, JS_CLASS_ARRAY (JS_ARRAY_KIND_INT32) */
                 uint32_t *uint32_ptr;   /* JS_CLASS_UINT32_ARRAY */
                 int64_t *int64_ptr;     /* JS_CLASS_INT64_ARRAY */
                 uint64_t *uint64_ptr;   /* JS_CLASS_UINT64_ARRAY */
                 uint16_t *fp16_ptr;     /* JS_CLASS_FLOAT16_ARRAY */
                 float *float_ptr;       /* JS_CLASS_FLOAT32_ARRAY */
-                double *double_ptr;     /* JS_CLASS_FLOAT64_ARRAY */
+                double *double_ptr;     /* JS_CLASS_FLOAT64_ARRAY, JS_CLASS_ARRAY (JS_ARRAY_KIND_FLOAT64) */
             } u;
             uint32_t count; /* <= 2^31-1. 0 for a detached typed array */
-        } array;    /* 12/20 bytes */
+            uint8_t kind; /* JS_CLASS_ARRAY, JS_CLASS_ARGUMENTS: JSArrayKindEnum */
+        } array;    /* 16/24 bytes */
         JSRegExp regexp;    /* JS_CLASS_REGEXP: 8/16 bytes */
         JSValue object_data;    /* for JS_SetObjectData(): 8/16/16 bytes */
     } u;
@@ -1388,6 +1419,9 @@ static JSValue js_promise_then(JSContext *ctx, JSValueConst this_val,
                                int argc, JSValueConst *argv);
 static JSValue js_promise_resolve_thenable_job(JSContext *ctx,
                                                int argc, JSValueConst *argv);
+static JSValue promise_reaction_job(JSContext *ctx, int argc,
+                                    JSValueConst *argv);
+static void js_promise_free_reaction_list(JSRuntime *rt);
 static bool js_string_eq(JSString *p1, JSString *p2);
 static int js_string_compare(JSString *p1, JSString *p2);
 static int JS_SetPropertyValue(JSContext *ctx, JSValueConst this_obj,
@@ -1418,8 +1452,10 @@ static void free_arg_list(JSContext *ctx, JSValue *tab, uint32_t len);
 static JSValue *build_arg_list(JSContext *ctx, uint32_t *plen,
                                JSValueConst array_arg);
 static JSValue js_create_array(JSContext *ctx, int len, JSValueConst *tab);
-static bool js_get_fast_array(JSContext *ctx, JSValue obj,
-                              JSValue **arrpp, uint32_t *countp);
+static bool js_array_iterator_next_fast(JSValueConst enum_obj,
+                                        JSValueConst method, JSValue *pval);
+static bool js_get_fast_array(JSContext *ctx, JSValueConst obj,
+                              JSObject **pp, uint32_t *countp);
 static int expand_fast_array(JSContext *ctx, JSObject *p, uint32_t new_len);
 static JSValue JS_CreateAsyncFromSyncIterator(JSContext *ctx,
                                               JSValue sync_iter);
@@ -1949,6 +1985,8 @@ JSRuntime *JS_NewRuntime2(const JSMallocFunctions *mf, void *opaque)
     init_list_head(&rt->string_list);
 #endif
     init_list_head(&rt->job_list);
+    init_list_head(&rt->job_free_list);
+    init_list_head(&rt->promise_reaction_free_list);
 
     if (JS_InitAtoms(rt))
         goto fail;
@@ -2105,9 +2143,16 @@ int JS_EnqueueJob(JSContext *ctx, JSJobFunc *job_func,
 
     assert(!rt->in_free);
 
-    e = js_malloc(ctx, sizeof(*e) + argc * sizeof(JSValue));
-    if (!e)
-        return -1;
+    if (argc <= JS_JOB_CACHED_ARGC && !list_empty(&rt->job_free_list)) {
+        e = list_entry(rt->job_free_list.next, JSJobEntry, link);
+        list_del(&e->link);
+        rt->job_free_count--;
+    } else {
+        e = js_malloc(ctx, sizeof(*e) + max_int(argc, JS_JOB_CACHED_ARGC) *
+                      sizeof(JSValue));
+        if (!e)
+            return -1;
+    }
     e->ctx = ctx;
     e->job_func = job_func;
     e->argc = argc;
@@ -2149,7 +2194,13 @@ int JS_ExecutePendingJob(JSRuntime *rt, JSContext **pctx)
     else
         ret = 1;
     JS_FreeValue(ctx, res);
-    js_free(ctx, e);
+    if (e->argc <= JS_JOB_CACHED_ARGC &&
+        rt->job_free_count < JS_FREE_LIST_MAX_SIZE) {
+        list_add(&e->link, &rt->job_free_list);
+        rt->job_free_count++;
+    } else {
+        js_free(ctx, e);
+    }
     *pctx = ctx;
     return ret;
 }
@@ -2298,6 +2349,11 @@ void JS_FreeRuntime(JSRuntime *rt)
 
     assert(list_empty(&rt->gc_obj_list));
 
+    list_for_each_safe(el, el1, &rt->job_free_list) {
+        js_free_rt(rt, list_entry(el, JSJobEntry, link));
+    }
+    js_promise_free_reaction_list(rt);
+
     /* free the classes */
     for(i = 0; i < rt->class_count; i++) {
         JSClass *cl = &rt->class_array[i];
@@ -2516,6 +2572,133 @@ static inline void set_value(JSContext *ctx, JSValue *pval, JSValue new_val)
     JS_FreeValue(ctx, old_val);
 }
 
+/* return the narrowest element kind of a fast array that can store
+   'val'. Integral float64 values are stored in int32 arrays. */
+static inline JSArrayKindEnum js_array_value_kind(JSValueConst val)
+{
+    switch(JS_VALUE_GET_NORM_TAG(val)) {
+    case JS_TAG_INT:
+        return JS_ARRAY_KIND_INT32;
+    case JS_TAG_FLOAT64:
+        if (double_is_int32(JS_VALUE_GET_FLOAT64(val)))
+            return JS_ARRAY_KIND_INT32;
+        return JS_ARRAY_KIND_FLOAT64;
+    default:
+        return JS_ARRAY_KIND_VALUE;
+    }
+}
+
+static inline size_t js_array_kind_size(JSArrayKindEnum kind)
+{
+    switch(kind) {
+    case JS_ARRAY_KIND_INT32:
+        return sizeof(int32_t);
+    case JS_ARRAY_KIND_FLOAT64:
+        return sizeof(double);
+    default:
+        return sizeof(JSValue);
+    }
+}
+
+/* return element 'idx' < count of a fast JS_CLASS_ARRAY or
+   JS_CLASS_ARGUMENTS object */
+static inline JSValue js_array_get(JSObject *p, uint32_t idx)
+{
+    switch(p->u.array.kind) {
+    case JS_ARRAY_KIND_INT32:
+        return js_int32(p->u.array.u.int32_ptr[idx]);
+    case JS_ARRAY_KIND_FLOAT64:
+        return js_float64(p->u.array.u.double_ptr[idx]);
+    default:
+        return js_dup(p->u.array.u.values[idx]);
+    }
+}
+
+/* change the element kind of a fast array to the more general
+   'kind'. Return -1 if memory error. */
+static no_inline int js_array_widen(JSContext *ctx, JSObject *p,
+                                    JSArrayKindEnum kind)
+{
+    uint32_t i;
+    void *ptr;
+
+    if (p->u.array.u1.size != 0) {
+        ptr = js_realloc(ctx, p->u.array.u.ptr,
+                         js_array_kind_size(kind) * p->u.array.u1.size);
+        if (!ptr)
+            return -1;
+        p->u.array.u.ptr = ptr;
+    }
+    /* the elements are converted in place starting from the last one
+       because the new elements are larger than the old ones */
+    i = p->u.array.count;
+    if (p->u.array.kind == JS_ARRAY_KIND_INT32) {
+        int32_t *tab = p->u.array.u.int32_ptr;
+        if (kind == JS_ARRAY_KIND_FLOAT64) {
+            while (i-- > 0)
+                p->u.array.u.double_ptr[i] = tab[i];
+        } else {
+            while (i-- > 0)
+                p->u.array.u.values[i] = js_int32(tab[i]);
+        }
+    } else {
+        double *tab = p->u.array.u.double_ptr;
+        while (i-- > 0)
+            p->u.array.u.values[i] = js_number(tab[i]);
+    }
+    p->u.array.kind = kind;
+    return 0;
+}
+
+/* store 'val' in element 'idx' of a fast JS_CLASS_ARRAY object and
+   widen its element kind if necessary. The element is replaced if
+   'idx' < count, otherwise it must be allocated but is not
+   initialized. Return -1 if memory error ('val' is freed). */
+static inline int js_array_set(JSContext *ctx, JSObject *p, uint32_t idx,
+                               JSValue val)
+{
+    JSArrayKindEnum kind = js_array_value_kind(val);
+
+    if (unlikely(kind > p->u.array.kind)) {
+        if (js_array_widen(ctx, p, kind)) {
+            JS_FreeValue(ctx, val);
+            return -1;
+        }
+    }
+    switch(p->u.array.kind) {
+    case JS_ARRAY_KIND_INT32:
+        if (JS_VALUE_GET_TAG(val) == JS_TAG_INT)
+            p->u.array.u.int32_ptr[idx] = JS_VALUE_GET_INT(val);
+        else
+            p->u.array.u.int32_ptr[idx] = (int32_t)JS_VALUE_GET_FLOAT64(val);
+        break;
+    case JS_ARRAY_KIND_FLOAT64:
+        if (JS_VALUE_GET_TAG(val) == JS_TAG_INT)
+            p->u.array.u.double_ptr[idx] = JS_VALUE_GET_INT(val);
+        else
+            p->u.array.u.double_ptr[idx] = JS_VALUE_GET_FLOAT64(val);
+        break;
+    default:
+        if (idx < p->u.array.count)
+            set_value(ctx, &p->u.array.u.values[idx], val);
+        else
+            p->u.array.u.values[idx] = val;
+        break;
+    }
+    return 0;
+}
+
+/* append 'val' to a fast JS_CLASS_ARRAY object whose elements are
+   already allocated. The 'length' property is not updated. Return -1
+   if memory error ('val' is freed). */
+static inline int js_array_append(JSContext *ctx, JSObject *p, JSValue val)
+{
+    if (js_array_set(ctx, p, p->u.array.count, val))
+        return -1;
+    p->u.array.count++;
+    return 0;
+}
+
 void JS_SetClassProto(JSContext *ctx, JSClassID class_id, JSValue obj)
 {
     assert(class_id < ctx->rt->class_count);
@@ -3203,13 +3386,14 @@ static JSAtom __JS_NewAtomInit(JSRuntime *rt, const char *str, int len,
 }
 
 // XXX: `str` must be raw 8-bit contents. No UTF-8 encoded strings
-static JSAtom __JS_FindAtom(JSRuntime *rt, const char *str, size_t len,
-                            int atom_type)
+/* 'h' is the hash_string8() hash of 'str' with JS_ATOM_TYPE_STRING as
+   initial value */
+static JSAtom __JS_FindAtomHash(JSRuntime *rt, const char *str, size_t len,
+                                uint32_t h)
 {
-    uint32_t h, h1, i;
+    uint32_t h1, i;
     JSAtomStruct *p;
 
-    h = hash_string8((const uint8_t *)str, len, JS_ATOM_TYPE_STRING);
     h &= JS_ATOM_HASH_MASK;
     h1 = h & (rt->atom_hash_size - 1);
     i = rt->atom_hash[h1];
@@ -3229,6 +3413,15 @@ static JSAtom __JS_FindAtom(JSRuntime *rt, const char *str, size_t len,
     return JS_ATOM_NULL;
 }
 
+static JSAtom __JS_FindAtom(JSRuntime *rt, const char *str, size_t len,
+                            int atom_type)
+{
+    uint32_t h;
+
+    h = hash_string8((const uint8_t *)str, len, JS_ATOM_TYPE_STRING);
+    return __JS_FindAtomHash(rt, str, len, h);
+}
+
 static void JS_FreeAtomStruct(JSRuntime *rt, JSAtomStruct *p)
 {
     uint32_t i = p->hash_next;  /* atom_index */
@@ -5423,8 +5616,10 @@ static int compact_properties(JSContext *ctx, JSObject *p)
     sh = p->shape;
     assert(!sh->is_hashed);
 
-    new_size = max_int(JS_PROP_INITIAL_SIZE,
-                       sh->prop_count - sh->deleted_prop_count);
+    /* keep some room so that an object used as a dictionary does not
+       need to be resized again by the next additions */
+    new_size = sh->prop_count - sh->deleted_prop_count;
+    new_size = max_int(JS_PROP_INITIAL_SIZE, new_size + new_size / 2);
     assert(new_size <= sh->prop_size);
 
     new_hash_size = sh->prop_hash_mask + 1;
@@ -5669,6 +5864,7 @@ static JSValue JS_NewObjectFromShape(JSContext *ctx, JSShape *sh, JSClassID clas
             p->u.array.u.values = NULL;
             p->u.array.count = 0;
             p->u.array.u1.size = 0;
+            p->u.array.kind = JS_ARRAY_KIND_INT32;
             if (!props) {
                 /* XXX: remove */
                 /* the length property is always the first one */
@@ -5705,6 +5901,7 @@ static JSValue JS_NewObjectFromShape(JSContext *ctx, JSShape *sh, JSClassID clas
         p->fast_array = 1;
         p->u.array.u.ptr = NULL;
         p->u.array.count = 0;
+        p->u.array.kind = JS_ARRAY_KIND_VALUE;
         break;
     case JS_CLASS_DATAVIEW:
         p->u.array.u.ptr = NULL;
@@ -5890,6 +6087,7 @@ JSValue JS_NewArrayFrom(JSContext *ctx, int count, const JSValue *values)
     JSValue obj;
     int i;
 
+    i = 0;
     obj = JS_NewArray(ctx);
     if (JS_IsException(obj))
         goto exception;
@@ -5899,13 +6097,18 @@ JSValue JS_NewArrayFrom(JSContext *ctx, int count, const JSValue *values)
             JS_FreeValue(ctx, obj);
             goto exception;
         }
-        p->u.array.count = count;
+        for (; i < count; i++) {
+            if (js_array_append(ctx, p, values[i])) {
+                JS_FreeValue(ctx, obj);
+                i++;
+                goto exception;
+            }
+        }
         p->prop[0].u.value = js_int32(count);
-        memcpy(p->u.array.u.values, values, count * sizeof(*values));
     }
     return obj;
 exception:
-    for (i = 0; i < count; i++)
+    for (; i < count; i++)
         JS_FreeValue(ctx, values[i]);
     return JS_EXCEPTION;
 }
@@ -5916,6 +6119,45 @@ JSValue JS_NewObject(JSContext *ctx)
     return JS_NewObjectProtoClass(ctx, ctx->class_proto[JS_CLASS_OBJECT], JS_CLASS_OBJECT);
 }
 
+/* Create an object literal with the properties of the template 'tpl'
+   set to undefined. The object gets the final shape and a property
+   array of the right size at once, the values are then stored by
+   OP_define_template_field. */
+static JSValue js_new_object_from_template(JSContext *ctx, JSValueConst tpl)
+{
+    JSObject *p, *p1;
+    JSShape *sh;
+    JSShapeProperty *prs;
+    JSValue obj;
+    int i;
+
+    p = JS_VALUE_GET_OBJ(tpl);
+    sh = p->shape;
+    if (likely(sh->proto == get_proto_obj(ctx->class_proto[JS_CLASS_OBJECT]))) {
+        obj = JS_NewObjectFromShape(ctx, js_dup_shape(sh), JS_CLASS_OBJECT, NULL);
+        if (JS_IsException(obj))
+            return obj;
+        p1 = JS_VALUE_GET_OBJ(obj);
+        for(i = 0; i < sh->prop_count; i++)
+            p1->prop[i].u.value = JS_UNDEFINED;
+        return obj;
+    }
+    /* the function was compiled in another realm: define the
+       properties in the same order to get the same indexes */
+    obj = JS_NewObject(ctx);
+    if (JS_IsException(obj))
+        return obj;
+    prs = get_shape_prop(sh);
+    for(i = 0; i < sh->prop_count; i++, prs++) {
+        if (JS_DefinePropertyValue(ctx, obj, prs->atom, JS_UNDEFINED,
+                                   JS_PROP_C_W_E) < 0) {
+            JS_FreeValue(ctx, obj);
+            return JS_EXCEPTION;
+        }
+    }
+    return obj;
+}
+
 static void js_function_set_properties(JSContext *ctx, JSValue func_obj,
                                        JSAtom name, int len)
 {
@@ -6372,10 +6614,12 @@ static void js_array_finalizer(JSRuntime *rt, JSValueConst val)
     JSObject *p = JS_VALUE_GET_OBJ(val);
     int i;
 
-    for(i = 0; i < p->u.array.count; i++) {
-        JS_FreeValueRT(rt, p->u.array.u.values[i]);
+    if (p->u.array.kind == JS_ARRAY_KIND_VALUE) {
+        for(i = 0; i < p->u.array.count; i++) {
+            JS_FreeValueRT(rt, p->u.array.u.values[i]);
+        }
     }
-    js_free_rt(rt, p->u.array.u.values);
+    js_free_rt(rt, p->u.array.u.ptr);
 }
 
 static void js_array_mark(JSRuntime *rt, JSValueConst val,
@@ -6384,8 +6628,10 @@ static void js_array_mark(JSRuntime *rt, JSValueConst val,
     JSObject *p = JS_VALUE_GET_OBJ(val);
     int i;
 
-    for(i = 0; i < p->u.array.count; i++) {
-        JS_MarkValue(rt, p->u.array.u.values[i], mark_func);
+    if (p->u.array.kind == JS_ARRAY_KIND_VALUE) {
+        for(i = 0; i < p->u.array.count; i++) {
+            JS_MarkValue(rt, p->u.array.u.values[i], mark_func);
+        }
     }
 }
 
@@ -6796,6 +7042,8 @@ static void mark_children(JSRuntime *rt, JSGCObjectHeader *gp,
                 async_func_mark(rt, &s->func_state, mark_func);
             JS_MarkValue(rt, s->resolving_funcs[0], mark_func);
             JS_MarkValue(rt, s->resolving_funcs[1], mark_func);
+            JS_MarkValue(rt, s->await_funcs[0], mark_func);
+            JS_MarkValue(rt, s->await_funcs[1], mark_func);
         }
         break;
     case JS_GC_OBJ_TYPE_SHAPE:
@@ -7137,13 +7385,15 @@ void JS_ComputeMemoryUsage(JSRuntime *rt, JSMemoryUsage *s)
             s->array_count++;
             if (p->fast_array) {
                 s->fast_array_count++;
-                if (p->u.array.u.values) {
+                if (p->u.array.u.ptr) {
                     s->memory_used_count++;
                     s->memory_used_size += p->u.array.count *
-                        sizeof(*p->u.array.u.values);
+                        js_array_kind_size(p->u.array.kind);
                     s->fast_array_elements += p->u.array.count;
-                    for (i = 0; i < p->u.array.count; i++) {
-                        compute_value_size(p->u.array.u.values[i], hp);
+                    if (p->u.array.kind == JS_ARRAY_KIND_VALUE) {
+                        for (i = 0; i < p->u.array.count; i++) {
+                            compute_value_size(p->u.array.u.values[i], hp);
+                        }
                     }
                 }
             }
@@ -9351,7 +9601,7 @@ static bool js_get_fast_array_element(JSContext *ctx, JSObject *p,
     case JS_CLASS_ARRAY:
     case JS_CLASS_ARGUMENTS:
         if (unlikely(idx >= p->u.array.count)) return false;
-        *pval = js_dup(p->u.array.u.values[idx]);
+        *pval = js_array_get(p, idx);
         return true;
     case JS_CLASS_MAPPED_ARGUMENTS:
         if (unlikely(idx >= p->u.array.count)) return false;
@@ -9543,7 +9793,11 @@ static JSProperty *add_property(JSContext *ctx,
         }
     }
     sh = p->shape;
-    if (sh->is_hashed) {
+    if (unlikely(sh->is_hashed && sh->prop_count >= JS_PROP_DICT_THRESHOLD)) {
+        /* switch to dictionary mode */
+        if (js_shape_prepare_update(ctx, p, NULL))
+            return NULL;
+    } else if (sh->is_hashed) {
         /* try to find an existing shape */
         new_sh = find_hashed_shape_prop(ctx->rt, sh, prop, prop_flags);
         if (new_sh) {
@@ -9612,17 +9866,20 @@ static no_inline __exception int convert_fast_array_to_array(JSContext *ctx,
             pr->u.var_ref = *tab++;
         }
     } else {
-        JSValue *tab = p->u.array.u.values;
         for(i = 0; i < len; i++) {
             /* add_property cannot fail here but
                __JS_AtomFromUInt32(i) fails for i > INT32_MAX */
             pr = add_property(ctx, p, __JS_AtomFromUInt32(i), JS_PROP_C_W_E);
-            pr->u.value = *tab++;
+            /* the reference of a JSValue element is moved */
+            if (p->u.array.kind == JS_ARRAY_KIND_VALUE)
+                pr->u.value = p->u.array.u.values[i];
+            else
+                pr->u.value = js_array_get(p, i);
         }
     }
-    js_free(ctx, p->u.array.u.values);
+    js_free(ctx, p->u.array.u.ptr);
     p->u.array.count = 0;
-    p->u.array.u.values = NULL; /* fail safe */
+    p->u.array.u.ptr = NULL; /* fail safe */
     p->u.array.u1.size = 0;
     p->fast_array = 0;
     return 0;
@@ -9695,7 +9952,7 @@ static int delete_property(JSContext *ctx, JSObject *p, JSAtom atom)
                     if (idx == p->u.array.count - 1) {
                         if (p->class_id == JS_CLASS_MAPPED_ARGUMENTS) {
                             free_var_ref(ctx->rt, p->u.array.u.var_refs[idx]);
-                        } else {
+                        } else if (p->u.array.kind == JS_ARRAY_KIND_VALUE) {
                             JS_FreeValue(ctx, p->u.array.u.values[idx]);
                         }
                         p->u.array.count = idx;
@@ -9762,8 +10019,10 @@ static int set_array_length(JSContext *ctx, JSObject *p, JSValue val,
     if (likely(p->fast_array)) {
         uint32_t old_len = p->u.array.count;
         if (len < old_len) {
-            for(i = len; i < old_len; i++) {
-                JS_FreeValue(ctx, p->u.array.u.values[i]);
+            if (p->u.array.kind == JS_ARRAY_KIND_VALUE) {
+                for(i = len; i < old_len; i++) {
+                    JS_FreeValue(ctx, p->u.array.u.values[i]);
+                }
             }
             p->u.array.count = len;
         }
@@ -9839,15 +10098,16 @@ static int set_array_length(JSContext *ctx, JSObject *p, JSValue val,
 static int expand_fast_array(JSContext *ctx, JSObject *p, uint32_t new_len)
 {
     uint32_t new_size;
-    size_t slack;
-    JSValue *new_array_prop;
+    size_t slack, elt_size;
+    void *new_array_prop;
     /* XXX: potential arithmetic overflow */
     new_size = max_int(new_len, p->u.array.u1.size * 3 / 2);
-    new_array_prop = js_realloc2(ctx, p->u.array.u.values, sizeof(JSValue) * new_size, &slack);
+    elt_size = js_array_kind_size(p->u.array.kind);
+    new_array_prop = js_realloc2(ctx, p->u.array.u.ptr, elt_size * new_size, &slack);
     if (!new_array_prop)
         return -1;
-    new_size += slack / sizeof(*new_array_prop);
-    p->u.array.u.values = new_array_prop;
+    new_size += slack / elt_size;
+    p->u.array.u.ptr = new_array_prop;
     p->u.array.u1.size = new_size;
     return 0;
 }
@@ -9879,8 +10139,8 @@ static int add_fast_array_element(JSContext *ctx, JSObject *p,
             return -1;
         }
     }
-    p->u.array.u.values[new_len - 1] = val;
-    p->u.array.count = new_len;
+    if (js_array_append(ctx, p, val))
+        return -1;
     return true;
 }
 
@@ -10183,7 +10443,8 @@ static int JS_SetPropertyValue(JSContext *ctx, JSValueConst this_obj,
                 /* add element */
                 return add_fast_array_element(ctx, p, val, flags);
             }
-            set_value(ctx, &p->u.array.u.values[idx], val);
+            if (js_array_set(ctx, p, idx, val))
+                return -1;
             break;
         case JS_CLASS_ARGUMENTS:
             if (unlikely(idx >= (uint32_t)p->u.array.count))
@@ -10767,7 +11028,8 @@ int JS_DefineProperty(JSContext *ctx, JSValueConst this_obj,
                             goto redo_prop_update;
                     }
                     if (flags & JS_PROP_HAS_VALUE) {
-                        set_value(ctx, &p->u.array.u.values[idx], js_dup(val));
+                        if (js_array_set(ctx, p, idx, js_dup(val)))
+                            return -1;
                     }
                     return true;
                 }
@@ -11958,6 +12220,652 @@ static js_limb_t js_mp_shr(js_limb_t *tab_r, const js_limb_t *tab, int n,
     return l & (((js_limb_t)1 << shift) - 1);
 }
 
+/* Thresholds (in limbs) above which the subquadratic algorithms are
+   used. Below them the basecase versions are faster. */
+#define JS_MP_KARATSUBA_THRESHOLD 32
+#define JS_MP_TOOM3_THRESHOLD     96
+#define JS_MP_NTT_THRESHOLD       2048
+#define JS_MP_DIV_DC_THRESHOLD    128
+#define JS_MP_TO_A_DC_THRESHOLD   24
+#define JS_MP_FROM_DEC_DC_THRESHOLD 192
+
+/* res[0..n-1] += op[0..m-1] with m <= n. Return the carry. */
+static js_limb_t js_mp_add_to(js_limb_t *res, int n, const js_limb_t *op, int m)
+{
+    js_limb_t carry;
+    int i;
+
+    carry = js_mp_add(res, res, op, m, 0);
+    for(i = m; i < n && carry != 0; i++) {
+        res[i]++;
+        carry = (res[i] == 0);
+    }
+    return carry;
+}
+
+/* res[0..n-1] -= op[0..m-1] with m <= n. Return the borrow. */
+static js_limb_t js_mp_sub_from(js_limb_t *res, int n, const js_limb_t *op, int m)
+{
+    js_limb_t borrow;
+    int i;
+
+    borrow = js_mp_sub(res, res, op, m, 0);
+    for(i = m; i < n && borrow != 0; i++) {
+        borrow = (res[i] == 0);
+        res[i]--;
+    }
+    return borrow;
+}
+
+static int js_mp_cmp(const js_limb_t *op1, const js_limb_t *op2, int n)
+{
+    int i;
+    for(i = n - 1; i >= 0; i--) {
+        if (op1[i] != op2[i])
+            return op1[i] < op2[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+/* exact division by 3 of the two's complement number tab[0..n-1] */
+static void js_mp_divexact3(js_limb_t *tab, int n)
+{
+    js_limb_t a, q, b, b1;
+    int i;
+
+    b = 0;
+    for(i = 0; i < n; i++) {
+        a = tab[i] - b;
+        b1 = (a > tab[i]);
+        q = a * (js_limb_t)0xaaaaaaab; /* 3^-1 mod 2^32 */
+        tab[i] = q;
+        b = ((js_dlimb_t)q * 3 >> JS_LIMB_BITS) + b1;
+    }
+}
+
+/* arithmetic shift right by one of the two's complement number
+   tab[0..n-1] */
+static void js_mp_sar1(js_limb_t *tab, int n)
+{
+    js_mp_shr(tab, tab, n, 1, -(tab[n - 1] >> (JS_LIMB_BITS - 1)));
+}
+
+static int js_mp_mul(JSContext *ctx, js_limb_t *res,
+                     const js_limb_t *op1, int n1,
+                     const js_limb_t *op2, int n2);
+
+/* n1 >= 2 * n2: multiply op1 by slices of n2 limbs */
+static int js_mp_mul_unbalanced(JSContext *ctx, js_limb_t *res,
+                                const js_limb_t *op1, int n1,
+                                const js_limb_t *op2, int n2)
+{
+    js_limb_t *tmp;
+    int i, l;
+
+    tmp = js_malloc(ctx, 2 * n2 * sizeof(tmp[0]));
+    if (!tmp)
+        return -1;
+    memset(res, 0, (n1 + n2) * sizeof(res[0]));
+    for(i = 0; i < n1; i += n2) {
+        l = min_int(n2, n1 - i);
+        if (js_mp_mul(ctx, tmp, op1 + i, l, op2, n2)) {
+            js_free(ctx, tmp);
+            return -1;
+        }
+        js_mp_add_to(res + i, n1 + n2 - i, tmp, l + n2);
+    }
+    js_free(ctx, tmp);
+    return 0;
+}
+
+/* Karatsuba multiplication, (n1 + 1) / 2 < n2 <= n1. With op1 = a1 *
+   B^h + a0 and op2 = b1 * B^h + b0, the middle coefficient is
+   (a0 + a1) * (b0 + b1) - a0 * b0 - a1 * b1. */
+static int js_mp_mul_karatsuba(JSContext *ctx, js_limb_t *res,
+                               const js_limb_t *op1, int n1,
+                               const js_limb_t *op2, int n2)
+{
+    js_limb_t *buf, *s1, *s2, *z1;
+    int h, n;
+
+    h = (n1 + 1) / 2;
+    n = n1 + n2;
+    buf = js_malloc(ctx, (4 * h + 4) * sizeof(buf[0]));
+    if (!buf)
+        return -1;
+    s1 = buf;
+    s2 = s1 + h + 1;
+    z1 = s2 + h + 1;
+
+    memcpy(s1, op1, h * sizeof(s1[0]));
+    s1[h] = js_mp_add_to(s1, h, op1 + h, n1 - h);
+    memcpy(s2, op2, h * sizeof(s2[0]));
+    s2[h] = js_mp_add_to(s2, h, op2 + h, n2 - h);
+
+    if (js_mp_mul(ctx, res, op1, h, op2, h) ||
+        js_mp_mul(ctx, res + 2 * h, op1 + h, n1 - h, op2 + h, n2 - h) ||
+        js_mp_mul(ctx, z1, s1, h + 1, s2, h + 1)) {
+        js_free(ctx, buf);
+        return -1;
+    }
+    js_mp_sub_from(z1, 2 * h + 2, res, 2 * h);
+    js_mp_sub_from(z1, 2 * h + 2, res + 2 * h, n - 2 * h);
+    /* the limbs of z1 above the size of the result are zero */
+    js_mp_add_to(res + h, n - h, z1, min_int(2 * h + 2, n - h));
+    js_free(ctx, buf);
+    return 0;
+}
+
+/* Toom-Cook 3-way multiplication, 2 * ((n1 + 2) / 3) < n2 <= n1. The
+   operands are split in 3 parts and the product polynomial is
+   evaluated at 0, 1, -1, 2 and infinity. The intermediate values are
+   handled as two's complement numbers of 2 * k + 2 limbs. */
+static int js_mp_mul_toom3(JSContext *ctx, js_limb_t *res,
+                           const js_limb_t *op1, int n1,
+                           const js_limb_t *op2, int n2)
+{
+    js_limb_t *buf, *e1, *e2, *v1, *vm1, *v2;
+    int k, w, n, n4, neg, i;
+    const js_limb_t *op, *a0, *a1, *a2;
+    int n_op;
+
+    k = (n1 + 2) / 3;
+    w = 2 * k + 2;
+    n = n1 + n2;
+    n4 = n - 4 * k; /* size of the product of the high parts */
+    buf = js_malloc(ctx, (2 * (k + 1) + 3 * w) * sizeof(buf[0]));
+    if (!buf)
+        return -1;
+    e1 = buf;
+    e2 = e1 + k + 1;
+    v1 = e2 + k + 1;
+    vm1 = v1 + w;
+    v2 = vm1 + w;
+
+    /* value at -1: |a0 - a1 + a2|, the sign is kept in 'neg' */
+    neg = 0;
+    for(i = 0; i < 2; i++) {
+        js_limb_t *e = i == 0 ? e1 : e2;
+        op = i == 0 ? op1 : op2;
+        n_op = i == 0 ? n1 : n2;
+        a0 = op;
+        a1 = op + k;
+        a2 = op + 2 * k;
+        memcpy(e, a0, k * sizeof(e[0]));
+        e[k] = js_mp_add_to(e, k, a2, n_op - 2 * k);
+        if (e[k] == 0 && js_mp_cmp(e, a1, k) < 0) {
+            js_mp_sub(e, a1, e, k, 0);
+            neg ^= 1;
+        } else {
+            e[k] -= js_mp_sub(e, e, a1, k, 0);
+        }
+    }
+    if (js_mp_mul(ctx, vm1, e1, k + 1, e2, k + 1))
+        goto fail;
+    if (neg)
+        js_mp_neg(vm1, vm1, w);
+
+    /* value at 1: a0 + a1 + a2 */
+    for(i = 0; i < 2; i++) {
+        js_limb_t *e = i == 0 ? e1 : e2;
+        op = i == 0 ? op1 : op2;
+        n_op = i == 0 ? n1 : n2;
+        memcpy(e, op, k * sizeof(e[0]));
+        e[k] = js_mp_add_to(e, k, op + 2 * k, n_op - 2 * k);
+        e[k] += js_mp_add_to(e, k, op + k, k);
+    }
+    if (js_mp_mul(ctx, v1, e1, k + 1, e2, k + 1))
+        goto fail;
+
+    /* value at 2: a0 + 2 * a1 + 4 * a2 */
+    for(i = 0; i < 2; i++) {
+        js_limb_t *e = i == 0 ? e1 : e2;
+        op = i == 0 ? op1 : op2;
+        n_op = i == 0 ? n1 : n2;
+        memset(e, 0, (k + 1) * sizeof(e[0]));
+        memcpy(e, op + 2 * k, (n_op - 2 * k) * sizeof(e[0]));
+        js_mp_shl(e, e, k + 1, 1);
+        js_mp_add_to(e, k + 1, op + k, k);
+        js_mp_shl(e, e, k + 1, 1);
+        js_mp_add_to(e, k + 1, op, k);
+    }
+    if (js_mp_mul(ctx, v2, e1, k + 1, e2, k + 1))
+        goto fail;
+
+    /* values at 0 and infinity, directly at their final position */
+    if (js_mp_mul(ctx, res, op1, k, op2, k) ||
+        js_mp_mul(ctx, res + 4 * k, op1 + 2 * k, n1 - 2 * k, op2 + 2 * k, n2 - 2 * k))
+        goto fail;
+
+    /* interpolation */
+    js_mp_sub(v2, v2, vm1, w, 0);
+    js_mp_divexact3(v2, w);                   /* t2 = (r(2) - r(-1)) / 3 */
+    js_mp_sub(v1, v1, vm1, w, 0);
+    js_mp_sar1(v1, w);                        /* t1 = (r(1) - r(-1)) / 2 */
+    js_mp_add(vm1, vm1, v1, w, 0);
+    js_mp_sub_from(vm1, w, res, 2 * k);
+    js_mp_sub_from(vm1, w, res + 4 * k, n4);  /* c2 = r(-1) + t1 - r(0) - r(inf) */
+    js_mp_sub(v2, v2, vm1, w, 0);
+    js_mp_sub(v2, v2, v1, w, 0);
+    js_mp_sub_from(v2, w, res + 4 * k, n4);
+    js_mp_sar1(v2, w);
+    js_mp_sub_from(v2, w, res + 4 * k, n4);
+    js_mp_sub_from(v2, w, res + 4 * k, n4);   /* c3 = (t2 - c2 - t1 - r(inf)) / 2 - 2 * r(inf) */
+    js_mp_sub(v1, v1, v2, w, 0);              /* c1 = t1 - c3 */
+
+    /* recomposition, the limbs above the size of the result are zero */
+    memset(res + 2 * k, 0, 2 * k * sizeof(res[0]));
+    js_mp_add_to(res + k, n - k, v1, min_int(w, n - k));
+    js_mp_add_to(res + 2 * k, n - 2 * k, vm1, min_int(w, n - 2 * k));
+    js_mp_add_to(res + 3 * k, n - 3 * k, v2, min_int(w, n - 3 * k));
+    js_free(ctx, buf);
+    return 0;
+ fail:
+    js_free(ctx, buf);
+    return -1;
+}
+
+/* Number theoretic transform multiplication. The limbs are the
+   coefficients of polynomials whose product is computed modulo three
+   primes of the form c * 2^k + 1 and reconstructed with the Chinese
+   remainder theorem. The coefficients of the product are < n2 *
+   2^64, which is smaller than the product of the primes for any
+   operand size allowed by JS_BIGINT_MAX_SIZE. The arithmetic modulo p
+   is done in Montgomery form with R = 2^32. */
+
+#define JS_NTT_MOD_COUNT 3
+
+typedef struct {
+    uint32_t p;
+    uint32_t g; /* primitive root */
+    int log2_max; /* the largest supported transform is 2^log2_max */
+} JSNTTMod;
+
+static const JSNTTMod js_ntt_mods[JS_NTT_MOD_COUNT] = {
+    { 469762049,  3, 26 }, /* 7 * 2^26 + 1 */
+    { 998244353,  3, 23 }, /* 119 * 2^23 + 1 */
+    { 2013265921, 31, 27 }, /* 15 * 2^27 + 1 */
+};
+
+static inline uint32_t js_ntt_redc(uint64_t t, uint32_t p, uint32_t p_inv)
+{
+    uint32_t m, u;
+    m = (uint32_t)t * p_inv;
+    u = (t + (uint64_t)m * p) >> 32;
+    return u >= p ? u - p : u;
+}
+
+static inline uint32_t js_ntt_mul(uint32_t a, uint32_t b, uint32_t p,
+                                  uint32_t p_inv)
+{
+    return js_ntt_redc((uint64_t)a * b, p, p_inv);
+}
+
+static inline uint32_t js_ntt_add(uint32_t a, uint32_t b, uint32_t p)
+{
+    uint32_t r = a + b;
+    return r >= p ? r - p : r;
+}
+
+static inline uint32_t js_ntt_sub(uint32_t a, uint32_t b, uint32_t p)
+{
+    return a >= b ? a - b : a + p - b;
+}
+
+static uint32_t js_ntt_pow(uint32_t a, uint32_t e, uint32_t p)
+{
+    uint64_t r = 1, b = a;
+    while (e != 0) {
+        if (e & 1)
+            r = r * b % p;
+        b = b * b % p;
+        e >>= 1;
+    }
+    return r;
+}
+
+/* forward transform (decimation in frequency), the output is in bit
+   reversed order. 'roots' contains w^i, 0 <= i < n / 2. */
+static void js_ntt_forward(uint32_t *a, int n, const uint32_t *roots,
+                           uint32_t p, uint32_t p_inv)
+{
+    int len, half, stride, i, j;
+    uint32_t u, v;
+
+    for(len = n, stride = 1; len >= 2; len >>= 1, stride <<= 1) {
+        half = len / 2;
+        for(i = 0; i < n; i += len) {
+            for(j = 0; j < half; j++) {
+                u = a[i + j];
+                v = a[i + j + half];
+                a[i + j] = js_ntt_add(u, v, p);
+                a[i + j + half] = js_ntt_mul(js_ntt_sub(u, v, p),
+                                             roots[j * stride], p, p_inv);
+            }
+        }
+    }
+}
+
+/* inverse transform (decimation in time) of bit reversed input, without
+   the division by n. 'roots' contains w^-i, 0 <= i < n / 2. */
+static void js_ntt_inverse(uint32_t *a, int n, const uint32_t *roots,
+                           uint32_t p, uint32_t p_inv)
+{
+    int len, half, stride, i, j;
+    uint32_t u, v;
+
+    for(len = 2, stride = n / 2; len <= n; len <<= 1, stride >>= 1) {
+        half = len / 2;
+        for(i = 0; i < n; i += len) {
+            for(j = 0; j < half; j++) {
+                u = a[i + j];
+                v = js_ntt_mul(a[i + j + half], roots[j * stride], p, p_inv);
+                a[i + j] = js_ntt_add(u, v, p);
+                a[i + j + half] = js_ntt_sub(u, v, p);
+            }
+        }
+    }
+}
+
+/* res[0..n1+n2-1] = op1 * op2 modulo js_ntt_mods[k].p, not in
+   Montgomery form. 'buf' has room for 2 * n limbs. */
+static void js_ntt_mul_mod(uint32_t *res, const js_limb_t *op1, int n1,
+                           const js_limb_t *op2, int n2, int k,
+                           int n, int log2_n, uint32_t *buf)
+{
+    const JSNTTMod *m = &js_ntt_mods[k];
+    uint32_t p, p_inv, r2, w, w_inv, x, y, scale, *fa, *roots;
+    int i;
+
+    p = m->p;
+    p_inv = p; /* Newton iteration for p^-1 mod 2^32 */
+    for(i = 0; i < 5; i++)
+        p_inv *= 2 - p * p_inv;
+    p_inv = -p_inv;
+    r2 = ((uint64_t)1 << 32) % p;
+    r2 = (uint64_t)r2 * r2 % p;
+
+    fa = res; /* the product is computed in place */
+    roots = buf + n;
+
+    /* the limbs are < 2^32 and may be >= p: reduce them while
+       converting to Montgomery form (x * R^2 / R = x * R mod p) */
+    for(i = 0; i < n; i++)
+        fa[i] = i < n1 ? js_ntt_redc((uint64_t)(op1[i] % p) * r2, p, p_inv) : 0;
+    for(i = 0; i < n; i++)
+        buf[i] = i < n2 ? js_ntt_redc((uint64_t)(op2[i] % p) * r2, p, p_inv) : 0;
+
+    w = js_ntt_pow(m->g, (p - 1) >> log2_n, p);
+    x = js_ntt_redc((uint64_t)1 * r2, p, p_inv);
+    y = js_ntt_redc((uint64_t)w * r2, p, p_inv);
+    for(i = 0; i < n / 2; i++) {
+        roots[i] = x;
+        x = js_ntt_mul(x, y, p, p_inv);
+    }
+    js_ntt_forward(fa, n, roots, p, p_inv);
+    js_ntt_forward(buf, n, roots, p, p_inv);
+    for(i = 0; i < n; i++)
+        fa[i] = js_ntt_mul(fa[i], buf[i], p, p_inv);
+
+    w_inv = js_ntt_pow(w, p - 2, p);
+    x = js_ntt_redc((uint64_t)1 * r2, p, p_inv);
+    y = js_ntt_redc((uint64_t)w_inv * r2, p, p_inv);
+    for(i = 0; i < n / 2; i++) {
+        roots[i] = x;
+        x = js_ntt_mul(x, y, p, p_inv);
+    }
+    js_ntt_inverse(fa, n, roots, p, p_inv);
+
+    /* divide by n and leave the Montgomery form: multiplying by n^-1
+       (not in Montgomery form) does both */
+    scale = js_ntt_pow(n, p - 2, p);
+    for(i = 0; i < n1 + n2 - 1; i++)
+        fa[i] = js_ntt_mul(fa[i], scale, p, p_inv);
+}
+
+static int js_mp_mul_ntt(JSContext *ctx, js_limb_t *res,
+                         const js_limb_t *op1, int n1,
+                         const js_limb_t *op2, int n2)
+{
+    uint32_t *buf, *r[JS_NTT_MOD_COUNT];
+    uint64_t p1, p2, p3, p12, inv_p1, inv_p12, x12, t2, t3;
+    js_dlimb_t l, h;
+    js_limb_t c0, c1, d0, d1, d2;
+    int n, log2_n, i, k;
+
+    log2_n = 1;
+    while ((1 << log2_n) < n1 + n2 - 1)
+        log2_n++;
+    n = 1 << log2_n;
+    buf = js_malloc(ctx, (JS_NTT_MOD_COUNT + 2) * n * sizeof(buf[0]));
+    if (!buf)
+        return -1;
+    for(k = 0; k < JS_NTT_MOD_COUNT; k++) {
+        r[k] = buf + (k + 2) * n;
+        js_ntt_mul_mod(r[k], op1, n1, op2, n2, k, n, log2_n, buf);
+    }
+
+    /* Garner's algorithm: x = x12 + p1 * p2 * t3 with x12 = r0 + p1 *
+       t2 < p1 * p2 */
+    p1 = js_ntt_mods[0].p;
+    p2 = js_ntt_mods[1].p;
+    p3 = js_ntt_mods[2].p;
+    p12 = p1 * p2;
+    inv_p1 = js_ntt_pow(p1 % p2, p2 - 2, p2);
+    inv_p12 = js_ntt_pow(p12 % p3, p3 - 2, p3);
+    c0 = c1 = 0;
+    for(i = 0; i < n1 + n2; i++) {
+        if (i < n1 + n2 - 1) {
+            t2 = (r[1][i] + p2 - r[0][i] % p2) % p2 * inv_p1 % p2;
+            x12 = r[0][i] + p1 * t2;
+            t3 = (r[2][i] + p3 - x12 % p3) % p3 * inv_p12 % p3;
+            /* d = x12 + p12 * t3 on 3 limbs */
+            l = (js_dlimb_t)(js_limb_t)p12 * t3 + (js_limb_t)x12;
+            h = (js_dlimb_t)(js_limb_t)(p12 >> 32) * t3 + (js_limb_t)(x12 >> 32) +
+                (l >> JS_LIMB_BITS);
+            d0 = l;
+            d1 = h;
+            d2 = h >> JS_LIMB_BITS;
+        } else {
+            d0 = d1 = d2 = 0;
+        }
+        /* add the coefficient to the carry of the previous ones,
+           which fits in two limbs */
+        l = (js_dlimb_t)c0 + d0;
+        res[i] = l;
+        l = (js_dlimb_t)c1 + d1 + (l >> JS_LIMB_BITS);
+        c0 = l;
+        c1 = d2 + (js_limb_t)(l >> JS_LIMB_BITS);
+    }
+    js_free(ctx, buf);
+    return 0;
+}
+
+/* res[0..n1+n2-1] = op1[0..n1-1] * op2[0..n2-1] (unsigned). 'res' must
+   not overlap the operands. Return -1 if memory error. */
+static int js_mp_mul(JSContext *ctx, js_limb_t *res,
+                     const js_limb_t *op1, int n1,
+                     const js_limb_t *op2, int n2)
+{
+    if (n1 < n2) {
+        const js_limb_t *t = op1;
+        int n = n1;
+        op1 = op2;
+        n1 = n2;
+        op2 = t;
+        n2 = n;
+    }
+    if (n2 < JS_MP_KARATSUBA_THRESHOLD) {
+        js_mp_mul_basecase(res, op1, n1, op2, n2);
+        return 0;
+    } else if (n2 <= (n1 + 1) / 2) {
+        return js_mp_mul_unbalanced(ctx, res, op1, n1, op2, n2);
+    } else if (n2 >= JS_MP_NTT_THRESHOLD) {
+        return js_mp_mul_ntt(ctx, res, op1, n1, op2, n2);
+    } else if (n2 >= JS_MP_TOOM3_THRESHOLD && n2 > 2 * ((n1 + 2) / 3)) {
+        return js_mp_mul_toom3(ctx, res, op1, n1, op2, n2);
+    } else {
+        return js_mp_mul_karatsuba(ctx, res, op1, n1, op2, n2);
+    }
+}
+
+/* subtract 1 from tab[0..n-1] */
+static void js_mp_dec(js_limb_t *tab, int n)
+{
+    int i;
+    for(i = 0; i < n; i++) {
+        if (tab[i]-- != 0)
+            break;
+    }
+}
+
+/* taba[0..nb+k-1] -= tabt[0..nt-1] * B^k, with nt <= nb + 1. Return
+   the borrow out of taba[k..k+nb-1] */
+static js_limb_t js_mp_div_sub(js_limb_t *taba, int k, int nb,
+                               const js_limb_t *tabt, int nt)
+{
+    if (nt > nb)
+        return js_mp_sub_from(taba + k, nb, tabt, nb) + tabt[nb];
+    else
+        return js_mp_sub_from(taba + k, nb, tabt, nt);
+}
+
+/* Recursive division (Burnikel and Ziegler, see Algorithm 1.8 in
+   "Modern Computer Arithmetic"). Same contract as js_mp_divnorm() with
+   the additional condition na - nb <= nb. Return -1 if memory
+   error. */
+static int js_mp_divnorm_rec(JSContext *ctx, js_limb_t *tabq, js_limb_t *taba,
+                             int na, const js_limb_t *tabb, int nb)
+{
+    js_limb_t *buf, *q1, *q0, *t, borrow;
+    int m, k, q_top;
+
+    m = na - nb;
+    if (m < JS_MP_DIV_DC_THRESHOLD) {
+        js_mp_divnorm(tabq, taba, na, tabb, nb);
+        return 0;
+    }
+    /* the quotient is < 2 * B^m: reduce it to < B^m */
+    q_top = 0;
+    if (js_mp_cmp(taba + m, tabb, nb) >= 0) {
+        js_mp_sub(taba + m, taba + m, tabb, nb, 0);
+        q_top = 1;
+    }
+
+    k = m / 2;
+    buf = js_malloc(ctx, (2 * m + 3) * sizeof(buf[0]));
+    if (!buf)
+        return -1;
+    q1 = buf;
+    q0 = q1 + m - k + 1;
+    t = q0 + k + 1;
+
+    /* high part of the quotient using the high part of the divisor,
+       then correct the remainder with the low part of the divisor */
+    if (js_mp_divnorm_rec(ctx, q1, taba + 2 * k, na - 2 * k, tabb + k, nb - k) ||
+        js_mp_mul(ctx, t, q1, m - k + 1, tabb, k))
+        goto fail;
+    borrow = js_mp_div_sub(taba, k, nb, t, m + 1);
+    while (borrow != 0) {
+        js_mp_dec(q1, m - k + 1);
+        borrow -= js_mp_add(taba + k, taba + k, tabb, nb, 0);
+    }
+
+    /* same for the low part */
+    if (js_mp_divnorm_rec(ctx, q0, taba + k, nb, tabb + k, nb - k) ||
+        js_mp_mul(ctx, t, q0, k + 1, tabb, k))
+        goto fail;
+    borrow = js_mp_div_sub(taba, 0, nb, t, 2 * k + 1);
+    while (borrow != 0) {
+        js_mp_dec(q0, k + 1);
+        borrow -= js_mp_add(taba, taba, tabb, nb, 0);
+    }
+
+    memcpy(tabq, q0, (k + 1) * sizeof(tabq[0]));
+    memset(tabq + k + 1, 0, (m - k) * sizeof(tabq[0]));
+    js_mp_add(tabq + k, tabq + k, q1, m - k + 1, 0);
+    tabq[m] += q_top;
+    js_free(ctx, buf);
+    return 0;
+ fail:
+    js_free(ctx, buf);
+    return -1;
+}
+
+/* Same contract as js_mp_divnorm(). Large quotients are computed by
+   blocks of nb limbs with js_mp_divnorm_rec(). Return -1 if memory
+   error. */
+static int js_mp_divnorm_dc(JSContext *ctx, js_limb_t *tabq, js_limb_t *taba,
+                            int na, const js_limb_t *tabb, int nb)
+{
+    js_limb_t q;
+    int m;
+
+    m = na - nb;
+    if (m < JS_MP_DIV_DC_THRESHOLD || nb < JS_MP_DIV_DC_THRESHOLD) {
+        js_mp_divnorm(tabq, taba, na, tabb, nb);
+        return 0;
+    }
+    if (js_mp_cmp(taba + m, tabb, nb) >= 0) {
+        js_mp_sub(taba + m, taba + m, tabb, nb, 0);
+        tabq[m] = 1;
+    } else {
+        tabq[m] = 0;
+    }
+    /* the top nb limbs of each block are smaller than 'b', so the
+       quotient of a block has no high limb and the limb of the
+       previous block is preserved */
+    while (m > 0) {
+        int l = min_int(m, nb);
+        m -= l;
+        q = tabq[m + l];
+        if (js_mp_divnorm_rec(ctx, tabq + m, taba + m, nb + l, tabb, nb))
+            return -1;
+        tabq[m + l] = q;
+    }
+    return 0;
+}
+
+/* Powers radix_base^(2^i) used by the divide and conquer radix
+   conversions. */
+typedef struct {
+    js_limb_t *tab;
+    int len;
+} JSRadixPower;
+
+#define JS_RADIX_POWER_MAX 24
+
+static void js_radix_powers_free(JSContext *ctx, JSRadixPower *powers, int n)
+{
+    int i;
+    for(i = 0; i < n; i++)
+        js_free(ctx, powers[i].tab);
+}
+
+/* compute powers[i] from powers[i - 1]. Return -1 if memory error */
+static int js_radix_power_next(JSContext *ctx, JSRadixPower *powers, int i,
+                               js_limb_t radix_base)
+{
+    JSRadixPower *p = &powers[i];
+    int len;
+
+    len = i == 0 ? 1 : 2 * powers[i - 1].len;
+    p->tab = js_malloc(ctx, len * sizeof(p->tab[0]));
+    if (!p->tab)
+        return -1;
+    if (i == 0) {
+        p->tab[0] = radix_base;
+    } else if (js_mp_mul(ctx, p->tab, powers[i - 1].tab, powers[i - 1].len,
+                         powers[i - 1].tab, powers[i - 1].len)) {
+        js_free(ctx, p->tab);
+        return -1;
+    }
+    while (len > 1 && p->tab[len - 1] == 0)
+        len--;
+    p->len = len;
+    return 0;
+}
+
 static JSBigInt *js_bigint_new(JSContext *ctx, int len)
 {
     JSBigInt *r;
@@ -12213,7 +13121,10 @@ static JSBigInt *js_bigint_mul(JSContext *ctx, const JSBigInt *a,
     r = js_bigint_new(ctx, a->len + b->len);
     if (!r)
         return NULL;
-    js_mp_mul_basecase(r->tab, a->tab, a->len, b->tab, b->len);
+    if (js_mp_mul(ctx, r->tab, a->tab, a->len, b->tab, b->len)) {
+        js_free(ctx, r);
+        return NULL;
+    }
     /* correct the result if negative operands (no overflow is
        possible) */
     if (js_bigint_sign(a))
@@ -12303,7 +13214,12 @@ static JSBigInt *js_bigint_divrem(JSContext *ctx, const JSBigInt *a,
 
     //    js_bigint_dump1(ctx, "a", r->tab, na);
     //    js_bigint_dump1(ctx, "b", tabb, nb);
-    js_mp_divnorm(q->tab, r->tab, na, tabb, nb);
+    if (js_mp_divnorm_dc(ctx, q->tab, r->tab, na, tabb, nb)) {
+        js_free(ctx, q);
+        js_free(ctx, r);
+        js_free(ctx, tabb);
+        return NULL;
+    }
     js_free(ctx, tabb);
 
     if (is_rem) {
@@ -12773,6 +13689,112 @@ static const js_limb_t js_pow_dec[JS_LIMB_DIGITS + 1] = {
     1000000000U,
 };
 
+/* 'tab' receives the value of the 'n_digits' decimal digits at 'p'. It
+   must have room for n_digits / JS_LIMB_DIGITS + 1 limbs. Return the
+   number of limbs. */
+static int js_mp_from_dec_basecase(js_limb_t *tab, const char *p, int n_digits)
+{
+    js_limb_t v, h;
+    int len, i, l;
+
+    len = 1;
+    tab[0] = 0;
+    while (n_digits > 0) {
+        l = min_int(n_digits, JS_LIMB_DIGITS);
+        v = 0;
+        for(i = 0; i < l; i++)
+            v = v * 10 + (*p++ - '0');
+        n_digits -= l;
+        h = js_mp_mul1(tab, tab, len, js_pow_dec[l], v);
+        if (h != 0)
+            tab[len++] = h;
+    }
+    return len;
+}
+
+/* upper bound of the number of limbs used by js_mp_from_dec_rec() */
+static int js_mp_from_dec_size(int n_digits)
+{
+    return n_digits / JS_LIMB_DIGITS + 3;
+}
+
+/* Divide and conquer version of js_mp_from_dec_basecase(): the digits
+   are split so that the value is hi * 10^(JS_LIMB_DIGITS * 2^level) +
+   lo. Return the number of limbs or -1 if memory error. */
+static int js_mp_from_dec_rec(JSContext *ctx, js_limb_t *tab, const char *p,
+                              int n_digits, const JSRadixPower *powers,
+                              int level)
+{
+    const JSRadixPower *pw;
+    js_limb_t *buf, *hi, *lo;
+    int d, n_hi, n_lo, len;
+
+    while (level >= 0 && 2 * (JS_LIMB_DIGITS << level) > n_digits)
+        level--;
+    if (level < 0 || n_digits <= JS_MP_FROM_DEC_DC_THRESHOLD * JS_LIMB_DIGITS)
+        return js_mp_from_dec_basecase(tab, p, n_digits);
+
+    d = JS_LIMB_DIGITS << level;
+    pw = &powers[level];
+    buf = js_malloc(ctx, (js_mp_from_dec_size(n_digits - d) +
+                          js_mp_from_dec_size(d)) * sizeof(buf[0]));
+    if (!buf)
+        return -1;
+    hi = buf;
+    lo = buf + js_mp_from_dec_size(n_digits - d);
+    n_hi = js_mp_from_dec_rec(ctx, hi, p, n_digits - d, powers, level);
+    if (n_hi < 0)
+        goto fail;
+    n_lo = js_mp_from_dec_rec(ctx, lo, p + n_digits - d, d, powers, level - 1);
+    if (n_lo < 0)
+        goto fail;
+    len = n_hi + pw->len;
+    if (js_mp_mul(ctx, tab, hi, n_hi, pw->tab, pw->len))
+        goto fail;
+    js_mp_add_to(tab, len, lo, n_lo);
+    while (len > 1 && tab[len - 1] == 0)
+        len--;
+    js_free(ctx, buf);
+    return len;
+ fail:
+    js_free(ctx, buf);
+    return -1;
+}
+
+/* 'tab' receives the value of the 'n_digits' decimal digits at 'p'. It
+   must be large enough for the value. Return the number of limbs or -1
+   if memory error. */
+static int js_mp_from_dec(JSContext *ctx, js_limb_t *tab, const char *p,
+                          int n_digits)
+{
+    JSRadixPower powers[JS_RADIX_POWER_MAX];
+    js_limb_t *buf;
+    int n_powers, len;
+
+    if (n_digits <= JS_MP_FROM_DEC_DC_THRESHOLD * JS_LIMB_DIGITS)
+        return js_mp_from_dec_basecase(tab, p, n_digits);
+
+    n_powers = 0;
+    while (n_powers < JS_RADIX_POWER_MAX &&
+           2 * (JS_LIMB_DIGITS << n_powers) <= n_digits) {
+        if (js_radix_power_next(ctx, powers, n_powers, js_pow_dec[JS_LIMB_DIGITS]))
+            goto fail;
+        n_powers++;
+    }
+    buf = js_malloc(ctx, js_mp_from_dec_size(n_digits) * sizeof(buf[0]));
+    if (!buf)
+        goto fail;
+    len = js_mp_from_dec_rec(ctx, buf, p, n_digits, powers, n_powers - 1);
+    if (len >= 0)
+        memcpy(tab, buf, len * sizeof(tab[0]));
+    js_free(ctx, buf);
+    js_radix_powers_free(ctx, powers, n_powers);
+    return len;
+ fail:
+    js_radix_powers_free(ctx, powers, n_powers);
+    return -1;
+}
+
 /* syntax: [-]digits in base radix. Return NULL if memory error. radix
    = 10, 2, 8 or 16. */
 static JSBigInt *js_bigint_from_string(JSContext *ctx,
@@ -12782,7 +13804,7 @@ static JSBigInt *js_bigint_from_string(JSContext *ctx,
     size_t n_digits1;
     int is_neg, n_digits, n_limbs, len, log2_radix, n_bits, i;
     JSBigInt *r;
-    js_limb_t v, c, h;
+    js_limb_t c;
 
     is_neg = 0;
     if (*p == '-') {
@@ -12812,29 +13834,10 @@ static JSBigInt *js_bigint_from_string(JSContext *ctx,
     if (!r)
         return NULL;
     if (radix == 10) {
-        int digits_per_limb = JS_LIMB_DIGITS;
-        len = 1;
-        r->tab[0] = 0;
-        for(;;) {
-            /* XXX: slow */
-            v = 0;
-            for(i = 0; i < digits_per_limb; i++) {
-                c = js_to_digit(*p);
-                if (c >= radix)
-                    break;
-                p++;
-                v = v * 10 + c;
-            }
-            if (i == 0)
-                break;
-            if (len == 1 && r->tab[0] == 0) {
-                r->tab[0] = v;
-            } else {
-                h = js_mp_mul1(r->tab, r->tab, len, js_pow_dec[i], v);
-                if (h != 0) {
-                    r->tab[len++] = h;
-                }
-            }
+        len = js_mp_from_dec(ctx, r->tab, p, n_digits);
+        if (len < 0) {
+            js_free(ctx, r);
+            return NULL;
         }
         /* add one extra limb to have the correct sign*/
         if ((r->tab[len - 1] >> (JS_LIMB_BITS - 1)) != 0)
@@ -12942,6 +13945,134 @@ static const js_limb_t js_radix_base_table[JS_RADIX_MAX - 1] = {
  0x5c13d840, 0x6d91b519, 0x81bf1000,
 };
 
+/* write the digits of tab[0..len-1] (modified) before 'q', padded with
+   zeros to 'n_digits' digits. Return the position of the first
+   digit. */
+static char *js_mp_to_a_basecase(char *q, js_limb_t *tab, int len,
+                                 int radix, int n_digits)
+{
+    char *q_end = q;
+    js_limb_t radix_base, v;
+
+    radix_base = js_radix_base_table[radix - 2];
+    for(;;) {
+        /* remove leading zero limbs */
+        while (len > 1 && tab[len - 1] == 0)
+            len--;
+        if (len == 1 && tab[0] < radix_base) {
+            v = tab[0];
+            if (v != 0) {
+                q = js_u64toa(q, v, radix);
+            }
+            break;
+        } else {
+            v = js_mp_div1(tab, tab, len, radix_base, 0);
+            q = js_limb_to_a(q, v, radix, js_digits_per_limb_table[radix - 2]);
+        }
+    }
+    while (q_end - q < n_digits)
+        *--q = '0';
+    return q;
+}
+
+/* Divide and conquer version of js_mp_to_a_basecase(): tab[0..len-1]
+   (modified) must be < powers[level + 1]. It is split as hi *
+   powers[level] + lo and both parts are converted recursively. If
+   'pad', exactly js_digits_per_limb_table[radix - 2] * 2^(level + 1)
+   digits are written. Return NULL if memory error. */
+static char *js_mp_to_a_rec(JSContext *ctx, char *q, js_limb_t *tab, int len,
+                            int radix, const JSRadixPower *powers, int level,
+                            bool pad)
+{
+    const JSRadixPower *pw;
+    js_limb_t *buf, *taba, *tabb, *tabq;
+    int n_digits, shift, na, nb, nq;
+
+    while (len > 1 && tab[len - 1] == 0)
+        len--;
+    n_digits = pad ? js_digits_per_limb_table[radix - 2] << (level + 1) : 0;
+    if (level < 0 || len < JS_MP_TO_A_DC_THRESHOLD)
+        return js_mp_to_a_basecase(q, tab, len, radix, n_digits);
+
+    pw = &powers[level];
+    nb = pw->len;
+    if (len < nb) {
+        /* the high part is zero */
+        char *q_end = q;
+        q = js_mp_to_a_rec(ctx, q, tab, len, radix, powers, level - 1, pad);
+        while (q && q_end - q < n_digits)
+            *--q = '0';
+        return q;
+    }
+
+    /* divide by the normalized power */
+    na = len + 1;
+    nq = na - nb + 1;
+    buf = js_malloc(ctx, (na + nb + nq) * sizeof(buf[0]));
+    if (!buf)
+        return NULL;
+    taba = buf;
+    tabb = taba + na;
+    tabq = tabb + nb;
+    shift = js_limb_clz(pw->tab[nb - 1]);
+    if (shift != 0) {
+        js_mp_shl(tabb, pw->tab, nb, shift);
+        taba[len] = js_mp_shl(taba, tab, len, shift);
+    } else {
+        memcpy(tabb, pw->tab, nb * sizeof(tabb[0]));
+        memcpy(taba, tab, len * sizeof(taba[0]));
+        taba[len] = 0;
+    }
+    if (js_mp_divnorm_dc(ctx, tabq, taba, na, tabb, nb)) {
+        js_free(ctx, buf);
+        return NULL;
+    }
+    if (shift != 0)
+        js_mp_shr(taba, taba, nb, shift, 0);
+
+    while (nq > 1 && tabq[nq - 1] == 0)
+        nq--;
+    if (!pad && nq == 1 && tabq[0] == 0) {
+        q = js_mp_to_a_rec(ctx, q, taba, nb, radix, powers, level - 1, false);
+    } else {
+        q = js_mp_to_a_rec(ctx, q, taba, nb, radix, powers, level - 1, true);
+        if (q)
+            q = js_mp_to_a_rec(ctx, q, tabq, nq, radix, powers, level - 1, pad);
+    }
+    js_free(ctx, buf);
+    return q;
+}
+
+/* write the digits of tab[0..len-1] (modified) before 'q'. Return NULL
+   if memory error. */
+static char *js_mp_to_a(JSContext *ctx, char *q, js_limb_t *tab, int len,
+                        int radix)
+{
+    JSRadixPower powers[JS_RADIX_POWER_MAX];
+    js_limb_t radix_base;
+    int n_powers;
+
+    if (len < 2 * JS_MP_TO_A_DC_THRESHOLD)
+        return js_mp_to_a_basecase(q, tab, len, radix, 0);
+
+    /* stop at the first power with more than half the limbs, so that
+       the number is smaller than its square */
+    radix_base = js_radix_base_table[radix - 2];
+    n_powers = 0;
+    do {
+        if (n_powers == JS_RADIX_POWER_MAX ||
+            js_radix_power_next(ctx, powers, n_powers, radix_base)) {
+            js_radix_powers_free(ctx, powers, n_powers);
+            return NULL;
+        }
+        n_powers++;
+    } while (powers[n_powers - 1].len <= (len + 1) / 2);
+
+    q = js_mp_to_a_rec(ctx, q, tab, len, radix, powers, n_powers - 1, false);
+    js_radix_powers_free(ctx, powers, n_powers);
+    return q;
+}
+
 static JSValue js_bigint_to_string1(JSContext *ctx, JSValueConst val, int radix)
 {
     if (JS_VALUE_GET_TAG(val) == JS_TAG_SHORT_BIG_INT) {
@@ -12992,24 +14123,11 @@ static JSValue js_bigint_to_string1(JSContext *ctx, JSValueConst val, int radix)
         *--q = '\0';
         buf_end = q;
         if (!is_binary_radix) {
-            int len;
-            js_limb_t radix_base, v;
-            radix_base = js_radix_base_table[radix - 2];
-            len = r->len;
-            for(;;) {
-                /* remove leading zero limbs */
-                while (len > 1 && r->tab[len - 1] == 0)
-                    len--;
-                if (len == 1 && r->tab[0] < radix_base) {
-                    v = r->tab[0];
-                    if (v != 0) {
-                        q = js_u64toa(q, v, radix);
-                    }
-                    break;
-                } else {
-                    v = js_mp_div1(r->tab, r->tab, len, radix_base, 0);
-                    q = js_limb_to_a(q, v, radix, js_digits_per_limb_table[radix - 2]);
-                }
+            q = js_mp_to_a(ctx, q, r->tab, r->len, radix);
+            if (!q) {
+                js_free(ctx, buf);
+                js_free(ctx, tmp);
+                return JS_EXCEPTION;
             }
         } else {
             int i, shift;
@@ -14106,7 +15224,10 @@ static __maybe_unused void JS_DumpObject(JSRuntime *rt, JSObject *p)
             switch (p->class_id) {
             case JS_CLASS_ARRAY:
             case JS_CLASS_ARGUMENTS:
-                JS_DumpValue(rt, p->u.array.u.values[i]);
+                if (p->u.array.kind == JS_ARRAY_KIND_VALUE)
+                    JS_DumpValue(rt, p->u.array.u.values[i]);
+                else
+                    JS_DumpValue(rt, js_array_get(p, i));
                 break;
             case JS_CLASS_UINT8C_ARRAY:
             case JS_CLASS_INT8_ARRAY:
@@ -16428,6 +17549,11 @@ static __exception int js_for_of_next(JSContext *ctx, JSValue *sp, int offset)
     int done = 1;
 
     if (likely(!JS_IsUndefined(sp[offset]))) {
+        if (js_array_iterator_next_fast(sp[offset], sp[offset + 1], &value)) {
+            sp[0] = value;
+            sp[1] = JS_FALSE;
+            return 0;
+        }
         value = JS_IteratorNext(ctx, sp[offset], sp[offset + 1], 0, NULL, &done);
         if (JS_IsException(value))
             done = -1;
@@ -16528,16 +17654,18 @@ static bool js_is_fast_array(JSContext *ctx, JSValue obj)
     return false;
 }
 
-/* Access an Array's internal JSValue array if available */
-static bool js_get_fast_array(JSContext *ctx, JSValue obj,
-                              JSValue **arrpp, uint32_t *countp)
+/* Access an Array's internal element array if available. The
+   elements are read with js_array_get() or, depending on the element
+   kind, directly. */
+static bool js_get_fast_array(JSContext *ctx, JSValueConst obj,
+                              JSObject **pp, uint32_t *countp)
 {
     /* Try and handle fast arrays explicitly */
     if (JS_VALUE_GET_TAG(obj) == JS_TAG_OBJECT) {
         JSObject *p = JS_VALUE_GET_OBJ(obj);
         if (p->class_id == JS_CLASS_ARRAY && p->fast_array) {
             *countp = p->u.array.count;
-            *arrpp = p->u.array.u.values;
+            *pp = p;
             return true;
         }
     }
@@ -16548,7 +17676,7 @@ static __exception int js_append_enumerate(JSContext *ctx, JSValue *sp)
 {
     JSValue iterator, enumobj, method, value;
     int is_array_iterator;
-    JSValue *arrp;
+    JSObject *p, *p1;
     uint32_t i, count32, pos;
 
     if (JS_VALUE_GET_TAG(sp[-2]) != JS_TAG_INT) {
@@ -16586,7 +17714,7 @@ static __exception int js_append_enumerate(JSContext *ctx, JSValue *sp)
     JSCFunctionType ft2 = { .iterator_next = js_array_iterator_next };
     if (is_array_iterator
             &&  JS_IsCFunction(ctx, method, ft2.generic, 0)
-            &&  js_get_fast_array(ctx, sp[-1], &arrp, &count32)) {
+            &&  js_get_fast_array(ctx, sp[-1], &p1, &count32)) {
         uint32_t len;
         if (js_get_length32(ctx, &len, sp[-1]))
             goto exception;
@@ -16595,10 +17723,27 @@ static __exception int js_append_enumerate(JSContext *ctx, JSValue *sp)
         if (len != count32)
             goto general_case;
         /* Handle fast arrays explicitly */
-        for (i = 0; i < count32; i++) {
-            if (JS_DefinePropertyValueUint32(ctx, sp[-3], pos++,
-                                             js_dup(arrp[i]), JS_PROP_C_W_E) < 0)
+        p = JS_VALUE_GET_OBJ(sp[-3]);
+        if (p->class_id == JS_CLASS_ARRAY && p->fast_array &&
+            p->u.array.count == pos && count32 <= INT32_MAX - pos) {
+            /* append all the elements at once. The element kind is
+               widened first, so appending cannot fail. */
+            if (p1->u.array.kind > p->u.array.kind &&
+                js_array_widen(ctx, p, p1->u.array.kind))
+                goto exception;
+            if (pos + count32 > p->u.array.u1.size &&
+                expand_fast_array(ctx, p, pos + count32) < 0)
                 goto exception;
+            for (i = 0; i < count32; i++)
+                js_array_append(ctx, p, js_array_get(p1, i));
+            pos += count32;
+            set_value(ctx, &p->prop[0].u.value, js_int32(pos));
+        } else {
+            for (i = 0; i < count32; i++) {
+                if (JS_DefinePropertyValueUint32(ctx, sp[-3], pos++,
+                                                 js_array_get(p1, i), JS_PROP_C_W_E) < 0)
+                    goto exception;
+            }
         }
     } else {
     general_case:
@@ -17514,6 +18659,12 @@ static JSValue JS_CallInternal(JSContext *caller_ctx, JSValueConst func_obj,
             if (unlikely(JS_IsException(sp[-1])))
                 goto exception;
             BREAK;
+        CASE(OP_object_template):
+            *sp++ = js_new_object_from_template(ctx, b->cpool[get_u32(pc)]);
+            pc += 4;
+            if (unlikely(JS_IsException(sp[-1])))
+                goto exception;
+            BREAK;
         CASE(OP_special_object):
             {
                 int arg = *pc++;
@@ -17565,6 +18716,42 @@ static JSValue JS_CallInternal(JSContext *caller_ctx, JSValueConst func_obj,
                 }
             }
             BREAK;
+        CASE(OP_get_argc):
+            *sp++ = js_int32(argc);
+            BREAK;
+
+        CASE(OP_get_arg_el):
+            {
+                JSValue val, obj;
+                uint32_t idx;
+
+                if (likely(JS_VALUE_GET_TAG(sp[-1]) == JS_TAG_INT &&
+                           (idx = JS_VALUE_GET_INT(sp[-1])) < (uint32_t)argc)) {
+                    /* the formal parameters may be in a copy of argv */
+                    if (idx < b->arg_count)
+                        sp[-1] = js_dup(arg_buf[idx]);
+                    else
+                        sp[-1] = js_dup(argv[idx]);
+                    BREAK;
+                }
+                /* other properties: use a temporary arguments object */
+                sf->cur_pc = pc;
+                if (b->is_strict_mode || !b->has_simple_parameter_list) {
+                    obj = js_build_arguments(ctx, argc, argv);
+                } else {
+                    obj = js_build_mapped_arguments(ctx, argc, argv,
+                                                    sf, min_int(argc, b->arg_count));
+                }
+                if (unlikely(JS_IsException(obj)))
+                    goto exception;
+                val = JS_GetPropertyValue(ctx, obj, sp[-1]);
+                JS_FreeValue(ctx, obj);
+                sp[-1] = val;
+                if (unlikely(JS_IsException(val)))
+                    goto exception;
+            }
+            BREAK;
+
         CASE(OP_rest):
             {
                 int i, n, first = get_u16(pc);
@@ -18833,6 +20020,17 @@ static JSValue JS_CallInternal(JSContext *caller_ctx, JSValueConst func_obj,
             }
             BREAK;
 
+        CASE(OP_define_template_field):
+            {
+                /* the object cannot be referenced before the literal is
+                   complete, so it still has the template shape */
+                JSObject *p = JS_VALUE_GET_OBJ(sp[-2]);
+                set_value(ctx, &p->prop[get_u32(pc)].u.value, sp[-1]);
+                pc += 4;
+                sp--;
+            }
+            BREAK;
+
         CASE(OP_set_name):
             {
                 int ret;
@@ -18948,6 +20146,19 @@ static JSValue JS_CallInternal(JSContext *caller_ctx, JSValueConst func_obj,
             {
                 JSValue val;
 
+                if (likely(JS_VALUE_GET_TAG(sp[-2]) == JS_TAG_OBJECT &&
+                           JS_VALUE_GET_TAG(sp[-1]) == JS_TAG_INT)) {
+                    JSObject *p = JS_VALUE_GET_OBJ(sp[-2]);
+                    uint32_t idx = JS_VALUE_GET_INT(sp[-1]);
+                    if (likely(p->class_id == JS_CLASS_ARRAY &&
+                               idx < p->u.array.count)) {
+                        val = js_array_get(p, idx);
+                        JS_FreeValue(ctx, sp[-2]);
+                        sp[-2] = val;
+                        sp--;
+                        BREAK;
+                    }
+                }
                 sf->cur_pc = pc;
                 val = JS_GetPropertyValue(ctx, sp[-2], sp[-1]);
                 JS_FreeValue(ctx, sp[-2]);
@@ -19025,9 +20236,11 @@ static JSValue JS_CallInternal(JSContext *caller_ctx, JSValueConst func_obj,
                         p = JS_VALUE_GET_OBJ(sp[-3]);
                         if (likely(p->class_id == JS_CLASS_ARRAY &&
                                    idx < (uint32_t)p->u.array.count)) {
-                            set_value(ctx, &p->u.array.u.values[idx], val);
+                            ret = js_array_set(ctx, p, idx, val);
                             JS_FreeValue(ctx, sp[-3]);
                             sp -= 3;
+                            if (unlikely(ret < 0))
+                                goto exception;
                             BREAK;
                         }
                         if (likely(p->class_id == JS_CLASS_ARRAY &&
@@ -19042,12 +20255,13 @@ static JSValue JS_CallInternal(JSContext *caller_ctx, JSValueConst func_obj,
                                 uint32_t new_len = idx + 1;
                                 array_len = JS_VALUE_GET_INT(p->prop[0].u.value);
                                 if (likely(new_len <= p->u.array.u1.size)) {
-                                    p->u.array.u.values[idx] = val;
-                                    p->u.array.count = new_len;
-                                    if (new_len > array_len)
+                                    ret = js_array_append(ctx, p, val);
+                                    if (likely(ret == 0) && new_len > array_len)
                                         p->prop[0].u.value = js_int32(new_len);
                                     JS_FreeValue(ctx, sp[-3]);
                                     sp -= 3;
+                                    if (unlikely(ret < 0))
+                                        goto exception;
                                     BREAK;
                                 }
                             }
@@ -20407,6 +21621,11 @@ static void js_async_function_terminate(JSRuntime *rt, JSAsyncFunctionData *s)
         async_func_free(rt, &s->func_state);
         s->is_active = false;
     }
+    /* the await functions reference 's' */
+    JS_FreeValueRT(rt, s->await_funcs[0]);
+    JS_FreeValueRT(rt, s->await_funcs[1]);
+    s->await_funcs[0] = JS_UNDEFINED;
+    s->await_funcs[1] = JS_UNDEFINED;
 }
 
 static void js_async_function_free0(JSRuntime *rt, JSAsyncFunctionData *s)
@@ -20505,31 +21724,46 @@ static bool js_async_function_resume(JSContext *ctx, JSAsyncFunctionData *s)
             JS_FreeValue(ctx, value);
             goto resolved;
         } else {
-            JSValue promise, resolving_funcs[2], resolving_funcs1[2];
+            JSValue promise, resolving_funcs1[2];
+            JSValueConst args[5];
             int i, res;
 
             /* await */
             JS_FreeValue(ctx, func_ret); /* not used */
-            promise = js_promise_resolve(ctx, ctx->promise_ctor,
-                                         1, vc(&value), 0);
-            JS_FreeValue(ctx, value);
-            if (JS_IsException(promise))
-                goto fail;
-            if (js_async_function_resolve_create(ctx, s, resolving_funcs)) {
-                JS_FreeValue(ctx, promise);
+            if (JS_IsUndefined(s->await_funcs[0]) &&
+                js_async_function_resolve_create(ctx, s, s->await_funcs)) {
+                JS_FreeValue(ctx, value);
                 goto fail;
             }
+            if (JS_VALUE_GET_TAG(value) != JS_TAG_OBJECT &&
+                !ctx->rt->promise_hook) {
+                /* a primitive value is not a thenable: the promise
+                   returned by PromiseResolve() would already be
+                   fulfilled, so the reaction job is enqueued
+                   directly */
+                args[0] = JS_UNDEFINED;
+                args[1] = JS_UNDEFINED;
+                args[2] = s->await_funcs[0];
+                args[3] = JS_FALSE;
+                args[4] = value;
+                res = JS_EnqueueJob(ctx, promise_reaction_job, 5, args);
+                JS_FreeValue(ctx, value);
+            } else {
+                promise = js_promise_resolve(ctx, ctx->promise_ctor,
+                                             1, vc(&value), 0);
+                JS_FreeValue(ctx, value);
+                if (JS_IsException(promise))
+                    goto fail;
 
-            /* Note: no need to create 'thrownawayCapability' as in
-               the spec */
-            for(i = 0; i < 2; i++)
-                resolving_funcs1[i] = JS_UNDEFINED;
-            res = perform_promise_then(ctx, promise,
-                                       vc(resolving_funcs),
-                                       vc(resolving_funcs1));
-            JS_FreeValue(ctx, promise);
-            for(i = 0; i < 2; i++)
-                JS_FreeValue(ctx, resolving_funcs[i]);
+                /* Note: no need to create 'thrownawayCapability' as in
+                   the spec */
+                for(i = 0; i < 2; i++)
+                    resolving_funcs1[i] = JS_UNDEFINED;
+                res = perform_promise_then(ctx, promise,
+                                           vc(s->await_funcs),
+                                           vc(resolving_funcs1));
+                JS_FreeValue(ctx, promise);
+            }
             if (res)
                 goto fail;
         }
@@ -20579,6 +21813,8 @@ static JSValue js_async_function_call(JSContext *ctx, JSValueConst func_obj,
     s->is_active = false;
     s->resolving_funcs[0] = JS_UNDEFINED;
     s->resolving_funcs[1] = JS_UNDEFINED;
+    s->await_funcs[0] = JS_UNDEFINED;
+    s->await_funcs[1] = JS_UNDEFINED;
 
     promise = JS_NewPromiseCapability(ctx, s->resolving_funcs);
     if (JS_IsException(promise))
@@ -21979,6 +23215,94 @@ static void reparse_ident_token(JSParseState *s)
     }
 }
 
+#define SWAR_ONES  UINT64_C(0x0101010101010101)
+#define SWAR_HIGHS UINT64_C(0x8080808080808080)
+
+/* non zero if one of the 8 bytes of 'v' is 'c' */
+static inline uint64_t swar_has_byte(uint64_t v, uint8_t c)
+{
+    uint64_t x = v ^ (SWAR_ONES * c);
+    return (x - SWAR_ONES) & ~x & SWAR_HIGHS;
+}
+
+/* skip spaces and tabs. Indentation is checked 8 spaces at a time. */
+static const uint8_t *skip_blanks(const uint8_t *p, const uint8_t *end)
+{
+    while (end - p >= 8 && get_u64(p) == SWAR_ONES * ' ')
+        p += 8;
+    while (*p == ' ' || *p == '\t')
+        p++;
+    return p;
+}
+
+/* skip the bytes of a line comment up to the next CR, LF or non ASCII
+   character, 8 bytes at a time */
+static const uint8_t *skip_line_comment_ascii(const uint8_t *p,
+                                              const uint8_t *end)
+{
+    uint64_t v;
+
+    while (end - p >= 8) {
+        v = get_u64(p);
+        if ((v & SWAR_HIGHS) | swar_has_byte(v, '\n') | swar_has_byte(v, '\r'))
+            break;
+        p += 8;
+    }
+    return p;
+}
+
+/* same for a block comment, which also stops at '*' */
+static const uint8_t *skip_block_comment_ascii(const uint8_t *p,
+                                               const uint8_t *end)
+{
+    uint64_t v;
+
+    while (end - p >= 8) {
+        v = get_u64(p);
+        if ((v & SWAR_HIGHS) | swar_has_byte(v, '\n') |
+            swar_has_byte(v, '\r') | swar_has_byte(v, '*'))
+            break;
+        p += 8;
+    }
+    return p;
+}
+
+/* Fast path of parse_ident() for identifiers made of ASCII characters
+   without escapes: the atom is looked up directly in the source with
+   the hash computed while scanning. Return false if the identifier
+   needs the general path. Otherwise '*patom' is JS_ATOM_NULL in case
+   of exception. */
+static bool parse_ascii_ident(JSParseState *s, const uint8_t **pp,
+                              JSAtom *patom)
+{
+    const uint8_t *p, *start;
+    JSAtom atom;
+    JSValue str;
+    uint32_t h;
+    int c;
+
+    start = p = *pp;
+    h = JS_ATOM_TYPE_STRING;
+    c = *p;
+    do {
+        h = h * 263 + c;
+        c = *++p;
+    } while (c < 128 && lre_js_is_ident_next(c));
+    if (c >= 128 || c == '\\')
+        return false;
+    atom = __JS_FindAtomHash(s->ctx->rt, (const char *)start, p - start, h);
+    if (!atom) {
+        str = js_new_string8_len(s->ctx, (const char *)start, p - start);
+        if (JS_IsException(str))
+            atom = JS_ATOM_NULL;
+        else
+            atom = JS_NewAtomStr(s->ctx, JS_VALUE_GET_STRING(str));
+    }
+    *patom = atom;
+    *pp = p;
+    return true;
+}
+
 /* 'c' is the first character. Return JS_ATOM_NULL in case of error */
 static JSAtom parse_ident(JSParseState *s, const uint8_t **pp,
                           bool *pident_has_escape, int c, bool is_private)
@@ -22085,13 +23409,15 @@ static __exception int next_token(JSParseState *s)
     case '\v':
     case ' ':
     case '\t':
-        s->mark = ++p;
+        p = skip_blanks(p + 1, s->buf_end);
+        s->mark = p;
         goto redo;
     case '/':
         if (p[1] == '*') {
             /* comment */
             p += 2;
             for(;;) {
+                p = skip_block_comment_ascii(p, s->buf_end);
                 if (*p == '\0' && p >= s->buf_end) {
                     js_parse_error(s, "unexpected end of comment");
                     goto fail;
@@ -22125,6 +23451,7 @@ static __exception int next_token(JSParseState *s)
             p += 2;
         skip_line_comment:
             for(;;) {
+                p = skip_line_comment_ascii(p, s->buf_end);
                 if (*p == '\0' && p >= s->buf_end)
                     break;
                 if (*p == '\r' || *p == '\n')
@@ -22182,12 +23509,18 @@ static __exception int next_token(JSParseState *s)
     case '$':
         /* identifier */
         s->mark = p;
-        p++;
         ident_has_escape = false;
+        if (likely(parse_ascii_ident(s, &p, &atom))) {
+            if (atom == JS_ATOM_NULL)
+                goto fail;
+            goto ident_done;
+        }
+        p++;
     has_ident:
         atom = parse_ident(s, &p, &ident_has_escape, c, false);
         if (atom == JS_ATOM_NULL)
             goto fail;
+    ident_done:
         s->token.u.ident.atom = atom;
         s->token.u.ident.has_escape = ident_has_escape;
         s->token.u.ident.is_reserved = false;
@@ -22727,7 +24060,7 @@ static __exception int json_next_token(JSParseState *s)
         goto def_token;
     case ' ':
     case '\t':
-        p++;
+        p = skip_blanks(p + 1, s->buf_end);
         s->mark = p;
         goto redo;
     case '/':
@@ -24179,17 +25512,96 @@ static void set_object_name_computed(JSParseState *s)
     }
 }
 
+/* object literals with at most this number of fields are created from
+   a template holding their final shape */
+#define JS_OBJECT_TEMPLATE_MAX_FIELDS 32
+
+/* Patch an object literal whose properties are all static fields so
+   that it is created from a template. 'template_pos' is the position of
+   the 4 OP_nop + OP_object placeholder and 'field_pos' the positions of
+   the OP_define_field opcodes. */
+static int js_emit_object_template(JSParseState *s, int template_pos,
+                                   const int *field_pos, int field_count)
+{
+    JSContext *ctx = s->ctx;
+    DynBuf *bc = &s->cur_func->byte_code;
+    int slot[JS_OBJECT_TEMPLATE_MAX_FIELDS];
+    JSAtom atoms[JS_OBJECT_TEMPLATE_MAX_FIELDS];
+    int i, j, prop_count, hash_size, idx;
+    JSShape *sh;
+    JSObject *p;
+    JSValue obj;
+
+    if (bc->error)
+        return 0;
+    /* a duplicate field reuses the index of the first definition */
+    prop_count = 0;
+    for(i = 0; i < field_count; i++) {
+        JSAtom atom = get_u32(bc->buf + field_pos[i] + 1);
+        for(j = 0; j < prop_count; j++) {
+            if (atoms[j] == atom)
+                break;
+        }
+        if (j == prop_count)
+            atoms[prop_count++] = atom;
+        slot[i] = j;
+    }
+
+    hash_size = JS_PROP_INITIAL_HASH_SIZE;
+    while (hash_size / 2 < prop_count)
+        hash_size = 2 * hash_size;
+    sh = js_new_shape2(ctx, get_proto_obj(ctx->class_proto[JS_CLASS_OBJECT]),
+                       hash_size, prop_count);
+    if (!sh)
+        return -1;
+    for(i = 0; i < prop_count; i++) {
+        if (add_shape_property(ctx, &sh, NULL, atoms[i], JS_PROP_C_W_E)) {
+            js_free_shape(ctx->rt, sh);
+            return -1;
+        }
+    }
+    obj = JS_NewObjectFromShape(ctx, sh, JS_CLASS_OBJECT, NULL);
+    if (JS_IsException(obj))
+        return -1;
+    p = JS_VALUE_GET_OBJ(obj);
+    for(i = 0; i < prop_count; i++)
+        p->prop[i].u.value = JS_UNDEFINED;
+    idx = cpool_add(s, obj);
+    if (idx < 0) {
+        JS_FreeValue(ctx, obj);
+        return -1;
+    }
+
+    bc->buf[template_pos] = OP_object_template;
+    put_u32(bc->buf + template_pos + 1, idx);
+    for(i = 0; i < field_count; i++) {
+        JS_FreeAtom(ctx, get_u32(bc->buf + field_pos[i] + 1));
+        bc->buf[field_pos[i]] = OP_define_template_field;
+        put_u32(bc->buf + field_pos[i] + 1, slot[i]);
+    }
+    return 0;
+}
+
 static __exception int js_parse_object_literal(JSParseState *s)
 {
     JSAtom name = JS_ATOM_NULL;
     const uint8_t *start_ptr;
     int start_line, start_col, prop_type;
-    bool has_proto;
+    int template_pos, field_count, field_pos[JS_OBJECT_TEMPLATE_MAX_FIELDS];
+    bool has_proto, is_template;
 
     if (next_token(s))
         goto fail;
-    /* XXX: add an initial length that will be patched back */
+    /* placeholder for OP_object_template, the OP_nop are removed in
+       pass 3 if the literal cannot use a template */
+    template_pos = s->cur_func->byte_code.size;
+    emit_op(s, OP_nop);
+    emit_op(s, OP_nop);
+    emit_op(s, OP_nop);
+    emit_op(s, OP_nop);
     emit_op(s, OP_object);
+    field_count = 0;
+    is_template = true;
     has_proto = false;
     while (s->token.val != '}') {
         /* specific case for getter/setter */
@@ -24207,6 +25619,7 @@ static __exception int js_parse_object_literal(JSParseState *s)
             emit_u8(s, 2 | (1 << 2) | (0 << 5));
             emit_op(s, OP_drop); /* pop excludeList */
             emit_op(s, OP_drop); /* pop src object */
+            is_template = false;
             goto next;
         }
 
@@ -24219,8 +25632,7 @@ static __exception int js_parse_object_literal(JSParseState *s)
             emit_op(s, OP_scope_get_var);
             emit_atom(s, name);
             emit_u16(s, s->cur_func->scope_level);
-            emit_op(s, OP_define_field);
-            emit_atom(s, name);
+            goto define_field;
         } else if (s->token.val == '(') {
             bool is_getset = (prop_type == PROP_TYPE_GET ||
                               prop_type == PROP_TYPE_SET);
@@ -24256,6 +25668,7 @@ static __exception int js_parse_object_literal(JSParseState *s)
                 op_flags = OP_DEFINE_METHOD_METHOD;
             }
             emit_u8(s, op_flags | OP_DEFINE_METHOD_ENUMERABLE);
+            is_template = false;
         } else {
             if (js_parse_expect(s, ':'))
                 goto fail;
@@ -24265,6 +25678,7 @@ static __exception int js_parse_object_literal(JSParseState *s)
                 set_object_name_computed(s);
                 emit_op(s, OP_define_array_el);
                 emit_op(s, OP_drop);
+                is_template = false;
             } else if (name == JS_ATOM___proto__) {
                 if (has_proto) {
                     js_parse_error(s, "duplicate __proto__ property name");
@@ -24272,8 +25686,14 @@ static __exception int js_parse_object_literal(JSParseState *s)
                 }
                 emit_op(s, OP_set_proto);
                 has_proto = true;
+                is_template = false;
             } else {
                 set_object_name(s, name);
+            define_field:
+                if (field_count < JS_OBJECT_TEMPLATE_MAX_FIELDS)
+                    field_pos[field_count++] = s->cur_func->byte_code.size;
+                else
+                    is_template = false;
                 emit_op(s, OP_define_field);
                 emit_atom(s, name);
             }
@@ -24288,6 +25708,10 @@ static __exception int js_parse_object_literal(JSParseState *s)
     }
     if (js_parse_expect(s, '}'))
         goto fail;
+    if (is_template && field_count > 0) {
+        if (js_emit_object_template(s, template_pos, field_pos, field_count))
+            goto fail;
+    }
     return 0;
  fail:
     JS_FreeAtom(s->ctx, name);
@@ -33420,6 +34844,137 @@ static int get_label_pos(JSFunctionDef *s, int label)
     return pos;
 }
 
+static int skip_source_loc(const uint8_t *bc_buf, int pos, int bc_len)
+{
+    while (pos < bc_len && bc_buf[pos] == OP_source_loc)
+        pos += opcode_info[OP_source_loc].size;
+    return pos;
+}
+
+/* Find the end of an 'arguments.length' or 'arguments[index]' read
+   starting at the 'scope_get_var arguments' opcode at 'pos' where
+   'index' is a variable or a constant. Return the position of the
+   OP_get_field or OP_get_array_el opcode or -1 if no match. */
+static int match_arguments_access(const uint8_t *bc_buf, int pos, int bc_len)
+{
+    int op;
+
+    pos = skip_source_loc(bc_buf, pos + opcode_info[OP_scope_get_var].size,
+                          bc_len);
+    if (pos >= bc_len)
+        return -1;
+    op = bc_buf[pos];
+    if (op == OP_get_field)
+        return get_u32(bc_buf + pos + 1) == JS_ATOM_length ? pos : -1;
+    if (op == OP_scope_get_var) {
+        if (get_u32(bc_buf + pos + 1) == JS_ATOM_arguments)
+            return -1;
+    } else if (op != OP_push_i32 && op != OP_push_const &&
+               op != OP_push_atom_value) {
+        return -1;
+    }
+    pos = skip_source_loc(bc_buf, pos + opcode_info[op].size, bc_len);
+    if (pos >= bc_len || bc_buf[pos] != OP_get_array_el)
+        return -1;
+    return pos;
+}
+
+/* If 'arguments' is only read as 'arguments.length' or
+   'arguments[index]', replace the accesses with OP_get_argc and
+   OP_get_arg_el before the variables are resolved, so that the
+   'arguments' variable and object are never created. Must be called
+   after the child functions are created because they may reference
+   'arguments'. */
+static void optimize_arguments(JSContext *ctx, JSFunctionDef *s)
+{
+    uint8_t *bc_buf = s->byte_code.buf;
+    int bc_len = s->byte_code.size;
+    int pos, pos1, op, i;
+    bool is_mapped;
+    JSAtom atom;
+
+    /* 'arguments_var_idx' is already defined if 'arguments' is
+       declared, used by a child function or by eval() */
+    if (!s->has_arguments_binding || s->arguments_var_idx >= 0 ||
+        s->arguments_arg_idx >= 0 || s->has_eval_call || s->byte_code.error)
+        return;
+    for(i = 0; i < s->var_count; i++) {
+        atom = s->vars[i].var_name;
+        if (atom == JS_ATOM_arguments || atom == JS_ATOM__with_)
+            return;
+    }
+    for(i = 0; i < s->arg_count; i++) {
+        if (s->args[i].var_name == JS_ATOM_arguments)
+            return;
+    }
+    /* the elements of a mapped arguments object follow the
+       parameters. Otherwise they are read from the parameters, which
+       must then keep their initial value */
+    is_mapped = !s->is_strict_mode && s->has_simple_parameter_list;
+    if (!is_mapped) {
+        for(i = 0; i < s->arg_count; i++) {
+            if (s->args[i].is_captured || s->args[i].func_pool_idx >= 0)
+                return;
+        }
+    }
+
+    for(pos = 0; pos < bc_len; pos += opcode_info[op].size) {
+        op = bc_buf[pos];
+        switch(op) {
+        case OP_scope_get_var:
+            if (get_u32(bc_buf + pos + 1) == JS_ATOM_arguments &&
+                match_arguments_access(bc_buf, pos, bc_len) < 0)
+                return;
+            break;
+        case OP_scope_get_var_undef:
+        case OP_scope_put_var:
+        case OP_scope_delete_var:
+        case OP_scope_make_ref:
+        case OP_scope_get_ref:
+        case OP_scope_put_var_init:
+            atom = get_u32(bc_buf + pos + 1);
+            if (atom == JS_ATOM_arguments)
+                return;
+            if (!is_mapped) {
+                for(i = 0; i < s->arg_count; i++) {
+                    if (s->args[i].var_name == atom)
+                        return;
+                }
+            }
+            break;
+        case OP_put_arg:
+        case OP_set_arg:
+            if (!is_mapped)
+                return;
+            break;
+        default:
+            break;
+        }
+    }
+
+    for(pos = 0; pos < bc_len; pos += opcode_info[op].size) {
+        op = bc_buf[pos];
+        if (op != OP_scope_get_var ||
+            get_u32(bc_buf + pos + 1) != JS_ATOM_arguments)
+            continue;
+        pos1 = match_arguments_access(bc_buf, pos, bc_len);
+        JS_FreeAtom(ctx, JS_ATOM_arguments);
+        memset(bc_buf + pos, OP_nop, opcode_info[op].size);
+        if (bc_buf[pos1] == OP_get_field) {
+            JS_FreeAtom(ctx, JS_ATOM_length);
+            memset(bc_buf + pos1, OP_nop, opcode_info[OP_get_field].size);
+            bc_buf[pos] = OP_get_argc;
+        } else {
+            bc_buf[pos1] = OP_get_arg_el;
+        }
+    }
+    /* OP_get_arg_el may build a mapped arguments object */
+    if (is_mapped) {
+        for(i = 0; i < s->arg_count; i++)
+            capture_var(s, &s->args[i]);
+    }
+}
+
 /* convert global variable accesses to local variables or closure
    variables when necessary */
 static __exception int resolve_variables(JSContext *ctx, JSFunctionDef *s)
@@ -33431,6 +34986,8 @@ static __exception int resolve_variables(JSContext *ctx, JSFunctionDef *s)
     CodeContext cc;
     int scope;
 
+    optimize_arguments(ctx, s);
+
     cc.bc_buf = bc_buf = s->byte_code.buf;
     cc.bc_len = bc_len = s->byte_code.size;
     js_dbuf_init(ctx, &bc_out);
@@ -36666,7 +38223,7 @@ typedef enum BCTagEnum {
     BC_TAG_SYMBOL,
 } BCTagEnum;
 
-#define BC_VERSION 23
+#define BC_VERSION 25
 
 typedef struct BCWriterState {
     JSContext *ctx;
@@ -40594,7 +42151,7 @@ static JSValue *build_arg_list(JSContext *ctx, uint32_t *plen,
         p->fast_array &&
         len == p->u.array.count) {
         for(i = 0; i < len; i++) {
-            tab[i] = js_dup(p->u.array.u.values[i]);
+            tab[i] = js_array_get(p, i);
         }
     } else {
         for(i = 0; i < len; i++) {
@@ -41070,13 +42627,27 @@ static int JS_CopySubArray(JSContext *ctx,
             if (dir < 0) {
                 l = min_int64(l, from + 1);
                 l = min_int64(l, to + 1);
+            } else {
+                l = min_int64(l, len - from);
+                l = min_int64(l, len - to);
+            }
+            if (p->u.array.kind != JS_ARRAY_KIND_VALUE) {
+                /* unboxed elements can be moved at once */
+                size_t elt_size = js_array_kind_size(p->u.array.kind);
+                uint8_t *tab = p->u.array.u.ptr;
+                if (dir < 0) {
+                    memmove(tab + (to - l + 1) * elt_size,
+                            tab + (from - l + 1) * elt_size, l * elt_size);
+                } else {
+                    memmove(tab + to * elt_size, tab + from * elt_size,
+                            l * elt_size);
+                }
+            } else if (dir < 0) {
                 for(j = 0; j < l; j++) {
                     set_value(ctx, &p->u.array.u.values[to - j],
                               js_dup(p->u.array.u.values[from - j]));
                 }
             } else {
-                l = min_int64(l, len - from);
-                l = min_int64(l, len - to);
                 for(j = 0; j < l; j++) {
                     set_value(ctx, &p->u.array.u.values[to + j],
                               js_dup(p->u.array.u.values[from + j]));
@@ -41386,8 +42957,8 @@ static JSValue js_array_at(JSContext *ctx, JSValueConst this_val,
 static JSValue js_array_with(JSContext *ctx, JSValueConst this_val,
                              int argc, JSValueConst *argv)
 {
-    JSValue arr, obj, ret, *arrp, *pval;
-    JSObject *p;
+    JSValue arr, obj, ret, *pval;
+    JSObject *p, *p1;
     int64_t i, len, idx;
     uint32_t count32;
 
@@ -41418,19 +42989,24 @@ static JSValue js_array_with(JSContext *ctx, JSValueConst this_val,
         goto exception;
 
     p = JS_VALUE_GET_OBJ(arr);
-    if (expand_fast_array(ctx, p, len) < 0)
-        goto exception;
-    p->u.array.count = len;
-
     i = 0;
-    pval = p->u.array.u.values;
-    if (js_get_fast_array(ctx, obj, &arrp, &count32) && count32 == len) {
-        for (; i < idx; i++, pval++)
-            *pval = js_dup(arrp[i]);
-        *pval = js_dup(argv[1]);
-        for (i++, pval++; i < len; i++, pval++)
-            *pval = js_dup(arrp[i]);
+    if (js_get_fast_array(ctx, obj, &p1, &count32) && count32 == len) {
+        /* the new array is empty: its element kind can be set directly */
+        p->u.array.kind = max_int(p1->u.array.kind,
+                                  js_array_value_kind(argv[1]));
+        if (expand_fast_array(ctx, p, len) < 0)
+            goto exception;
+        for (; i < idx; i++)
+            js_array_append(ctx, p, js_array_get(p1, i));
+        js_array_append(ctx, p, js_dup(argv[1]));
+        for (i++; i < len; i++)
+            js_array_append(ctx, p, js_array_get(p1, i));
     } else {
+        p->u.array.kind = JS_ARRAY_KIND_VALUE;
+        if (expand_fast_array(ctx, p, len) < 0)
+            goto exception;
+        p->u.array.count = len;
+        pval = p->u.array.u.values;
         for (; i < idx; i++, pval++)
             if (-1 == JS_TryGetPropertyInt64(ctx, obj, i, pval))
                 goto fill_and_fail;
@@ -41817,7 +43393,9 @@ static JSValue js_array_fill(JSContext *ctx, JSValueConst this_val,
                              int argc, JSValueConst *argv)
 {
     JSValue obj;
+    JSObject *p;
     int64_t len, start, end;
+    uint32_t count32;
 
     obj = JS_ToObject(ctx, this_val);
     if (js_get_length64(ctx, &len, obj))
@@ -41835,7 +43413,13 @@ static JSValue js_array_fill(JSContext *ctx, JSValueConst this_val,
             goto exception;
     }
 
-    /* XXX: should special case fast arrays */
+    if (js_get_fast_array(ctx, obj, &p, &count32) && end <= count32) {
+        /* the element kind is widened by the first store */
+        for (; start < end; start++) {
+            if (js_array_set(ctx, p, start, js_dup(argv[0])))
+                goto exception;
+        }
+    }
     while (start < end) {
         if (JS_SetPropertyInt64(ctx, obj, start, js_dup(argv[0])) < 0)
             goto exception;
@@ -41848,11 +43432,65 @@ static JSValue js_array_fill(JSContext *ctx, JSValueConst this_val,
     return JS_EXCEPTION;
 }
 
+/* Search the number 'val' in the elements n to end - step of the fast
+   array 'p' without the generic comparison. Return the index of the
+   first match or 'end'. */
+static int64_t js_array_find_number(JSObject *p, int64_t n,
+                                    int64_t end, int step, JSValueConst val,
+                                    bool same_value_zero)
+{
+    const JSValue *arrp;
+    double d, e;
+    int tag;
+
+    if (JS_VALUE_GET_TAG(val) == JS_TAG_INT)
+        d = JS_VALUE_GET_INT(val);
+    else
+        d = JS_VALUE_GET_FLOAT64(val);
+    switch(p->u.array.kind) {
+    case JS_ARRAY_KIND_INT32:
+        {
+            const int32_t *tab = p->u.array.u.int32_ptr;
+            for (; n != end; n += step) {
+                if (tab[n] == d)
+                    break;
+            }
+        }
+        break;
+    case JS_ARRAY_KIND_FLOAT64:
+        {
+            const double *tab = p->u.array.u.double_ptr;
+            for (; n != end; n += step) {
+                e = tab[n];
+                if (e == d || (same_value_zero && isnan(e) && isnan(d)))
+                    break;
+            }
+        }
+        break;
+    default:
+        arrp = p->u.array.u.values;
+        for (; n != end; n += step) {
+            tag = JS_VALUE_GET_NORM_TAG(arrp[n]);
+            if (tag == JS_TAG_INT) {
+                if (JS_VALUE_GET_INT(arrp[n]) == d)
+                    break;
+            } else if (tag == JS_TAG_FLOAT64) {
+                e = JS_VALUE_GET_FLOAT64(arrp[n]);
+                if (e == d || (same_value_zero && isnan(e) && isnan(d)))
+                    break;
+            }
+        }
+        break;
+    }
+    return n;
+}
+
 static JSValue js_array_includes(JSContext *ctx, JSValueConst this_val,
                                  int argc, JSValueConst *argv)
 {
     JSValue obj, val;
     int64_t len, n;
+    JSObject *p;
     JSValue *arrp;
     uint32_t count;
     int res;
@@ -41868,12 +43506,22 @@ static JSValue js_array_includes(JSContext *ctx, JSValueConst this_val,
             if (JS_ToInt64Clamp(ctx, &n, argv[1], 0, len, len))
                 goto exception;
         }
-        if (js_get_fast_array(ctx, obj, &arrp, &count)) {
-            for (; n < count; n++) {
-                if (js_strict_eq2(ctx, js_dup(argv[0]), js_dup(arrp[n]),
-                                  JS_EQ_SAME_VALUE_ZERO)) {
+        if (js_get_fast_array(ctx, obj, &p, &count) && n < count) {
+            if (JS_IsNumber(argv[0])) {
+                n = js_array_find_number(p, n, count, 1, argv[0], true);
+                if (n < count)
                     goto done;
+            } else if (p->u.array.kind == JS_ARRAY_KIND_VALUE) {
+                arrp = p->u.array.u.values;
+                for (; n < count; n++) {
+                    if (js_strict_eq2(ctx, js_dup(argv[0]), js_dup(arrp[n]),
+                                      JS_EQ_SAME_VALUE_ZERO)) {
+                        goto done;
+                    }
                 }
+            } else {
+                /* the unboxed elements are all numbers */
+                n = count;
             }
         }
         for (; n < len; n++) {
@@ -41901,6 +43549,7 @@ static JSValue js_array_indexOf(JSContext *ctx, JSValueConst this_val,
 {
     JSValue obj, val;
     int64_t len, n;
+    JSObject *p;
     JSValue *arrp;
     uint32_t count;
 
@@ -41914,12 +43563,22 @@ static JSValue js_array_indexOf(JSContext *ctx, JSValueConst this_val,
             if (JS_ToInt64Clamp(ctx, &n, argv[1], 0, len, len))
                 goto exception;
         }
-        if (js_get_fast_array(ctx, obj, &arrp, &count)) {
-            for (; n < count; n++) {
-                if (js_strict_eq2(ctx, js_dup(argv[0]), js_dup(arrp[n]),
-                                  JS_EQ_STRICT)) {
+        if (js_get_fast_array(ctx, obj, &p, &count) && n < count) {
+            if (JS_IsNumber(argv[0])) {
+                n = js_array_find_number(p, n, count, 1, argv[0], false);
+                if (n < count)
                     goto done;
+            } else if (p->u.array.kind == JS_ARRAY_KIND_VALUE) {
+                arrp = p->u.array.u.values;
+                for (; n < count; n++) {
+                    if (js_strict_eq2(ctx, js_dup(argv[0]), js_dup(arrp[n]),
+                                      JS_EQ_STRICT)) {
+                        goto done;
+                    }
                 }
+            } else {
+                /* the unboxed elements are all numbers */
+                n = count;
             }
         }
         for (; n < len; n++) {
@@ -41948,6 +43607,7 @@ static JSValue js_array_lastIndexOf(JSContext *ctx, JSValueConst this_val,
 {
     JSValue obj, val;
     int64_t len, n;
+    JSObject *p;
     JSValue *arrp;
     uint32_t count;
 
@@ -41961,12 +43621,22 @@ static JSValue js_array_lastIndexOf(JSContext *ctx, JSValueConst this_val,
             if (JS_ToInt64Clamp(ctx, &n, argv[1], -1, len - 1, len))
                 goto exception;
         }
-        if (js_get_fast_array(ctx, obj, &arrp, &count) && count == len) {
-            for (; n >= 0; n--) {
-                if (js_strict_eq2(ctx, js_dup(argv[0]), js_dup(arrp[n]),
-                                  JS_EQ_STRICT)) {
+        if (js_get_fast_array(ctx, obj, &p, &count) && count == len) {
+            if (JS_IsNumber(argv[0])) {
+                n = js_array_find_number(p, n, -1, -1, argv[0], false);
+                if (n >= 0)
                     goto done;
+            } else if (p->u.array.kind == JS_ARRAY_KIND_VALUE) {
+                arrp = p->u.array.u.values;
+                for (; n >= 0; n--) {
+                    if (js_strict_eq2(ctx, js_dup(argv[0]), js_dup(arrp[n]),
+                                      JS_EQ_STRICT)) {
+                        goto done;
+                    }
                 }
+            } else {
+                /* the unboxed elements are all numbers */
+                n = -1;
             }
         }
         for (; n >= 0; n--) {
@@ -42153,8 +43823,8 @@ static JSValue js_array_pop(JSContext *ctx, JSValueConst this_val,
 {
     JSValue obj, res = JS_UNDEFINED;
     int64_t len, newLen;
-    JSValue *arrp;
-    uint32_t count32;
+    JSObject *p;
+    uint32_t count32, idx;
 
     obj = JS_ToObject(ctx, this_val);
     if (js_get_length64(ctx, &len, obj))
@@ -42163,16 +43833,19 @@ static JSValue js_array_pop(JSContext *ctx, JSValueConst this_val,
     if (len > 0) {
         newLen = len - 1;
         /* Special case fast arrays */
-        if (js_get_fast_array(ctx, obj, &arrp, &count32) && count32 == len) {
-            JSObject *p = JS_VALUE_GET_OBJ(obj);
+        if (js_get_fast_array(ctx, obj, &p, &count32) && count32 == len) {
+            idx = shift ? 0 : count32 - 1;
+            /* a boxed element is moved to 'res' without duplication */
+            if (p->u.array.kind == JS_ARRAY_KIND_VALUE)
+                res = p->u.array.u.values[idx];
+            else
+                res = js_array_get(p, idx);
             if (shift) {
-                res = arrp[0];
-                memmove(arrp, arrp + 1, (count32 - 1) * sizeof(*arrp));
-                p->u.array.count--;
-            } else {
-                res = arrp[count32 - 1];
-                p->u.array.count--;
+                size_t elt_size = js_array_kind_size(p->u.array.kind);
+                uint8_t *tab = p->u.array.u.ptr;
+                memmove(tab, tab + elt_size, (count32 - 1) * elt_size);
             }
+            p->u.array.count--;
         } else {
             if (shift) {
                 res = JS_GetPropertyInt64(ctx, obj, 0);
@@ -42221,15 +43894,20 @@ static JSValue js_array_push(JSContext *ctx, JSValueConst this_val,
                        (get_shape_prop(p->shape)->flags & JS_PROP_WRITABLE))) {
                 array_len = JS_VALUE_GET_INT(p->prop[0].u.value);
                 new_len = array_len + argc;
-                if (likely(new_len >= array_len)) { /* no overflow */
+                /* the elements are appended after the last one, which
+                   is only correct if there are no holes before */
+                if (likely(new_len >= array_len && /* no overflow */
+                           p->u.array.count == array_len)) {
                     if (unlikely(new_len > p->u.array.u1.size)) {
                         if (expand_fast_array(ctx, p, new_len))
                             return JS_EXCEPTION;
                     }
                     for(i = 0; i < argc; i++) {
-                        p->u.array.u.values[array_len + i] = js_dup(argv[i]);
+                        if (js_array_append(ctx, p, js_dup(argv[i]))) {
+                            p->prop[0].u.value = js_int32(p->u.array.count);
+                            return JS_EXCEPTION;
+                        }
                     }
-                    p->u.array.count = new_len;
                     p->prop[0].u.value = js_int32(new_len);
                     return js_int32(new_len);
                 }
@@ -42270,7 +43948,7 @@ static JSValue js_array_reverse(JSContext *ctx, JSValueConst this_val,
                                 int argc, JSValueConst *argv)
 {
     JSValue obj, lval, hval;
-    JSValue *arrp;
+    JSObject *p;
     int64_t len, l, h;
     int l_present, h_present;
     uint32_t count32;
@@ -42281,14 +43959,41 @@ static JSValue js_array_reverse(JSContext *ctx, JSValueConst this_val,
         goto exception;
 
     /* Special case fast arrays */
-    if (js_get_fast_array(ctx, obj, &arrp, &count32) && count32 == len) {
+    if (js_get_fast_array(ctx, obj, &p, &count32) && count32 == len) {
         uint32_t ll, hh;
 
         if (count32 > 1) {
-            for (ll = 0, hh = count32 - 1; ll < hh; ll++, hh--) {
-                lval = arrp[ll];
-                arrp[ll] = arrp[hh];
-                arrp[hh] = lval;
+            switch(p->u.array.kind) {
+            case JS_ARRAY_KIND_INT32:
+                {
+                    int32_t *tab = p->u.array.u.int32_ptr, v;
+                    for (ll = 0, hh = count32 - 1; ll < hh; ll++, hh--) {
+                        v = tab[ll];
+                        tab[ll] = tab[hh];
+                        tab[hh] = v;
+                    }
+                }
+                break;
+            case JS_ARRAY_KIND_FLOAT64:
+                {
+                    double *tab = p->u.array.u.double_ptr, v;
+                    for (ll = 0, hh = count32 - 1; ll < hh; ll++, hh--) {
+                        v = tab[ll];
+                        tab[ll] = tab[hh];
+                        tab[hh] = v;
+                    }
+                }
+                break;
+            default:
+                {
+                    JSValue *arrp = p->u.array.u.values;
+                    for (ll = 0, hh = count32 - 1; ll < hh; ll++, hh--) {
+                        lval = arrp[ll];
+                        arrp[ll] = arrp[hh];
+                        arrp[hh] = lval;
+                    }
+                }
+                break;
             }
         }
         return obj;
@@ -42342,8 +44047,8 @@ static JSValue js_array_reverse(JSContext *ctx, JSValueConst this_val,
 static JSValue js_array_toReversed(JSContext *ctx, JSValueConst this_val,
                                    int argc, JSValueConst *argv)
 {
-    JSValue arr, obj, ret, *arrp, *pval;
-    JSObject *p;
+    JSValue arr, obj, ret, *pval;
+    JSObject *p, *p1;
     int64_t i, len;
     uint32_t count32;
 
@@ -42364,16 +44069,20 @@ static JSValue js_array_toReversed(JSContext *ctx, JSValueConst this_val,
 
     if (len > 0) {
         p = JS_VALUE_GET_OBJ(arr);
-        if (expand_fast_array(ctx, p, len) < 0)
-            goto exception;
-        p->u.array.count = len;
-
         i = len - 1;
-        pval = p->u.array.u.values;
-        if (js_get_fast_array(ctx, obj, &arrp, &count32) && count32 == len) {
-            for (; i >= 0; i--, pval++)
-                *pval = js_dup(arrp[i]);
+        if (js_get_fast_array(ctx, obj, &p1, &count32) && count32 == len) {
+            /* the new array is empty: its element kind can be set directly */
+            p->u.array.kind = p1->u.array.kind;
+            if (expand_fast_array(ctx, p, len) < 0)
+                goto exception;
+            for (; i >= 0; i--)
+                js_array_append(ctx, p, js_array_get(p1, i));
         } else {
+            p->u.array.kind = JS_ARRAY_KIND_VALUE;
+            if (expand_fast_array(ctx, p, len) < 0)
+                goto exception;
+            p->u.array.count = len;
+            pval = p->u.array.u.values;
             // Query order is observable; test262 expects descending order.
             for (; i >= 0; i--, pval++) {
                 if (-1 == JS_TryGetPropertyInt64(ctx, obj, i, pval)) {
@@ -42404,7 +44113,7 @@ static JSValue js_array_slice(JSContext *ctx, JSValueConst this_val,
     JSValue obj, arr, val, len_val;
     int64_t len, start, k, final, n, count, del_count, new_len;
     int kPresent;
-    JSValue *arrp;
+    JSObject *p;
     uint32_t count32, i, item_count;
 
     arr = JS_UNDEFINED;
@@ -42454,11 +44163,11 @@ static JSValue js_array_slice(JSContext *ctx, JSValueConst this_val,
        JS_CreateDataPropertyUint32() won't modify obj in case arr is
        an exotic object */
     /* Special case fast arrays */
-    if (js_get_fast_array(ctx, obj, &arrp, &count32) &&
+    if (js_get_fast_array(ctx, obj, &p, &count32) &&
         js_is_fast_array(ctx, arr)) {
         /* XXX: should share code with fast array constructor */
         for (; k < final && k < count32; k++, n++) {
-            if (JS_CreateDataPropertyUint32(ctx, arr, n, js_dup(arrp[k]), JS_PROP_THROW) < 0)
+            if (JS_CreateDataPropertyUint32(ctx, arr, n, js_array_get(p, k), JS_PROP_THROW) < 0)
                 goto exception;
         }
     }
@@ -42507,8 +44216,9 @@ static JSValue js_array_slice(JSContext *ctx, JSValueConst this_val,
 static JSValue js_array_toSpliced(JSContext *ctx, JSValueConst this_val,
                                   int argc, JSValueConst *argv)
 {
-    JSValue arr, obj, ret, *arrp, *pval, *last;
-    JSObject *p;
+    JSValue arr, obj, ret, *pval, *last;
+    JSObject *p, *p1;
+    JSArrayKindEnum kind;
     int64_t i, j, len, newlen, start, add, del;
     uint32_t count32;
 
@@ -42556,21 +44266,28 @@ static JSValue js_array_toSpliced(JSContext *ctx, JSValueConst this_val,
         goto done;
 
     p = JS_VALUE_GET_OBJ(arr);
-    if (expand_fast_array(ctx, p, newlen) < 0)
-        goto exception;
-
-    p->u.array.count = newlen;
-    pval = &p->u.array.u.values[0];
-    last = &p->u.array.u.values[newlen];
+    if (js_get_fast_array(ctx, obj, &p1, &count32) && count32 == len) {
+        /* the new array is empty: its element kind can be set directly */
+        kind = p1->u.array.kind;
+        for (j = 0; j < add; j++)
+            kind = max_int(kind, js_array_value_kind(argv[2 + j]));
+        p->u.array.kind = kind;
+        if (expand_fast_array(ctx, p, newlen) < 0)
+            goto exception;
+        for (i = 0; i < start; i++)
+            js_array_append(ctx, p, js_array_get(p1, i));
+        for (j = 0; j < add; j++)
+            js_array_append(ctx, p, js_dup(argv[2 + j]));
+        for (i += del; i < len; i++)
+            js_array_append(ctx, p, js_array_get(p1, i));
+    } else {
+        p->u.array.kind = JS_ARRAY_KIND_VALUE;
+        if (expand_fast_array(ctx, p, newlen) < 0)
+            goto exception;
+        p->u.array.count = newlen;
+        pval = &p->u.array.u.values[0];
+        last = &p->u.array.u.values[newlen];
 
-    if (js_get_fast_array(ctx, obj, &arrp, &count32) && count32 == len) {
-        for (i = 0; i < start; i++, pval++)
-            *pval = js_dup(arrp[i]);
-        for (j = 0; j < add; j++, pval++)
-            *pval = js_dup(argv[2 + j]);
-        for (i += del; i < len; i++, pval++)
-            *pval = js_dup(arrp[i]);
-    } else {
         for (i = 0; i < start; i++, pval++)
             if (-1 == JS_TryGetPropertyInt64(ctx, obj, i, pval))
                 goto exception;
@@ -42579,10 +44296,9 @@ static JSValue js_array_toSpliced(JSContext *ctx, JSValueConst this_val,
         for (i += del; i < len; i++, pval++)
             if (-1 == JS_TryGetPropertyInt64(ctx, obj, i, pval))
                 goto exception;
+        assert(pval == last);
     }
 
-    assert(pval == last);
-
     if (JS_SetProperty(ctx, arr, JS_ATOM_length, js_int64(newlen)) < 0)
         goto exception;
 
@@ -42911,8 +44627,8 @@ fail:
 static JSValue js_array_toSorted(JSContext *ctx, JSValueConst this_val,
                                  int argc, JSValueConst *argv)
 {
-    JSValue arr, obj, ret, *arrp, *pval;
-    JSObject *p;
+    JSValue arr, obj, ret, *pval;
+    JSObject *p, *p1;
     int64_t i, len;
     uint32_t count32;
 
@@ -42937,16 +44653,20 @@ static JSValue js_array_toSorted(JSContext *ctx, JSValueConst this_val,
 
     if (len > 0) {
         p = JS_VALUE_GET_OBJ(arr);
-        if (expand_fast_array(ctx, p, len) < 0)
-            goto exception;
-        p->u.array.count = len;
-
         i = 0;
-        pval = p->u.array.u.values;
-        if (js_get_fast_array(ctx, obj, &arrp, &count32) && count32 == len) {
-            for (; i < len; i++, pval++)
-                *pval = js_dup(arrp[i]);
+        if (js_get_fast_array(ctx, obj, &p1, &count32) && count32 == len) {
+            /* the new array is empty: its element kind can be set directly */
+            p->u.array.kind = p1->u.array.kind;
+            if (expand_fast_array(ctx, p, len) < 0)
+                goto exception;
+            for (; i < len; i++)
+                js_array_append(ctx, p, js_array_get(p1, i));
         } else {
+            p->u.array.kind = JS_ARRAY_KIND_VALUE;
+            if (expand_fast_array(ctx, p, len) < 0)
+                goto exception;
+            p->u.array.count = len;
+            pval = p->u.array.u.values;
             for (; i < len; i++, pval++) {
                 if (-1 == JS_TryGetPropertyInt64(ctx, obj, i, pval)) {
                     for (; i < len; i++, pval++)
@@ -43004,6 +44724,7 @@ static JSValue js_create_array(JSContext *ctx, int len, JSValueConst *tab)
 {
     JSValue obj;
     JSObject *p;
+    JSArrayKindEnum kind;
     int i;
 
     obj = JS_NewArray(ctx);
@@ -43011,13 +44732,17 @@ static JSValue js_create_array(JSContext *ctx, int len, JSValueConst *tab)
         return JS_EXCEPTION;
     if (len > 0) {
         p = JS_VALUE_GET_OBJ(obj);
+        /* the array is empty: its element kind can be set directly */
+        kind = JS_ARRAY_KIND_INT32;
+        for(i = 0; i < len; i++)
+            kind = max_int(kind, js_array_value_kind(tab[i]));
+        p->u.array.kind = kind;
         if (expand_fast_array(ctx, p, len) < 0) {
             JS_FreeValue(ctx, obj);
             return JS_EXCEPTION;
         }
-        p->u.array.count = len;
         for(i = 0; i < len; i++)
-            p->u.array.u.values[i] = js_dup(tab[i]);
+            js_array_append(ctx, p, js_dup(tab[i]));
         /* update the 'length' field */
         set_value(ctx, &p->prop[0].u.value, js_int32(len));
     }
@@ -43076,7 +44801,11 @@ static JSValue js_array_iterator_next(JSContext *ctx, JSValueConst this_val,
     if (JS_IsUndefined(it->obj))
         goto done;
     p = JS_VALUE_GET_OBJ(it->obj);
-    if (is_typed_array(p->class_id)) {
+    if (p->class_id == JS_CLASS_ARRAY && p->fast_array &&
+        it->idx < p->u.array.count) {
+        /* the length of an array is at least its element count */
+        len = p->u.array.count;
+    } else if (is_typed_array(p->class_id)) {
         if (typed_array_is_oob(p)) {
             JS_ThrowTypeErrorArrayBufferOOB(ctx);
             goto fail1;
@@ -43102,9 +44831,14 @@ static JSValue js_array_iterator_next(JSContext *ctx, JSValueConst this_val,
     if (it->kind == JS_ITERATOR_KIND_KEY) {
         return js_uint32(idx);
     } else {
-        val = JS_GetPropertyUint32(ctx, it->obj, idx);
-        if (JS_IsException(val))
-            return JS_EXCEPTION;
+        if (p->class_id == JS_CLASS_ARRAY && p->fast_array &&
+            idx < p->u.array.count) {
+            val = js_array_get(p, idx);
+        } else {
+            val = JS_GetPropertyUint32(ctx, it->obj, idx);
+            if (JS_IsException(val))
+                return JS_EXCEPTION;
+        }
         if (it->kind == JS_ITERATOR_KIND_VALUE) {
             return val;
         } else {
@@ -43121,6 +44855,37 @@ static JSValue js_array_iterator_next(JSContext *ctx, JSValueConst this_val,
     }
 }
 
+/* Used by for-of and destructuring: if 'enum_obj' iterates over the
+   values of a fast array and 'method' is the built-in next method,
+   read the next element directly and return true. Otherwise return
+   false and leave the iteration to js_array_iterator_next(). */
+static bool js_array_iterator_next_fast(JSValueConst enum_obj,
+                                        JSValueConst method, JSValue *pval)
+{
+    JSArrayIteratorData *it;
+    JSObject *p;
+
+    if (JS_VALUE_GET_TAG(method) != JS_TAG_OBJECT ||
+        JS_VALUE_GET_TAG(enum_obj) != JS_TAG_OBJECT)
+        return false;
+    p = JS_VALUE_GET_OBJ(method);
+    if (p->class_id != JS_CLASS_C_FUNCTION ||
+        p->u.cfunc.c_function.iterator_next != js_array_iterator_next)
+        return false;
+    p = JS_VALUE_GET_OBJ(enum_obj);
+    if (p->class_id != JS_CLASS_ARRAY_ITERATOR)
+        return false;
+    it = p->u.array_iterator_data;
+    if (it->kind != JS_ITERATOR_KIND_VALUE || JS_IsUndefined(it->obj))
+        return false;
+    p = JS_VALUE_GET_OBJ(it->obj);
+    if (p->class_id != JS_CLASS_ARRAY || !p->fast_array ||
+        it->idx >= p->u.array.count)
+        return false;
+    *pval = js_array_get(p, it->idx++);
+    return true;
+}
+
 typedef struct JSIteratorWrapData {
     JSValue wrapped_iter;
     JSValue wrapped_next;
@@ -46813,7 +48578,9 @@ static const JSCFunctionListEntry js_math_obj[] = {
 
 /* OS dependent. d = argv[0] is in ms from 1970. Return the difference
    between UTC time and local time 'd' in minutes */
-static int getTimezoneOffset(int64_t time) {
+/* Uncached lookup, getTimezoneOffset() only falls back to it if the zone
+   could not be parsed into a transition table */
+static int getTimezoneOffsetUncached(int64_t time) {
 #if defined(_WIN32)
     DWORD r;
     TIME_ZONE_INFORMATION t;
@@ -52050,13 +53817,44 @@ bool JS_IsPromise(JSValueConst val)
 static int js_create_resolving_functions(JSContext *ctx, JSValue *args,
                                          JSValueConst promise);
 
+static JSPromiseReactionData *promise_reaction_data_alloc(JSContext *ctx)
+{
+    JSRuntime *rt = ctx->rt;
+    JSPromiseReactionData *rd;
+
+    if (!list_empty(&rt->promise_reaction_free_list)) {
+        rd = list_entry(rt->promise_reaction_free_list.next,
+                        JSPromiseReactionData, link);
+        list_del(&rd->link);
+        rt->promise_reaction_free_count--;
+        return rd;
+    }
+    return js_malloc(ctx, sizeof(*rd));
+}
+
 static void promise_reaction_data_free(JSRuntime *rt,
                                        JSPromiseReactionData *rd)
 {
     JS_FreeValueRT(rt, rd->resolving_funcs[0]);
     JS_FreeValueRT(rt, rd->resolving_funcs[1]);
     JS_FreeValueRT(rt, rd->handler);
-    js_free_rt(rt, rd);
+    if (rt->promise_reaction_free_count < JS_FREE_LIST_MAX_SIZE) {
+        list_add(&rd->link, &rt->promise_reaction_free_list);
+        rt->promise_reaction_free_count++;
+    } else {
+        js_free_rt(rt, rd);
+    }
+}
+
+static void js_promise_free_reaction_list(JSRuntime *rt)
+{
+    struct list_head *el, *el1;
+
+    list_for_each_safe(el, el1, &rt->promise_reaction_free_list) {
+        js_free_rt(rt, list_entry(el, JSPromiseReactionData, link));
+    }
+    init_list_head(&rt->promise_reaction_free_list);
+    rt->promise_reaction_free_count = 0;
 }
 
 #ifdef ENABLE_DUMPS // JS_DUMP_PROMISE
@@ -52911,7 +54709,7 @@ static __exception int perform_promise_then(JSContext *ctx,
     rd_array[1] = NULL;
     for(i = 0; i < 2; i++) {
         JSValueConst handler;
-        rd = js_mallocz(ctx, sizeof(*rd));
+        rd = promise_reaction_data_alloc(ctx);
         if (!rd) {
             if (i == 1)
                 promise_reaction_data_free(ctx->rt, rd_array[0]);
@@ -53791,6 +55589,436 @@ static int const month_days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
 static char const month_names[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
 static char const day_names[] = "SunMonTueWedThuFriSat";
 
+#if !defined(_WIN32)
+/* Local time offsets are answered from the transitions of the TZif file of
+   the current zone, parsed once into a sorted table. Times after the last
+   transition follow the POSIX TZ rule in the file footer (or in the TZ
+   variable itself). Zones that cannot be parsed fall back to localtime_r().
+   The table is only rebuilt after JS_InvalidateTimezoneCache(). It is shared
+   by all runtimes and therefore uses the system allocator. */
+
+typedef struct JSTimezoneRule {
+    char kind;      /* 'J' (1-365, no leap day), 'D' (0-365) or 'M' */
+    int month;
+    int week;
+    int day;        /* day of year for 'J' and 'D', day of week for 'M' */
+    int32_t time;   /* seconds after local midnight */
+} JSTimezoneRule;
+
+typedef struct JSTimezone {
+    bool fallback;
+    int count;
+    int64_t *times;         /* transition times in UTC seconds, ascending */
+    int32_t *offsets;       /* UTC offset in seconds from times[i] on */
+    int32_t initial_offset; /* UTC offset before the first transition */
+    bool has_rule;
+    bool has_dst;
+    int32_t std_offset;
+    int32_t dst_offset;
+    JSTimezoneRule start;
+    JSTimezoneRule end;
+} JSTimezone;
+
+static JSTimezone *js_timezone;
+
+#if JS_HAVE_THREADS
+static js_once_t js_timezone_once = JS_ONCE_INIT;
+static js_mutex_t js_timezone_mutex;
+
+static void js_timezone_init(void)
+{
+    js_mutex_init(&js_timezone_mutex);
+}
+
+static void js_timezone_lock(void)
+{
+    js_once(&js_timezone_once, js_timezone_init);
+    js_mutex_lock(&js_timezone_mutex);
+}
+
+static void js_timezone_unlock(void)
+{
+    js_mutex_unlock(&js_timezone_mutex);
+}
+#else
+static void js_timezone_lock(void) {}
+static void js_timezone_unlock(void) {}
+#endif
+
+static void js_timezone_free(JSTimezone *tz)
+{
+    if (tz) {
+        js_def_free(NULL, tz->times);
+        js_def_free(NULL, tz->offsets);
+        js_def_free(NULL, tz);
+    }
+}
+
+static const char *tz_parse_name(const char *p)
+{
+    const char *start;
+
+    if (*p == '<') {
+        while (*p && *p != '>')
+            p++;
+        return *p == '>' ? p + 1 : NULL;
+    }
+    start = p;
+    while ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z'))
+        p++;
+    return p - start >= 3 ? p : NULL;
+}
+
+static const char *tz_parse_number(const char *p, int *pval, int max)
+{
+    int val = 0;
+
+    if (!is_digit(*p))
+        return NULL;
+    while (is_digit(*p)) {
+        val = val * 10 + (*p++ - '0');
+        if (val > max)
+            return NULL;
+    }
+    *pval = val;
+    return p;
+}
+
+/* [+-]hh[:mm[:ss]], hours up to 167 as allowed by RFC 8536 */
+static const char *tz_parse_time(const char *p, int32_t *pval)
+{
+    int sign = 1, h, m = 0, sec = 0;
+
+    if (*p == '+' || *p == '-') {
+        if (*p == '-')
+            sign = -1;
+        p++;
+    }
+    p = tz_parse_number(p, &h, 167);
+    if (p && *p == ':') {
+        p = tz_parse_number(p + 1, &m, 59);
+        if (p && *p == ':')
+            p = tz_parse_number(p + 1, &sec, 59);
+    }
+    if (p)
+        *pval = sign * (h * 3600 + m * 60 + sec);
+    return p;
+}
+
+static const char *tz_parse_rule(const char *p, JSTimezoneRule *r)
+{
+    if (*p == 'J') {
+        r->kind = 'J';
+        p = tz_parse_number(p + 1, &r->day, 365);
+        if (p && r->day < 1)
+            return NULL;
+    } else if (*p == 'M') {
+        r->kind = 'M';
+        p = tz_parse_number(p + 1, &r->month, 12);
+        if (!p || *p != '.' || r->month < 1)
+            return NULL;
+        p = tz_parse_number(p + 1, &r->week, 5);
+        if (!p || *p != '.' || r->week < 1)
+            return NULL;
+        p = tz_parse_number(p + 1, &r->day, 6);
+    } else {
+        r->kind = 'D';
+        p = tz_parse_number(p, &r->day, 365);
+    }
+    r->time = 7200;
+    if (p && *p == '/')
+        p = tz_parse_time(p + 1, &r->time);
+    return p;
+}
+
+static bool tz_parse_posix(JSTimezone *tz, const char *p)
+{
+    int32_t offset;
+
+    p = tz_parse_name(p);
+    if (!p || !(p = tz_parse_time(p, &offset)))
+        return false;
+    /* POSIX offsets are positive west of Greenwich */
+    tz->std_offset = -offset;
+    tz->has_dst = false;
+    if (*p != '\0') {
+        p = tz_parse_name(p);
+        if (!p)
+            return false;
+        tz->has_dst = true;
+        tz->dst_offset = tz->std_offset + 3600;
+        if (*p != '\0' && *p != ',') {
+            if (!(p = tz_parse_time(p, &offset)))
+                return false;
+            tz->dst_offset = -offset;
+        }
+        if (*p == '\0') {
+            /* same default as glibc: M3.2.0,M11.1.0 */
+            tz->start = (JSTimezoneRule){ 'M', 3, 2, 0, 7200 };
+            tz->end = (JSTimezoneRule){ 'M', 11, 1, 0, 7200 };
+        } else {
+            if (*p != ',' || !(p = tz_parse_rule(p + 1, &tz->start)))
+                return false;
+            if (*p != ',' || !(p = tz_parse_rule(p + 1, &tz->end)))
+                return false;
+            if (*p != '\0')
+                return false;
+        }
+    }
+    tz->has_rule = true;
+    return true;
+}
+
+static int64_t tz_read_be(const uint8_t *p, int size)
+{
+    uint64_t v = 0;
+    int i;
+
+    for(i = 0; i < size; i++)
+        v = (v << 8) | p[i];
+    if (size == 4)
+        return (int32_t)v;
+    return (int64_t)v;
+}
+
+static bool tz_parse_tzif(JSTimezone *tz, const uint8_t *buf, size_t len)
+{
+    size_t pos, data_len, time_size, leap_size;
+    uint32_t isutcnt, isstdcnt, leapcnt, timecnt, typecnt, charcnt;
+    const uint8_t *times, *indices, *types;
+    int version, i;
+
+    if (len < 44 || memcmp(buf, "TZif", 4))
+        return false;
+    version = buf[4];
+    pos = 0;
+    time_size = 4;
+    leap_size = 8;
+    for(;;) {
+        isutcnt = tz_read_be(buf + pos + 20, 4);
+        isstdcnt = tz_read_be(buf + pos + 24, 4);
+        leapcnt = tz_read_be(buf + pos + 28, 4);
+        timecnt = tz_read_be(buf + pos + 32, 4);
+        typecnt = tz_read_be(buf + pos + 36, 4);
+        charcnt = tz_read_be(buf + pos + 40, 4);
+        if (timecnt > 65536 || typecnt > 256 || charcnt > 65536 ||
+            leapcnt > 65536 || isstdcnt > 256 || isutcnt > 256)
+            return false;
+        data_len = timecnt * (time_size + 1) + typecnt * 6 + charcnt +
+            leapcnt * leap_size + isstdcnt + isutcnt;
+        if (pos + 44 + data_len > len)
+            return false;
+        /* version 2+ files repeat the data with 64-bit times */
+        if (version < '2' || time_size == 8)
+            break;
+        pos += 44 + data_len;
+        if (pos + 44 > len || memcmp(buf + pos, "TZif", 4))
+            return false;
+        time_size = 8;
+        leap_size = 12;
+    }
+    /* leap second aware ("right/") zones use a different time scale */
+    if (leapcnt != 0 || typecnt == 0)
+        return false;
+
+    times = buf + pos + 44;
+    indices = times + timecnt * time_size;
+    types = indices + timecnt;
+
+    tz->initial_offset = tz_read_be(types, 4);
+    if (timecnt > 0) {
+        tz->times = js_def_malloc(NULL, sizeof(tz->times[0]) * timecnt);
+        tz->offsets = js_def_malloc(NULL, sizeof(tz->offsets[0]) * timecnt);
+        if (!tz->times || !tz->offsets)
+            return false;
+    }
+    for(i = 0; i < timecnt; i++) {
+        if (indices[i] >= typecnt)
+            return false;
+        tz->times[i] = tz_read_be(times + i * time_size, time_size);
+        tz->offsets[i] = tz_read_be(types + indices[i] * 6, 4);
+        if (i > 0 && tz->times[i] <= tz->times[i - 1])
+            return false;
+    }
+    tz->count = timecnt;
+
+    /* the footer holds the rule for times after the last transition */
+    pos += 44 + data_len;
+    if (time_size == 8 && pos < len && buf[pos] == '\n') {
+        char footer[128];
+        size_t end = pos + 1;
+        while (end < len && buf[end] != '\n')
+            end++;
+        if (end < len && end > pos + 1 && end - pos - 1 < sizeof(footer)) {
+            memcpy(footer, buf + pos + 1, end - pos - 1);
+            footer[end - pos - 1] = '\0';
+            if (!tz_parse_posix(tz, footer))
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool tz_load_file(JSTimezone *tz, const char *path)
+{
+    uint8_t *buf;
+    size_t len;
+    bool ret;
+    FILE *f;
+
+    f = fopen(path, "rb");
+    if (!f)
+        return false;
+    buf = js_def_malloc(NULL, 1 << 20);
+    if (!buf) {
+        fclose(f);
+        return false;
+    }
+    len = fread(buf, 1, 1 << 20, f);
+    fclose(f);
+    ret = tz_parse_tzif(tz, buf, len);
+    js_def_free(NULL, buf);
+    return ret;
+}
+
+static JSTimezone *js_timezone_load(void)
+{
+    char path[JS__PATH_MAX];
+    const char *name, *dir;
+    JSTimezone *tz;
+    bool ok;
+
+    tz = js_def_calloc(NULL, 1, sizeof(*tz));
+    if (!tz)
+        return NULL;
+    name = getenv("TZ");
+    if (!name) {
+        ok = tz_load_file(tz, "/etc/localtime");
+    } else {
+        if (*name == ':')
+            name++;
+        if (*name == '\0') {
+            name = "UTC0";
+            ok = false;
+        } else if (*name == '/') {
+            ok = tz_load_file(tz, name);
+        } else {
+            dir = getenv("TZDIR");
+            ok = !strstr(name, "..") &&
+                snprintf(path, sizeof(path), "%s/%s", dir ? dir : "/usr/share/zoneinfo", name) < sizeof(path) &&
+                tz_load_file(tz, path);
+        }
+        if (!ok) {
+            js_def_free(NULL, tz->times);
+            js_def_free(NULL, tz->offsets);
+            memset(tz, 0, sizeof(*tz));
+            ok = tz_parse_posix(tz, name);
+        }
+    }
+    tz->fallback = !ok;
+    return tz;
+}
+
+/* return the day number of a rule in the given year, counted from 1970 */
+static int64_t tz_rule_day(const JSTimezoneRule *r, int64_t year)
+{
+    int64_t day, first;
+    int i, leap, month_len;
+
+    day = days_from_year(year);
+    leap = days_in_year(year) - 365;
+    switch(r->kind) {
+    case 'J':
+        return day + r->day - 1 + (leap && r->day >= 60);
+    case 'D':
+        return day + r->day;
+    default:
+        first = day;
+        for(i = 0; i < r->month - 1; i++)
+            first += month_days[i] + (i == 1 ? leap : 0);
+        month_len = month_days[r->month - 1] + (r->month == 2 ? leap : 0);
+        day = first + math_mod(r->day - math_mod(first + 4, 7), 7) + (r->week - 1) * 7;
+        /* week 5 means the last such day of the month */
+        if (day >= first + month_len)
+            day -= 7;
+        return day;
+    }
+}
+
+static int32_t tz_rule_offset(const JSTimezone *tz, int64_t t)
+{
+    int64_t days, year, start, end;
+
+    if (!tz->has_dst)
+        return tz->std_offset;
+    days = floor_div_int64(t + tz->std_offset, 86400);
+    year = year_from_days(&days);
+    /* like glibc, earlier times use the transitions of 1970 */
+    if (year < 1970)
+        year = 1970;
+    /* the start is given in standard time, the end in daylight time */
+    start = tz_rule_day(&tz->start, year) * 86400 + tz->start.time - tz->std_offset;
+    end = tz_rule_day(&tz->end, year) * 86400 + tz->end.time - tz->dst_offset;
+    if (start < end)
+        return t >= start && t < end ? tz->dst_offset : tz->std_offset;
+    /* southern hemisphere, daylight time spans the turn of the year */
+    return t >= end && t < start ? tz->std_offset : tz->dst_offset;
+}
+
+static int32_t js_timezone_offset(const JSTimezone *tz, int64_t t)
+{
+    int lo, hi, mid;
+
+    if (tz->count == 0)
+        return tz->has_rule ? tz_rule_offset(tz, t) : tz->initial_offset;
+    if (t < tz->times[0])
+        return tz->initial_offset;
+    if (t >= tz->times[tz->count - 1] && tz->has_rule)
+        return tz_rule_offset(tz, t);
+    /* find the last transition at or before t */
+    lo = 0;
+    hi = tz->count - 1;
+    while (lo < hi) {
+        mid = (lo + hi + 1) >> 1;
+        if (tz->times[mid] <= t)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    return tz->offsets[lo];
+}
+#endif /* !_WIN32 */
+
+void JS_InvalidateTimezoneCache(void)
+{
+#if !defined(_WIN32)
+    js_timezone_lock();
+    js_timezone_free(js_timezone);
+    js_timezone = NULL;
+    js_timezone_unlock();
+#endif
+}
+
+/* return the local time offset in minutes west of UTC, like
+   Date.prototype.getTimezoneOffset() */
+static int getTimezoneOffset(int64_t time)
+{
+#if !defined(_WIN32)
+    int offset;
+
+    js_timezone_lock();
+    if (!js_timezone)
+        js_timezone = js_timezone_load();
+    if (js_timezone && !js_timezone->fallback) {
+        offset = -js_timezone_offset(js_timezone, time / 1000) / 60;
+        js_timezone_unlock();
+        return offset;
+    }
+    js_timezone_unlock();
+#endif
+    return getTimezoneOffsetUncached(time);
+}
+
 static __exception int get_date_fields(JSContext *ctx, JSValueConst obj,
                                        double fields[minimum_length(9)],
                                        int is_local, int force)
@@ -955,6 +955,10 @@ JS_EXTERN JSValue JS_NewProxy(JSContext *ctx, JSValueConst target,
 JS_EXTERN JSValue JS_NewDate(JSContext *ctx, double epoch_ms);
 JS_EXTERN bool JS_IsDate(JSValueConst v);
 
+/* Date caches the transitions of the local time zone, call this after the
+   zone (TZ or /etc/localtime) changed */
+JS_EXTERN void JS_InvalidateTimezoneCache(void);
+
 JS_EXTERN JSValue JS_GetProperty(JSContext *ctx, JSValueConst this_obj, JSAtom prop);
 JS_EXTERN JSValue JS_GetPropertyUint32(JSContext *ctx, JSValueConst this_obj,
                                        uint32_t idx);
@@ -2,10 +2,59 @@
 
 #include <stdlib.h>
 
+#define YAJE_TRACE_MAX_MARKS 256
+
 typedef struct {
     JSValue native_map;
 } YajeContextData;
 
+typedef struct {
+    const char *label;
+    uint64_t time;
+} YajeTraceMark;
+
+// Startup trace, only recorded if YAJE_STARTUP_TRACE names an output file
+static struct {
+    int state;
+    const char *path;
+    size_t count;
+    YajeTraceMark marks[YAJE_TRACE_MAX_MARKS];
+} yaje_trace = { .state = -1 };
+
+void yaje_core_trace(const char *label) {
+    if (yaje_trace.state < 0) {
+        yaje_trace.path = getenv("YAJE_STARTUP_TRACE");
+        yaje_trace.state = yaje_trace.path != NULL && *yaje_trace.path != '\0';
+    }
+
+    if (!yaje_trace.state || yaje_trace.count >= YAJE_TRACE_MAX_MARKS) {
+        return;
+    }
+
+    yaje_trace.marks[yaje_trace.count].label = label;
+    yaje_trace.marks[yaje_trace.count].time = js__hrtime_ns();
+    yaje_trace.count++;
+}
+
+static void yaje_core_trace_flush(void) {
+    if (yaje_trace.state <= 0) {
+        return;
+    }
+
+    FILE *file = fopen(yaje_trace.path, "w");
+    if (!file) {
+        fprintf(stderr, "Could not write startup trace '%s'\n", yaje_trace.path);
+        return;
+    }
+
+    for (size_t i = 0; i < yaje_trace.count; i++) {
+        fprintf(file, "%s\t%" PRIu64 "\n", yaje_trace.marks[i].label, yaje_trace.marks[i].time);
+    }
+
+    fclose(file);
+    yaje_trace.count = 0;
+}
+
 void yaje_core_ctor(JSRuntime **rt, JSContext **ctx) {
     *rt = JS_NewRuntime();
     if (*rt == NULL) {
@@ -22,6 +71,8 @@ void yaje_core_ctor(JSRuntime **rt, JSContext **ctx) {
     YajeContextData *data = malloc(sizeof(YajeContextData));
     data->native_map = JS_UNDEFINED;
     JS_SetContextOpaque(*ctx, data);
+
+    yaje_core_trace("ctor");
 }
 
 static inline void print_exception(JSContext* ctx) {
@@ -49,13 +100,24 @@ static inline void print_exception(JSContext* ctx) {
 }
 
 int yaje_core_execute(JSRuntime *rt, JSContext *ctx) {
-    JSValue module = JS_Eval(ctx, (const char *)JS_BUNDLE_DATA, JS_BUNDLE_LENGTH, "<bundle>", JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+    JSValue module;
+    if (JS_BUNDLE_IS_BYTECODE) {
+        module = JS_ReadObject(ctx, JS_BUNDLE_DATA, JS_BUNDLE_LENGTH, JS_READ_OBJ_BYTECODE);
+        if (!JS_IsException(module) && JS_ResolveModule(ctx, module) < 0) {
+            JS_FreeValue(ctx, module);
+            module = JS_EXCEPTION;
+        }
+    } else {
+        module = JS_Eval(ctx, (const char *)JS_BUNDLE_DATA, JS_BUNDLE_LENGTH, "<bundle>", JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+    }
     if (JS_IsException(module)) {
         print_exception(ctx);
         JS_FreeValue(ctx, module);
         return 1;
     }
 
+    yaje_core_trace("compile");
+
     if (yaje_set_import_meta(ctx, module, false, true) < 0) {
         print_exception(ctx);
         JS_FreeValue(ctx, module);
@@ -69,10 +131,43 @@ int yaje_core_execute(JSRuntime *rt, JSContext *ctx) {
         return 1;
     }
 
+    yaje_core_trace("evaluate");
+
+    if (yaje_core_run_jobs(rt) < 0) {
+        JS_FreeValue(ctx, ret);
+        return 1;
+    }
+
+    yaje_core_trace("jobs");
+
+    // Module evaluation returns a promise, a top level rejection would otherwise be swallowed
+    if (JS_PromiseState(ctx, ret) == JS_PROMISE_REJECTED) {
+        JS_Throw(ctx, JS_PromiseResult(ctx, ret));
+        print_exception(ctx);
+        JS_FreeValue(ctx, ret);
+        return 1;
+    }
+
     JS_FreeValue(ctx, ret);
     return 0;
 }
 
+int yaje_core_run_jobs(JSRuntime *rt) {
+    JSContext *job_ctx;
+
+    while (true) {
+        int status = JS_ExecutePendingJob(rt, &job_ctx);
+        if (status == 0) {
+            return 0;
+        }
+
+        if (status < 0) {
+            print_exception(job_ctx);
+            return -1;
+        }
+    }
+}
+
 void yaje_core_free(JSRuntime **rt, JSContext **ctx) {
     if (*ctx != NULL) {
         YajeContextData *data = JS_GetContextOpaque(*ctx);
@@ -90,6 +185,9 @@ void yaje_core_free(JSRuntime **rt, JSContext **ctx) {
         JS_FreeRuntime(*rt);
         *rt = NULL;
     }
+
+    yaje_core_trace("free");
+    yaje_core_trace_flush();
 }
 
 JSValue yaje_core_get_native_map(JSContext *ctx) {
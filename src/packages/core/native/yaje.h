@@ -5,11 +5,17 @@
 
 extern size_t JS_BUNDLE_LENGTH;
 extern unsigned char JS_BUNDLE_DATA[];
+// Set by the generated entry point, true if JS_BUNDLE_DATA holds bytecode written by tools/compile.c instead of source
+extern const bool JS_BUNDLE_IS_BYTECODE;
+
+void yaje_core_trace(const char *label);
 
 void yaje_core_ctor(JSRuntime **rt, JSContext **ctx);
 
 int yaje_core_execute(JSRuntime *rt, JSContext *ctx);
 
+int yaje_core_run_jobs(JSRuntime *rt);
+
 void yaje_core_free(JSRuntime **rt, JSContext **ctx);
 
 JSValue yaje_core_get_native_map(JSContext *ctx);
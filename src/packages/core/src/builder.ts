@@ -42,11 +42,13 @@ export interface TargetTriple {
 export interface CFGResult {
     name: string;
     sources: string[];
+    sourceDirs: string[];
     libraryLookup: string[];
     includeDirs: string[];
     defineMacros: Record<string, string | number | true>;
     loadingFunctions: string[];
     linkLibraries: string[];
+    unityDir: string | null;
 }
 
 class Arch {
@@ -149,9 +151,11 @@ export class CFG {
     private readonly libraryLookup: Set<string> = new Set<string>();
     private readonly linkLibraries: Set<string> = new Set<string>();
     private readonly sources: Set<string> = new Set<string>();
+    private readonly sourceDirs: Set<string> = new Set<string>();
     private readonly includeDirs: Set<string> = new Set<string>();
     private readonly defineMacros: Record<string, string | number | true> = {};
     private loadingFunctions: string[] = [];
+    private unityDir: string | null = null;
 
     public readonly arch: Arch;
     public readonly vendor: Vendor;
@@ -195,14 +199,17 @@ export class CFG {
     }
 
     private lookupSourceFolder(sourceDir: string, recursive: boolean) {
-        for (const fileName of fs.readdirSync(sourceDir)) {
-            const filePath: string = path.join(sourceDir, fileName);
+        this.sourceDirs.add(sourceDir);
 
-            if (fileName.endsWith(".c")) {
+        // The entry types come with the listing, only symlinks need an own stat
+        for (const entry of fs.readdirSync(sourceDir, {withFileTypes: true})) {
+            const filePath: string = path.join(sourceDir, entry.name);
+
+            if (entry.name.endsWith(".c")) {
                 this.sources.add(filePath);
             }
 
-            if (recursive && fs.statSync(filePath).isDirectory()) {
+            if (recursive && (entry.isDirectory() || (entry.isSymbolicLink() && fs.statSync(filePath).isDirectory()))) {
                 this.lookupSourceFolder(filePath, true);
             }
         }
@@ -284,6 +291,28 @@ export class CFG {
         return this;
     }
 
+    /**
+     * Compiles the sources of the module in a directory as a single translation unit, which lets the optimizer inline
+     * across files and spawns one compiler process instead of one per file. Every change in the directory recompiles
+     * all of its sources though. Sources outside of it keep their own objects, so the linker still only pulls them in
+     * when they are used.
+     *
+     * @param relativePath - The path to the directory, relative to the project root. Defaults to all sources.
+     *
+     * @return The CFG instance for chaining.
+     */
+    public unity(relativePath: string = "."): this {
+        const unityDir: string = path.join(this.projectDir, relativePath);
+
+        if (!fs.existsSync(unityDir) || !fs.statSync(unityDir).isDirectory()) {
+            throw "Unity path don't points to a directory";
+        }
+
+        this.unityDir = unityDir;
+
+        return this;
+    }
+
     /**
      * Completes the configuration and returns the result.
      *
@@ -293,11 +322,13 @@ export class CFG {
         return {
             name: CFG.moduleName,
             sources: Array.from(this.sources),
+            sourceDirs: Array.from(this.sourceDirs),
             libraryLookup: Array.from(this.libraryLookup),
             linkLibraries: Array.from(this.linkLibraries),
             includeDirs: Array.from(this.includeDirs),
             defineMacros: this.defineMacros,
             loadingFunctions: this.loadingFunctions,
+            unityDir: this.unityDir,
         }
     }
 }
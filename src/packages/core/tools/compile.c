@@ -0,0 +1,114 @@
+// Build time compiler for the JavaScript bundle: compiles the bundle as a module and writes its bytecode, which
+// yaje_core_execute then only has to read instead of parsing the source on every start.
+//
+// Usage: compile <bundle.js> <output>
+#include "quickjs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static void print_exception(JSContext *ctx) {
+    JSValue exception = JS_GetException(ctx);
+
+    const char *error_str = JS_ToCString(ctx, exception);
+    if (error_str) {
+        fprintf(stderr, "%s\n", error_str);
+        JS_FreeCString(ctx, error_str);
+    } else {
+        fprintf(stderr, "An unknown error occurred\n");
+    }
+
+    JSValue stack = JS_GetPropertyStr(ctx, exception, "stack");
+    if (!JS_IsUndefined(stack)) {
+        const char *stack_str = JS_ToCString(ctx, stack);
+        if (stack_str) {
+            fprintf(stderr, "%s\n", stack_str);
+            JS_FreeCString(ctx, stack_str);
+        }
+    }
+    JS_FreeValue(ctx, stack);
+
+    JS_FreeValue(ctx, exception);
+}
+
+static char *read_file(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    char *buffer = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+            buffer = malloc(size + 1);
+            if (buffer && fread(buffer, 1, size, file) != (size_t)size) {
+                free(buffer);
+                buffer = NULL;
+            }
+            if (buffer) {
+                // JS_Eval expects a null terminated source
+                buffer[size] = '\0';
+                *length = size;
+            }
+        }
+    }
+
+    fclose(file);
+    return buffer;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <bundle.js> <output>\n", argv[0]);
+        return 2;
+    }
+
+    size_t source_length;
+    char *source = read_file(argv[1], &source_length);
+    if (!source) {
+        fprintf(stderr, "Could not read bundle '%s'\n", argv[1]);
+        return 1;
+    }
+
+    JSRuntime *rt = JS_NewRuntime();
+    JSContext *ctx = rt ? JS_NewContext(rt) : NULL;
+    if (!ctx) {
+        fprintf(stderr, "Could not init Runtime\n");
+        free(source);
+        return 1;
+    }
+
+    int exit_code = 1;
+    // Must match the name yaje_core_execute uses when compiling the source, it shows up in stack traces
+    JSValue module = JS_Eval(ctx, source, source_length, "<bundle>", JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+    free(source);
+
+    if (JS_IsException(module)) {
+        print_exception(ctx);
+    } else {
+        size_t length;
+        uint8_t *bytecode = JS_WriteObject(ctx, &length, module, JS_WRITE_OBJ_BYTECODE);
+        if (!bytecode) {
+            print_exception(ctx);
+        } else {
+            FILE *file = fopen(argv[2], "wb");
+            if (!file) {
+                fprintf(stderr, "Could not write '%s'\n", argv[2]);
+            } else {
+                if (fwrite(bytecode, 1, length, file) == length) {
+                    exit_code = 0;
+                } else {
+                    fprintf(stderr, "Could not write '%s'\n", argv[2]);
+                }
+                fclose(file);
+            }
+            js_free(ctx, bytecode);
+        }
+    }
+
+    JS_FreeValue(ctx, module);
+    JS_FreeContext(ctx);
+    JS_FreeRuntime(rt);
+    return exit_code;
+}
@@ -6,7 +6,9 @@ cfg
     .addSource("./native", true)
     .addIncludeDir("./native")
     .addIncludeDir("./native/quickjs")
-    .defineMacro("QUICKJS_NG_BUILD", true);
+    .defineMacro("QUICKJS_NG_BUILD", true)
+    // yaje.c stays out, it references the embedded bundle, which the bundle compiler linked with this library lacks
+    .unity("./native/quickjs");
 
 if (cfg.platform.isLinux() || cfg.platform.isDarwin()) {
     cfg.defineMacro("_GNU_SOURCE", true);
@@ -0,0 +1,491 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
+#include "quickjs.h"
+#include "fs.h"
+
+// Flags of copyFile, must match CopyFlags in src/copy.ts
+#define FS_COPY_EXCL 1
+#define FS_COPY_CLONE_FORCE 2
+#define FS_COPY_NO_CLONE 4
+
+// Largest chunk handed to a single copy_file_range or sendfile call, both cap a call at about 2 GB
+#define FS_COPY_CHUNK_SIZE (1 << 30)
+// Buffer of the read/write fallback, the only path where the data passes through user space
+#define FS_COPY_BUFFER_SIZE (128 * 1024)
+
+#if defined(__linux__) && !defined(FICLONE)
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+
+#ifndef _WIN32
+
+static bool fs_copy_is_unsupported(int error) {
+    return error == ENOSYS || error == EXDEV || error == EINVAL || error == EOPNOTSUPP || error == ENOTSUP;
+}
+
+// Copies up to length bytes between two descriptors at the given offsets, stops early at the end of the source.
+// copy_file_range keeps the data in the kernel and lets file systems that support it share extents instead of
+// copying, sendfile and finally pread/pwrite are used where it is not available. Returns 0 or an errno value.
+static int fs_copy_data(int in_fd, off_t in_offset, int out_fd, off_t out_offset, uint64_t length, uint64_t *copied) {
+    *copied = 0;
+
+#ifdef __linux__
+#ifdef SYS_copy_file_range
+    // The syscall takes 64 bit positions whatever the size of off_t
+    int64_t in_position = in_offset;
+    int64_t out_position = out_offset;
+    bool try_copy_file_range = true;
+    while (try_copy_file_range && *copied < length) {
+        size_t chunk = length - *copied > FS_COPY_CHUNK_SIZE ? FS_COPY_CHUNK_SIZE : length - *copied;
+        long result = syscall(SYS_copy_file_range, in_fd, &in_position, out_fd, &out_position, chunk, 0);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Only fall back before anything was written, a later error is a real one
+            if (*copied == 0 && fs_copy_is_unsupported(errno)) {
+                try_copy_file_range = false;
+                break;
+            }
+            return errno;
+        }
+
+        if (result == 0) {
+            // Pseudo files like the ones in /proc report no data here, the next method reads them
+            try_copy_file_range = *copied > 0;
+            break;
+        }
+
+        *copied += result;
+    }
+
+    if (try_copy_file_range) {
+        return 0;
+    }
+#endif
+
+    // sendfile writes at the current position of the output
+    bool try_sendfile = lseek(out_fd, out_offset, SEEK_SET) >= 0;
+    while (try_sendfile && *copied < length) {
+        size_t chunk = length - *copied > FS_COPY_CHUNK_SIZE ? FS_COPY_CHUNK_SIZE : length - *copied;
+        ssize_t result = sendfile(out_fd, in_fd, &in_offset, chunk);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (*copied == 0 && fs_copy_is_unsupported(errno)) {
+                try_sendfile = false;
+                break;
+            }
+            return errno;
+        }
+
+        if (result == 0) {
+            try_sendfile = *copied > 0;
+            break;
+        }
+
+        *copied += result;
+        out_offset += result;
+    }
+
+    if (try_sendfile) {
+        return 0;
+    }
+#endif
+
+    char *buffer = malloc(FS_COPY_BUFFER_SIZE);
+    if (!buffer) {
+        return ENOMEM;
+    }
+
+    int error = 0;
+    while (*copied < length) {
+        size_t chunk = length - *copied > FS_COPY_BUFFER_SIZE ? FS_COPY_BUFFER_SIZE : length - *copied;
+        ssize_t read_bytes = pread(in_fd, buffer, chunk, in_offset);
+
+        if (read_bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = errno;
+            break;
+        }
+
+        if (read_bytes == 0) {
+            break;
+        }
+
+        for (ssize_t written = 0; written < read_bytes;) {
+            ssize_t result = pwrite(out_fd, buffer + written, read_bytes - written, out_offset + written);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = errno;
+                break;
+            }
+            written += result;
+        }
+
+        if (error) {
+            break;
+        }
+
+        *copied += read_bytes;
+        in_offset += read_bytes;
+        out_offset += read_bytes;
+    }
+
+    free(buffer);
+    return error;
+}
+
+// Returned by fs_copy_whole_file when source and destination are the same file
+#define FS_COPY_SAME_FILE -1
+
+// Copies a whole file including its permissions, returns 0, FS_COPY_SAME_FILE or an errno value
+static int fs_copy_whole_file(const char *source, const char *destination, int flags, struct stat *source_st) {
+    struct stat destination_st;
+    uint64_t copied;
+    int error = 0;
+
+    int in_fd = open(source, O_RDONLY | O_CLOEXEC);
+    if (in_fd < 0) {
+        return errno;
+    }
+
+    if (fstat(in_fd, source_st) != 0) {
+        error = errno;
+        close(in_fd);
+        return error;
+    }
+
+    if (S_ISDIR(source_st->st_mode)) {
+        close(in_fd);
+        return EISDIR;
+    }
+
+    // Opening the destination truncates it, which would empty the source if both are the same file
+    if (stat(destination, &destination_st) == 0 && destination_st.st_dev == source_st->st_dev &&
+        destination_st.st_ino == source_st->st_ino) {
+        close(in_fd);
+        return FS_COPY_SAME_FILE;
+    }
+
+    // A forced clone leaves an existing destination untouched until the clone succeeded
+    int out_flags = O_WRONLY | O_CLOEXEC;
+    if (!(flags & FS_COPY_CLONE_FORCE)) {
+        out_flags |= O_TRUNC;
+    }
+
+    // Creating the destination exclusively tells whether it has to be removed again after an error
+    bool created = true;
+    int out_fd = open(destination, out_flags | O_CREAT | O_EXCL, source_st->st_mode & 0777);
+    if (out_fd < 0 && errno == EEXIST && !(flags & FS_COPY_EXCL)) {
+        created = false;
+        out_fd = open(destination, out_flags);
+    }
+    if (out_fd < 0) {
+        error = errno;
+        close(in_fd);
+        return error;
+    }
+
+    bool cloned = false;
+#ifdef __linux__
+    // A reflink shares the extents of the source, the copy takes no time and no space until either file changes
+    if (!(flags & FS_COPY_NO_CLONE)) {
+        cloned = ioctl(out_fd, FICLONE, in_fd) == 0;
+    }
+#endif
+
+    if (!cloned) {
+        if (flags & FS_COPY_CLONE_FORCE) {
+            error = EOPNOTSUPP;
+        } else {
+            // Files of pseudo file systems report a size of 0, those are read until the end instead
+            uint64_t length = source_st->st_size > 0 ? (uint64_t)source_st->st_size : UINT64_MAX;
+            error = fs_copy_data(in_fd, 0, out_fd, 0, length, &copied);
+        }
+    } else if (flags & FS_COPY_CLONE_FORCE) {
+        // The clone keeps the part of a longer existing destination that lies past the end of the source
+        if (ftruncate(out_fd, source_st->st_size) != 0) {
+            error = errno;
+        }
+    }
+
+    // The mode passed to open is masked by the umask
+    if (!error && fchmod(out_fd, source_st->st_mode & 07777) != 0) {
+        error = errno;
+    }
+
+    if (close(out_fd) != 0 && !error) {
+        error = errno;
+    }
+    if (error && created) {
+        unlink(destination);
+    }
+    close(in_fd);
+
+    return error;
+}
+
+#endif
+
+static JSValue fs_copy_file(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    const char *source;
+    const char *destination;
+    int flags;
+
+    if (argc < 3) {
+        return JS_ThrowTypeError(ctx, "Expected 3 arguments: source, destination and flags");
+    }
+
+    if (JS_ToInt32(ctx, &flags, argv[2])) {
+        return JS_EXCEPTION;
+    }
+
+    source = JS_ToCString(ctx, argv[0]);
+    if (!source) {
+        return JS_EXCEPTION;
+    }
+
+    destination = JS_ToCString(ctx, argv[1]);
+    if (!destination) {
+        JS_FreeCString(ctx, source);
+        return JS_EXCEPTION;
+    }
+
+#ifdef _WIN32
+    if (flags & FS_COPY_CLONE_FORCE) {
+        JS_FreeCString(ctx, source);
+        JS_FreeCString(ctx, destination);
+        return JS_ThrowInternalError(ctx, "Cloning files is not supported on this platform");
+    }
+
+    BOOL copied = CopyFileA(source, destination, (flags & FS_COPY_EXCL) != 0);
+    JS_FreeCString(ctx, source);
+    JS_FreeCString(ctx, destination);
+
+    if (!copied) {
+        return JS_ThrowInternalError(ctx, "Failed to copy file: error %lu", GetLastError());
+    }
+#else
+    struct stat source_st;
+    int error = fs_copy_whole_file(source, destination, flags, &source_st);
+    JS_FreeCString(ctx, source);
+    JS_FreeCString(ctx, destination);
+
+    if (error == FS_COPY_SAME_FILE) {
+        return JS_ThrowInternalError(ctx, "Failed to copy file: source and destination are the same file");
+    }
+
+    if (error) {
+        return JS_ThrowInternalError(ctx, "Failed to copy file: %s", strerror(error));
+    }
+#endif
+
+    return JS_UNDEFINED;
+}
+
+static JSValue fs_copy_range(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Copying file ranges is not supported on this platform");
+#else
+    const char *source;
+    const char *destination;
+    uint64_t source_offset;
+    uint64_t destination_offset;
+    uint64_t length;
+    uint64_t copied;
+    int error = 0;
+
+    if (argc < 5) {
+        return JS_ThrowTypeError(ctx, "Expected 5 arguments: source, sourceOffset, destination, destinationOffset and length");
+    }
+
+    if (JS_ToIndex(ctx, &source_offset, argv[1]) || JS_ToIndex(ctx, &destination_offset, argv[3]) ||
+        JS_ToIndex(ctx, &length, argv[4])) {
+        return JS_EXCEPTION;
+    }
+
+    source = JS_ToCString(ctx, argv[0]);
+    if (!source) {
+        return JS_EXCEPTION;
+    }
+
+    destination = JS_ToCString(ctx, argv[2]);
+    if (!destination) {
+        JS_FreeCString(ctx, source);
+        return JS_EXCEPTION;
+    }
+
+    int in_fd = open(source, O_RDONLY | O_CLOEXEC);
+    if (in_fd < 0) {
+        error = errno;
+    }
+
+    // The destination is neither truncated nor required to exist, bytes outside the range stay as they are
+    int out_fd = in_fd < 0 ? -1 : open(destination, O_WRONLY | O_CREAT | O_CLOEXEC, 0666);
+    if (in_fd >= 0 && out_fd < 0) {
+        error = errno;
+    }
+
+    JS_FreeCString(ctx, source);
+    JS_FreeCString(ctx, destination);
+
+    if (!error) {
+        error = fs_copy_data(in_fd, (off_t)source_offset, out_fd, (off_t)destination_offset, length, &copied);
+    }
+
+    if (out_fd >= 0 && close(out_fd) != 0 && !error) {
+        error = errno;
+    }
+    if (in_fd >= 0) {
+        close(in_fd);
+    }
+
+    if (error) {
+        return JS_ThrowInternalError(ctx, "Failed to copy file range: %s", strerror(error));
+    }
+
+    return JS_NewInt64(ctx, (int64_t)copied);
+#endif
+}
+
+#ifndef _WIN32
+// Recreates a symlink at the destination, replacing a destination that is not a directory like rename does
+static int fs_copy_symlink(const char *source, const char *destination, const struct stat *source_st) {
+    struct stat destination_st;
+    int error = 0;
+
+    char *target = malloc((size_t)source_st->st_size + 1);
+    if (!target) {
+        return ENOMEM;
+    }
+
+    ssize_t length = readlink(source, target, (size_t)source_st->st_size + 1);
+    if (length < 0) {
+        error = errno;
+    } else if ((size_t)length > (size_t)source_st->st_size) {
+        // The link changed since it was examined
+        error = EAGAIN;
+    } else {
+        target[length] = '\0';
+
+        if (lstat(destination, &destination_st) == 0) {
+            if (S_ISDIR(destination_st.st_mode)) {
+                error = EISDIR;
+            } else if (unlink(destination) != 0) {
+                error = errno;
+            }
+        }
+
+        if (!error && symlink(target, destination) != 0) {
+            error = errno;
+        }
+    }
+
+    free(target);
+    return error;
+}
+#endif
+
+static JSValue fs_rename(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    const char *source;
+    const char *destination;
+    int error = 0;
+
+    if (argc < 2) {
+        return JS_ThrowTypeError(ctx, "Expected 2 arguments: source and destination");
+    }
+
+    source = JS_ToCString(ctx, argv[0]);
+    if (!source) {
+        return JS_EXCEPTION;
+    }
+
+    destination = JS_ToCString(ctx, argv[1]);
+    if (!destination) {
+        JS_FreeCString(ctx, source);
+        return JS_EXCEPTION;
+    }
+
+#ifdef _WIN32
+    if (!MoveFileExA(source, destination, MOVEFILE_COPY_ALLOWED | MOVEFILE_REPLACE_EXISTING)) {
+        error = (int)GetLastError();
+    }
+    JS_FreeCString(ctx, source);
+    JS_FreeCString(ctx, destination);
+
+    if (error) {
+        return JS_ThrowInternalError(ctx, "Failed to rename file: error %d", error);
+    }
+#else
+    if (rename(source, destination) != 0) {
+        error = errno;
+    }
+
+    // Across file systems regular files and symlinks are moved by copying them and removing the source, anything
+    // else is not
+    if (error == EXDEV) {
+        struct stat source_st;
+
+        if (lstat(source, &source_st) != 0) {
+            error = errno;
+        } else if (S_ISLNK(source_st.st_mode)) {
+            error = fs_copy_symlink(source, destination, &source_st);
+        } else if (S_ISREG(source_st.st_mode)) {
+            error = fs_copy_whole_file(source, destination, 0, &source_st);
+
+            if (!error) {
+                struct timespec times[2] = {FS_ST_ATIM(&source_st), FS_ST_MTIM(&source_st)};
+                utimensat(AT_FDCWD, destination, times, 0);
+            } else if (error == EISDIR) {
+                error = EXDEV;
+            } else if (error == FS_COPY_SAME_FILE) {
+                error = EINVAL;
+            }
+        }
+
+        if (!error && unlink(source) != 0) {
+            error = errno;
+        }
+    }
+
+    JS_FreeCString(ctx, source);
+    JS_FreeCString(ctx, destination);
+
+    if (error) {
+        return JS_ThrowInternalError(ctx, "Failed to rename file: %s", strerror(error));
+    }
+#endif
+
+    return JS_UNDEFINED;
+}
+
+void yaje_fs_copy_init(JSContext *ctx, JSValue sync_fs) {
+    JS_SetPropertyStr(ctx, sync_fs, "copyFile", JS_NewCFunction(ctx, fs_copy_file, "copyFile", 3));
+    JS_SetPropertyStr(ctx, sync_fs, "copyRange", JS_NewCFunction(ctx, fs_copy_range, "copyRange", 5));
+    JS_SetPropertyStr(ctx, sync_fs, "rename", JS_NewCFunction(ctx, fs_rename, "rename", 2));
+}
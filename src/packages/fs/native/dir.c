@@ -0,0 +1,848 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "quickjs.h"
+#include "cutils.h"
+#include "fs.h"
+
+// Size of the buffer the kernel fills with directory entries, large enough for a few thousand names per syscall
+#define FS_DIR_BUFFER_SIZE (64 * 1024)
+
+// Entries handed to JS per walkNext call
+#define FS_WALK_BATCH_ENTRIES 1024
+// Batches the walker threads may queue before they wait for the consumer, bounds the memory of a walk
+#define FS_WALK_MAX_BATCHES 64
+#define FS_WALK_MAX_THREADS 64
+
+// Layout of the Float64Array returned by stat and lstat, must match StatField in src/dir.ts
+enum {
+    FS_STAT_DEV,
+    FS_STAT_INO,
+    FS_STAT_MODE,
+    FS_STAT_NLINK,
+    FS_STAT_UID,
+    FS_STAT_GID,
+    FS_STAT_RDEV,
+    FS_STAT_SIZE,
+    FS_STAT_BLKSIZE,
+    FS_STAT_BLOCKS,
+    FS_STAT_ATIME_MS,
+    FS_STAT_MTIME_MS,
+    FS_STAT_CTIME_MS,
+    FS_STAT_COUNT
+};
+
+#ifndef _WIN32
+
+#ifdef __linux__
+// Record layout of getdents64, glibc only exposes it from 2.30 on and musl not at all
+struct fs_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+#endif
+
+static int fs_type_from_mode(mode_t mode) {
+    switch (mode & S_IFMT) {
+        case S_IFREG:
+            return FS_TYPE_FILE;
+        case S_IFDIR:
+            return FS_TYPE_DIRECTORY;
+        case S_IFLNK:
+            return FS_TYPE_SYMLINK;
+        case S_IFBLK:
+            return FS_TYPE_BLOCK_DEVICE;
+        case S_IFCHR:
+            return FS_TYPE_CHARACTER_DEVICE;
+        case S_IFIFO:
+            return FS_TYPE_FIFO;
+        case S_IFSOCK:
+            return FS_TYPE_SOCKET;
+        default:
+            return FS_TYPE_UNKNOWN;
+    }
+}
+
+static int fs_type_from_dirent(int dir_fd, const char *name, unsigned char d_type) {
+    struct stat st;
+
+    switch (d_type) {
+        case DT_REG:
+            return FS_TYPE_FILE;
+        case DT_DIR:
+            return FS_TYPE_DIRECTORY;
+        case DT_LNK:
+            return FS_TYPE_SYMLINK;
+        case DT_BLK:
+            return FS_TYPE_BLOCK_DEVICE;
+        case DT_CHR:
+            return FS_TYPE_CHARACTER_DEVICE;
+        case DT_FIFO:
+            return FS_TYPE_FIFO;
+        case DT_SOCK:
+            return FS_TYPE_SOCKET;
+        default:
+            // Some file systems do not fill in d_type, only those entries cost a stat
+            if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                return FS_TYPE_UNKNOWN;
+            }
+            return fs_type_from_mode(st.st_mode);
+    }
+}
+
+static bool fs_is_dot_entry(const char *name) {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+int yaje_fs_read_dir(const char *path, FSDirCallback callback, void *opaque) {
+    int error = 0;
+
+#ifdef __linux__
+    // getdents64 returns the names together with their type, so listing a directory does not need a stat per entry
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno;
+    }
+
+    char *buffer = malloc(FS_DIR_BUFFER_SIZE);
+    if (!buffer) {
+        close(fd);
+        return ENOMEM;
+    }
+
+    while (!error) {
+        long length = syscall(SYS_getdents64, fd, buffer, FS_DIR_BUFFER_SIZE);
+        if (length < 0) {
+            if (errno != EINTR) {
+                error = errno;
+            }
+            continue;
+        }
+
+        if (length == 0) {
+            break;
+        }
+
+        for (long offset = 0; offset < length && !error;) {
+            struct fs_dirent64 *entry = (struct fs_dirent64 *)(buffer + offset);
+            offset += entry->d_reclen;
+
+            if (fs_is_dot_entry(entry->d_name)) {
+                continue;
+            }
+
+            error = callback(opaque, entry->d_name, strlen(entry->d_name),
+                             fs_type_from_dirent(fd, entry->d_name, entry->d_type));
+        }
+    }
+
+    free(buffer);
+    close(fd);
+#else
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return errno;
+    }
+
+    while (!error) {
+        errno = 0;
+        struct dirent *entry = readdir(dir);
+        if (!entry) {
+            error = errno;
+            break;
+        }
+
+        if (fs_is_dot_entry(entry->d_name)) {
+            continue;
+        }
+
+        error = callback(opaque, entry->d_name, strlen(entry->d_name),
+                         fs_type_from_dirent(dirfd(dir), entry->d_name, entry->d_type));
+    }
+
+    closedir(dir);
+#endif
+
+    return error;
+}
+
+typedef struct {
+    JSContext *ctx;
+    JSValue entries;
+    uint32_t count;
+    JSAtom name_atom;
+    JSAtom type_atom;
+} FSReaddirState;
+
+static int fs_readdir_entry(void *opaque, const char *name, size_t name_length, int type) {
+    FSReaddirState *state = opaque;
+    JSContext *ctx = state->ctx;
+
+    JSValue entry = JS_NewObject(ctx);
+    if (JS_IsException(entry)) {
+        return ENOMEM;
+    }
+
+    JS_DefinePropertyValue(ctx, entry, state->name_atom, JS_NewStringLen(ctx, name, name_length), JS_PROP_C_W_E);
+    JS_DefinePropertyValue(ctx, entry, state->type_atom, JS_NewInt32(ctx, type), JS_PROP_C_W_E);
+
+    if (JS_DefinePropertyValueUint32(ctx, state->entries, state->count++, entry, JS_PROP_C_W_E) < 0) {
+        return ENOMEM;
+    }
+
+    return 0;
+}
+
+static double fs_timespec_ms(struct timespec time) {
+    return (double)time.tv_sec * 1e3 + (double)time.tv_nsec / 1e6;
+}
+
+#endif
+
+static JSValue fs_readdir(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Reading directories is not supported on this platform");
+#else
+    const char *path;
+    FSReaddirState state;
+    int error;
+
+    if (argc < 1) {
+        return JS_ThrowTypeError(ctx, "Expected 1 argument: path");
+    }
+
+    path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    state.ctx = ctx;
+    state.entries = JS_NewArray(ctx);
+    state.count = 0;
+    state.name_atom = JS_NewAtom(ctx, "name");
+    state.type_atom = JS_NewAtom(ctx, "type");
+
+    error = yaje_fs_read_dir(path, fs_readdir_entry, &state);
+    JS_FreeCString(ctx, path);
+    JS_FreeAtom(ctx, state.name_atom);
+    JS_FreeAtom(ctx, state.type_atom);
+
+    if (error) {
+        JS_FreeValue(ctx, state.entries);
+        return JS_ThrowInternalError(ctx, "Failed to read directory: %s", strerror(error));
+    }
+
+    return state.entries;
+#endif
+}
+
+static JSValue fs_stat_common(JSContext *ctx, int argc, JSValueConst *argv, bool follow_links) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Stat is not supported on this platform");
+#else
+    const char *path;
+    struct stat st;
+    double fields[FS_STAT_COUNT];
+    int result;
+
+    if (argc < 1) {
+        return JS_ThrowTypeError(ctx, "Expected 1 argument: path");
+    }
+
+    path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    result = follow_links ? stat(path, &st) : lstat(path, &st);
+    JS_FreeCString(ctx, path);
+
+    if (result != 0) {
+        return JS_ThrowInternalError(ctx, "Failed to stat file: %s", strerror(errno));
+    }
+
+    fields[FS_STAT_DEV] = (double)st.st_dev;
+    fields[FS_STAT_INO] = (double)st.st_ino;
+    fields[FS_STAT_MODE] = (double)st.st_mode;
+    fields[FS_STAT_NLINK] = (double)st.st_nlink;
+    fields[FS_STAT_UID] = (double)st.st_uid;
+    fields[FS_STAT_GID] = (double)st.st_gid;
+    fields[FS_STAT_RDEV] = (double)st.st_rdev;
+    fields[FS_STAT_SIZE] = (double)st.st_size;
+    fields[FS_STAT_BLKSIZE] = (double)st.st_blksize;
+    fields[FS_STAT_BLOCKS] = (double)st.st_blocks;
+    fields[FS_STAT_ATIME_MS] = fs_timespec_ms(FS_ST_ATIM(&st));
+    fields[FS_STAT_MTIME_MS] = fs_timespec_ms(FS_ST_MTIM(&st));
+    fields[FS_STAT_CTIME_MS] = fs_timespec_ms(FS_ST_CTIM(&st));
+
+    // One typed array instead of an object with a dozen properties, src/dir.ts wraps it in a Stats view
+    JSValue buffer = JS_NewArrayBufferCopy(ctx, (const uint8_t *)fields, sizeof(fields));
+    if (JS_IsException(buffer)) {
+        return JS_EXCEPTION;
+    }
+
+    // The constructor always reads offset and length, argc is not checked
+    JSValue args[3] = {buffer, JS_NewInt32(ctx, 0), JS_UNDEFINED};
+    JSValue array = JS_NewTypedArray(ctx, 3, args, JS_TYPED_ARRAY_FLOAT64);
+    JS_FreeValue(ctx, buffer);
+    return array;
+#endif
+}
+
+static JSValue fs_stat(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    return fs_stat_common(ctx, argc, argv, true);
+}
+
+static JSValue fs_lstat(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    return fs_stat_common(ctx, argc, argv, false);
+}
+
+#ifndef _WIN32
+
+// A directory that still has to be read, paths are stored inline
+typedef struct FSWalkDir {
+    struct FSWalkDir *next;
+    char path[];
+} FSWalkDir;
+
+// Entries are packed as one type byte followed by the null terminated path
+typedef struct FSWalkBatch {
+    struct FSWalkBatch *next;
+    uint32_t count;
+    size_t length;
+    size_t capacity;
+    char *data;
+} FSWalkBatch;
+
+typedef struct {
+    js_mutex_t mutex;
+    // Signalled when directories are queued or the walk is finished
+    js_cond_t work_cond;
+    // Signalled when a batch is queued or a worker finished
+    js_cond_t batch_cond;
+    // Signalled when the consumer took a batch
+    js_cond_t space_cond;
+
+    FSWalkDir *dirs;
+    // Directories currently being read, the walk is finished once no directory is queued or active
+    int active;
+    FSWalkBatch *batches_head;
+    FSWalkBatch *batches_tail;
+    int batch_count;
+    int finished_threads;
+    bool cancelled;
+    bool stopped;
+
+    char **exclude;
+    int exclude_count;
+
+    int thread_count;
+    js_thread_t threads[FS_WALK_MAX_THREADS];
+} FSWalker;
+
+// State of a single worker while it reads one directory
+typedef struct {
+    FSWalker *walker;
+    const char *dir;
+    size_t dir_length;
+    FSWalkBatch *batch;
+    FSWalkDir *found_dirs;
+} FSWalkWorker;
+
+static JSClassID fs_walker_class_id;
+
+static FSWalkDir *fs_walk_dir_new(const char *dir, size_t dir_length, const char *name, size_t name_length) {
+    // The root "/" must not produce "//name", an empty name queues dir itself
+    bool separator = name_length > 0 && dir_length > 0 && dir[dir_length - 1] != '/';
+
+    FSWalkDir *entry = malloc(sizeof(FSWalkDir) + dir_length + separator + name_length + 1);
+    if (!entry) {
+        return NULL;
+    }
+
+    entry->next = NULL;
+    memcpy(entry->path, dir, dir_length);
+    if (separator) {
+        entry->path[dir_length] = '/';
+    }
+    memcpy(entry->path + dir_length + separator, name, name_length);
+    entry->path[dir_length + separator + name_length] = '\0';
+
+    return entry;
+}
+
+static void fs_walk_batch_free(FSWalkBatch *batch) {
+    free(batch->data);
+    free(batch);
+}
+
+// Hands a batch to the consumer, waits while the queue is full, returns false once the walk got cancelled
+static bool fs_walk_flush(FSWalkWorker *worker) {
+    FSWalker *walker = worker->walker;
+    FSWalkBatch *batch = worker->batch;
+    bool cancelled;
+
+    if (!batch || batch->count == 0) {
+        return true;
+    }
+
+    worker->batch = NULL;
+
+    js_mutex_lock(&walker->mutex);
+    while (walker->batch_count >= FS_WALK_MAX_BATCHES && !walker->cancelled) {
+        js_cond_wait(&walker->space_cond, &walker->mutex);
+    }
+
+    cancelled = walker->cancelled;
+    if (!cancelled) {
+        if (walker->batches_tail) {
+            walker->batches_tail->next = batch;
+        } else {
+            walker->batches_head = batch;
+        }
+        walker->batches_tail = batch;
+        walker->batch_count++;
+        js_cond_signal(&walker->batch_cond);
+    }
+    js_mutex_unlock(&walker->mutex);
+
+    if (cancelled) {
+        fs_walk_batch_free(batch);
+    }
+
+    return !cancelled;
+}
+
+static bool fs_walk_is_excluded(FSWalker *walker, const char *name) {
+    for (int i = 0; i < walker->exclude_count; i++) {
+        if (strcmp(walker->exclude[i], name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int fs_walk_entry(void *opaque, const char *name, size_t name_length, int type) {
+    FSWalkWorker *worker = opaque;
+    FSWalkBatch *batch = worker->batch;
+    bool separator = worker->dir_length > 0 && worker->dir[worker->dir_length - 1] != '/';
+    size_t length = 1 + worker->dir_length + separator + name_length + 1;
+
+    if (fs_walk_is_excluded(worker->walker, name)) {
+        return 0;
+    }
+
+    if (type == FS_TYPE_DIRECTORY) {
+        // Symlinks are reported as such and never followed, so the walk cannot loop
+        FSWalkDir *dir = fs_walk_dir_new(worker->dir, worker->dir_length, name, name_length);
+        if (!dir) {
+            return ENOMEM;
+        }
+        dir->next = worker->found_dirs;
+        worker->found_dirs = dir;
+    }
+
+    if (!batch) {
+        batch = calloc(1, sizeof(FSWalkBatch));
+        if (!batch) {
+            return ENOMEM;
+        }
+        worker->batch = batch;
+    }
+
+    if (batch->length + length > batch->capacity) {
+        size_t capacity = batch->capacity ? batch->capacity * 2 : 64 * 1024;
+        while (capacity < batch->length + length) {
+            capacity *= 2;
+        }
+
+        char *data = realloc(batch->data, capacity);
+        if (!data) {
+            return ENOMEM;
+        }
+        batch->data = data;
+        batch->capacity = capacity;
+    }
+
+    char *out = batch->data + batch->length;
+    *out++ = (char)type;
+    memcpy(out, worker->dir, worker->dir_length);
+    out += worker->dir_length;
+    if (separator) {
+        *out++ = '/';
+    }
+    memcpy(out, name, name_length);
+    out[name_length] = '\0';
+
+    batch->length += length;
+    batch->count++;
+
+    if (batch->count >= FS_WALK_BATCH_ENTRIES && !fs_walk_flush(worker)) {
+        return ECANCELED;
+    }
+
+    return 0;
+}
+
+static void fs_walk_thread(void *arg) {
+    FSWalker *walker = arg;
+    FSWalkWorker worker = {.walker = walker};
+
+    js_mutex_lock(&walker->mutex);
+    while (true) {
+        if (!walker->dirs && walker->active > 0 && !walker->cancelled) {
+            // Nothing to read right now, hand out what was collected so far instead of holding it back while waiting
+            js_mutex_unlock(&walker->mutex);
+            fs_walk_flush(&worker);
+            js_mutex_lock(&walker->mutex);
+
+            while (!walker->dirs && walker->active > 0 && !walker->cancelled) {
+                js_cond_wait(&walker->work_cond, &walker->mutex);
+            }
+        }
+
+        if (walker->cancelled || !walker->dirs) {
+            break;
+        }
+
+        FSWalkDir *dir = walker->dirs;
+        walker->dirs = dir->next;
+        walker->active++;
+        js_mutex_unlock(&walker->mutex);
+
+        worker.dir = dir->path;
+        worker.dir_length = strlen(dir->path);
+        worker.found_dirs = NULL;
+
+        // Directories that vanished or cannot be read are skipped, only the root is checked up front
+        yaje_fs_read_dir(dir->path, fs_walk_entry, &worker);
+        free(dir);
+
+        js_mutex_lock(&walker->mutex);
+        if (worker.found_dirs) {
+            FSWalkDir *last = worker.found_dirs;
+            while (last->next) {
+                last = last->next;
+            }
+            last->next = walker->dirs;
+            walker->dirs = worker.found_dirs;
+            js_cond_broadcast(&walker->work_cond);
+        }
+
+        walker->active--;
+        if (walker->active == 0 && !walker->dirs) {
+            js_cond_broadcast(&walker->work_cond);
+        }
+    }
+    js_mutex_unlock(&walker->mutex);
+
+    fs_walk_flush(&worker);
+    if (worker.batch) {
+        fs_walk_batch_free(worker.batch);
+    }
+
+    js_mutex_lock(&walker->mutex);
+    walker->finished_threads++;
+    js_cond_signal(&walker->batch_cond);
+    js_mutex_unlock(&walker->mutex);
+}
+
+// Cancels the walk and joins all threads, safe to call more than once
+static void fs_walker_stop(FSWalker *walker) {
+    if (walker->stopped) {
+        return;
+    }
+
+    js_mutex_lock(&walker->mutex);
+    walker->cancelled = true;
+    js_cond_broadcast(&walker->work_cond);
+    js_cond_broadcast(&walker->space_cond);
+    js_mutex_unlock(&walker->mutex);
+
+    for (int i = 0; i < walker->thread_count; i++) {
+        js_thread_join(walker->threads[i]);
+    }
+
+    walker->stopped = true;
+
+    while (walker->dirs) {
+        FSWalkDir *next = walker->dirs->next;
+        free(walker->dirs);
+        walker->dirs = next;
+    }
+
+    while (walker->batches_head) {
+        FSWalkBatch *next = walker->batches_head->next;
+        fs_walk_batch_free(walker->batches_head);
+        walker->batches_head = next;
+    }
+    walker->batches_tail = NULL;
+    walker->batch_count = 0;
+}
+
+static void fs_walker_free(FSWalker *walker) {
+    fs_walker_stop(walker);
+
+    for (int i = 0; i < walker->exclude_count; i++) {
+        free(walker->exclude[i]);
+    }
+    free(walker->exclude);
+
+    js_mutex_destroy(&walker->mutex);
+    js_cond_destroy(&walker->work_cond);
+    js_cond_destroy(&walker->batch_cond);
+    js_cond_destroy(&walker->space_cond);
+    free(walker);
+}
+
+static void fs_walker_finalizer(JSRuntime *rt, JSValue val) {
+    FSWalker *walker = JS_GetOpaque(val, fs_walker_class_id);
+    if (walker) {
+        fs_walker_free(walker);
+    }
+}
+
+static JSClassDef fs_walker_class = {
+    .class_name = "FSWalker",
+    .finalizer = fs_walker_finalizer,
+};
+
+#endif
+
+static JSValue fs_walk_open(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Walking directories is not supported on this platform");
+#else
+    const char *root;
+    int threads;
+    int64_t exclude_length = 0;
+    struct stat st;
+    FSWalker *walker;
+
+    if (argc < 3) {
+        return JS_ThrowTypeError(ctx, "Expected 3 arguments: root, threads and exclude");
+    }
+
+    if (JS_ToInt32(ctx, &threads, argv[1])) {
+        return JS_EXCEPTION;
+    }
+
+    if (JS_GetLength(ctx, argv[2], &exclude_length)) {
+        return JS_EXCEPTION;
+    }
+
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if (threads > FS_WALK_MAX_THREADS) {
+        threads = FS_WALK_MAX_THREADS;
+    }
+
+    walker = calloc(1, sizeof(FSWalker));
+    if (!walker) {
+        return JS_ThrowInternalError(ctx, "Memory allocation failed");
+    }
+
+    js_mutex_init(&walker->mutex);
+    js_cond_init(&walker->work_cond);
+    js_cond_init(&walker->batch_cond);
+    js_cond_init(&walker->space_cond);
+
+    if (exclude_length > 0) {
+        walker->exclude = calloc(exclude_length, sizeof(char *));
+        if (!walker->exclude) {
+            fs_walker_free(walker);
+            return JS_ThrowInternalError(ctx, "Memory allocation failed");
+        }
+    }
+
+    for (int64_t i = 0; i < exclude_length; i++) {
+        JSValue name_val = JS_GetPropertyInt64(ctx, argv[2], i);
+        const char *name = JS_ToCString(ctx, name_val);
+        JS_FreeValue(ctx, name_val);
+        if (!name) {
+            fs_walker_free(walker);
+            return JS_EXCEPTION;
+        }
+
+        walker->exclude[walker->exclude_count] = strdup(name);
+        JS_FreeCString(ctx, name);
+        if (!walker->exclude[walker->exclude_count]) {
+            fs_walker_free(walker);
+            return JS_ThrowInternalError(ctx, "Memory allocation failed");
+        }
+        walker->exclude_count++;
+    }
+
+    root = JS_ToCString(ctx, argv[0]);
+    if (!root) {
+        fs_walker_free(walker);
+        return JS_EXCEPTION;
+    }
+
+    // Errors below the root are skipped while walking, a bad root however is reported right away
+    if (stat(root, &st) != 0) {
+        JS_FreeCString(ctx, root);
+        fs_walker_free(walker);
+        return JS_ThrowInternalError(ctx, "Failed to walk directory: %s", strerror(errno));
+    }
+
+    if (!S_ISDIR(st.st_mode)) {
+        JS_FreeCString(ctx, root);
+        fs_walker_free(walker);
+        return JS_ThrowInternalError(ctx, "Failed to walk directory: %s", strerror(ENOTDIR));
+    }
+
+    walker->dirs = fs_walk_dir_new(root, strlen(root), "", 0);
+    JS_FreeCString(ctx, root);
+    if (!walker->dirs) {
+        fs_walker_free(walker);
+        return JS_ThrowInternalError(ctx, "Memory allocation failed");
+    }
+
+    JSValue handle = JS_NewObjectClass(ctx, fs_walker_class_id);
+    if (JS_IsException(handle)) {
+        fs_walker_free(walker);
+        return JS_EXCEPTION;
+    }
+
+    for (int i = 0; i < threads; i++) {
+        if (js_thread_create(&walker->threads[i], fs_walk_thread, walker, 0)) {
+            break;
+        }
+        walker->thread_count++;
+    }
+
+    if (walker->thread_count == 0) {
+        fs_walker_free(walker);
+        JS_FreeValue(ctx, handle);
+        return JS_ThrowInternalError(ctx, "Failed to start walker threads");
+    }
+
+    JS_SetOpaque(handle, walker);
+    return handle;
+#endif
+}
+
+static JSValue fs_walk_next(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Walking directories is not supported on this platform");
+#else
+    FSWalker *walker;
+    FSWalkBatch *batch;
+
+    if (argc < 1) {
+        return JS_ThrowTypeError(ctx, "Expected 1 argument: walker");
+    }
+
+    walker = JS_GetOpaque(argv[0], fs_walker_class_id);
+    if (!walker) {
+        return JS_ThrowTypeError(ctx, "Invalid walker");
+    }
+
+    if (walker->stopped) {
+        return JS_NULL;
+    }
+
+    js_mutex_lock(&walker->mutex);
+    while (!walker->batches_head && walker->finished_threads < walker->thread_count) {
+        js_cond_wait(&walker->batch_cond, &walker->mutex);
+    }
+
+    batch = walker->batches_head;
+    if (batch) {
+        walker->batches_head = batch->next;
+        if (!walker->batches_head) {
+            walker->batches_tail = NULL;
+        }
+        walker->batch_count--;
+        js_cond_signal(&walker->space_cond);
+    }
+    js_mutex_unlock(&walker->mutex);
+
+    if (!batch) {
+        // All threads are done, joining them now frees their resources before the handle is collected
+        fs_walker_stop(walker);
+        return JS_NULL;
+    }
+
+    JSValue *entries = js_malloc(ctx, sizeof(JSValue) * batch->count);
+    if (!entries) {
+        fs_walk_batch_free(batch);
+        return JS_EXCEPTION;
+    }
+
+    JSAtom path_atom = JS_NewAtom(ctx, "path");
+    JSAtom type_atom = JS_NewAtom(ctx, "type");
+    const char *data = batch->data;
+
+    for (uint32_t i = 0; i < batch->count; i++) {
+        int type = (unsigned char)*data++;
+        size_t length = strlen(data);
+
+        entries[i] = JS_NewObject(ctx);
+        JS_DefinePropertyValue(ctx, entries[i], path_atom, JS_NewStringLen(ctx, data, length), JS_PROP_C_W_E);
+        JS_DefinePropertyValue(ctx, entries[i], type_atom, JS_NewInt32(ctx, type), JS_PROP_C_W_E);
+
+        data += length + 1;
+    }
+
+    JS_FreeAtom(ctx, path_atom);
+    JS_FreeAtom(ctx, type_atom);
+
+    JSValue result = JS_NewArrayFrom(ctx, batch->count, entries);
+    js_free(ctx, entries);
+    fs_walk_batch_free(batch);
+    return result;
+#endif
+}
+
+static JSValue fs_walk_close(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifndef _WIN32
+    FSWalker *walker;
+
+    if (argc < 1) {
+        return JS_ThrowTypeError(ctx, "Expected 1 argument: walker");
+    }
+
+    walker = JS_GetOpaque(argv[0], fs_walker_class_id);
+    if (!walker) {
+        return JS_ThrowTypeError(ctx, "Invalid walker");
+    }
+
+    fs_walker_stop(walker);
+#endif
+    return JS_UNDEFINED;
+}
+
+void yaje_fs_dir_init(JSRuntime *rt, JSContext *ctx, JSValue sync_fs) {
+#ifndef _WIN32
+    JS_NewClassID(rt, &fs_walker_class_id);
+    JS_NewClass(rt, fs_walker_class_id, &fs_walker_class);
+#endif
+
+    JS_SetPropertyStr(ctx, sync_fs, "readdir", JS_NewCFunction(ctx, fs_readdir, "readdir", 1));
+    JS_SetPropertyStr(ctx, sync_fs, "stat", JS_NewCFunction(ctx, fs_stat, "stat", 1));
+    JS_SetPropertyStr(ctx, sync_fs, "lstat", JS_NewCFunction(ctx, fs_lstat, "lstat", 1));
+    JS_SetPropertyStr(ctx, sync_fs, "walkOpen", JS_NewCFunction(ctx, fs_walk_open, "walkOpen", 3));
+    JS_SetPropertyStr(ctx, sync_fs, "walkNext", JS_NewCFunction(ctx, fs_walk_next, "walkNext", 1));
+    JS_SetPropertyStr(ctx, sync_fs, "walkClose", JS_NewCFunction(ctx, fs_walk_close, "walkClose", 1));
+}
@@ -0,0 +1,40 @@
+#ifndef YAJE_FS_H
+#define YAJE_FS_H
+
+#include "quickjs.h"
+
+// Entry types reported by readdir, stat and walk, must match FileType in src/dir.ts
+enum {
+    FS_TYPE_UNKNOWN,
+    FS_TYPE_FILE,
+    FS_TYPE_DIRECTORY,
+    FS_TYPE_SYMLINK,
+    FS_TYPE_BLOCK_DEVICE,
+    FS_TYPE_CHARACTER_DEVICE,
+    FS_TYPE_FIFO,
+    FS_TYPE_SOCKET
+};
+
+// Timestamps of struct stat
+#ifdef __APPLE__
+#define FS_ST_ATIM(st) ((st)->st_atimespec)
+#define FS_ST_MTIM(st) ((st)->st_mtimespec)
+#define FS_ST_CTIM(st) ((st)->st_ctimespec)
+#else
+#define FS_ST_ATIM(st) ((st)->st_atim)
+#define FS_ST_MTIM(st) ((st)->st_mtim)
+#define FS_ST_CTIM(st) ((st)->st_ctim)
+#endif
+
+// Called for every directory entry, a non zero return value stops reading and is returned as the error
+typedef int (*FSDirCallback)(void *opaque, const char *name, size_t name_length, int type);
+
+// Reads all entries of a directory except "." and "..", returns 0 or an errno value
+int yaje_fs_read_dir(const char *path, FSDirCallback callback, void *opaque);
+
+void yaje_fs_dir_init(JSRuntime *rt, JSContext *ctx, JSValue sync_fs);
+void yaje_fs_copy_init(JSContext *ctx, JSValue sync_fs);
+void yaje_fs_writer_init(JSRuntime *rt, JSContext *ctx, JSValue sync_fs);
+void yaje_fs_watch_init(JSRuntime *rt, JSContext *ctx, JSValue sync_fs);
+
+#endif
@@ -5,6 +5,7 @@
 
 #include "quickjs.h"
 #include "yaje.h"
+#include "fs.h"
 
 static JSValue fs_open(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
     const char *path;
@@ -212,6 +213,11 @@ void yaje_fs_init(JSRuntime* rt, JSContext *ctx) {
     JS_SetPropertyStr(ctx, sync_fs, "seek", JS_NewCFunction(ctx, fs_seek, "seek", 3));
     JS_SetPropertyStr(ctx, sync_fs, "tell", JS_NewCFunction(ctx, fs_tell, "tell", 1));
 
+    yaje_fs_dir_init(rt, ctx, sync_fs);
+    yaje_fs_copy_init(ctx, sync_fs);
+    yaje_fs_writer_init(rt, ctx, sync_fs);
+    yaje_fs_watch_init(rt, ctx, sync_fs);
+
     yaje_core_register_native(ctx, JS_DupValue(ctx, sync_fs), "fs.sync");
     JS_FreeValue(ctx, sync_fs);
 }
\ No newline at end of file
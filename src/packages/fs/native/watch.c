@@ -0,0 +1,580 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#endif
+
+#include "quickjs.h"
+#include "fs.h"
+
+// Events reported to JS, must match WatchEvent in src/watch.ts
+#define FS_WATCH_CREATE 1
+#define FS_WATCH_MODIFY 2
+#define FS_WATCH_DELETE 4
+#define FS_WATCH_RENAME 8
+#define FS_WATCH_ATTRIB 16
+// The kernel queue overflowed and events were lost, the watched tree has to be rescanned
+#define FS_WATCH_OVERFLOW 32
+
+#ifdef __linux__
+
+#define FS_WATCH_MASK (IN_CREATE | IN_MODIFY | IN_ATTRIB | IN_DELETE | IN_DELETE_SELF | IN_MOVED_FROM | IN_MOVED_TO | \
+                       IN_MOVE_SELF)
+
+// Large enough for hundreds of events per read, aligned for struct inotify_event
+#define FS_WATCH_BUFFER_SIZE (64 * 1024)
+
+// One event per path, repeated events of the same path within the coalescing window are merged into it
+typedef struct {
+    char *path;
+    int events;
+    bool directory;
+} FSWatchEvent;
+
+typedef struct {
+    FSWatchEvent *items;
+    uint32_t count;
+    uint32_t capacity;
+    // Open addressing table of item index + 1, 0 marks a free slot
+    uint32_t *table;
+    uint32_t table_size;
+} FSWatchEvents;
+
+typedef struct {
+    int fd;
+    bool recursive;
+    int coalesce_ms;
+    char *root;
+    // Watched path of every watch descriptor, indexed by the descriptor
+    char **paths;
+    int path_count;
+    char *buffer;
+} FSWatcher;
+
+static JSClassID fs_watcher_class_id;
+
+static uint32_t fs_watch_hash(const char *path) {
+    uint32_t hash = 2166136261u;
+    while (*path) {
+        hash = (hash ^ (unsigned char)*path++) * 16777619u;
+    }
+    return hash;
+}
+
+static int fs_watch_events_add(FSWatchEvents *events, char *path, int mask, bool directory) {
+    if ((events->count + 1) * 2 > events->table_size) {
+        uint32_t table_size = events->table_size ? events->table_size * 2 : 64;
+        uint32_t *table = calloc(table_size, sizeof(uint32_t));
+        if (!table) {
+            free(path);
+            return ENOMEM;
+        }
+
+        for (uint32_t i = 0; i < events->count; i++) {
+            uint32_t slot = fs_watch_hash(events->items[i].path) & (table_size - 1);
+            while (table[slot]) {
+                slot = (slot + 1) & (table_size - 1);
+            }
+            table[slot] = i + 1;
+        }
+
+        free(events->table);
+        events->table = table;
+        events->table_size = table_size;
+    }
+
+    uint32_t slot = fs_watch_hash(path) & (events->table_size - 1);
+    while (events->table[slot]) {
+        FSWatchEvent *event = &events->items[events->table[slot] - 1];
+        if (strcmp(event->path, path) == 0) {
+            event->events |= mask;
+            event->directory |= directory;
+            free(path);
+            return 0;
+        }
+        slot = (slot + 1) & (events->table_size - 1);
+    }
+
+    if (events->count == events->capacity) {
+        uint32_t capacity = events->capacity ? events->capacity * 2 : 32;
+        FSWatchEvent *items = realloc(events->items, capacity * sizeof(FSWatchEvent));
+        if (!items) {
+            free(path);
+            return ENOMEM;
+        }
+        events->items = items;
+        events->capacity = capacity;
+    }
+
+    events->items[events->count] = (FSWatchEvent){path, mask, directory};
+    events->table[slot] = ++events->count;
+    return 0;
+}
+
+static void fs_watch_events_free(FSWatchEvents *events) {
+    for (uint32_t i = 0; i < events->count; i++) {
+        free(events->items[i].path);
+    }
+    free(events->items);
+    free(events->table);
+}
+
+static char *fs_watch_join(const char *dir, const char *name, size_t name_length) {
+    size_t dir_length = strlen(dir);
+    bool separator = name_length > 0 && dir_length > 0 && dir[dir_length - 1] != '/';
+
+    char *path = malloc(dir_length + separator + name_length + 1);
+    if (!path) {
+        return NULL;
+    }
+
+    memcpy(path, dir, dir_length);
+    if (separator) {
+        path[dir_length] = '/';
+    }
+    memcpy(path + dir_length + separator, name, name_length);
+    path[dir_length + separator + name_length] = '\0';
+    return path;
+}
+
+static int fs_watch_add(FSWatcher *watcher, const char *path) {
+    int wd = inotify_add_watch(watcher->fd, path, FS_WATCH_MASK);
+    if (wd < 0) {
+        return errno;
+    }
+
+    if (wd >= watcher->path_count) {
+        int path_count = watcher->path_count ? watcher->path_count : 64;
+        while (path_count <= wd) {
+            path_count *= 2;
+        }
+
+        char **paths = realloc(watcher->paths, path_count * sizeof(char *));
+        if (!paths) {
+            return ENOMEM;
+        }
+        memset(paths + watcher->path_count, 0, (path_count - watcher->path_count) * sizeof(char *));
+        watcher->paths = paths;
+        watcher->path_count = path_count;
+    }
+
+    // Adding a directory again after it was moved within the tree returns its existing descriptor, events are reported
+    // under the new path from then on
+    char *copy = strdup(path);
+    if (!copy) {
+        return ENOMEM;
+    }
+    free(watcher->paths[wd]);
+    watcher->paths[wd] = copy;
+
+    return 0;
+}
+
+typedef struct {
+    FSWatcher *watcher;
+    const char *dir;
+    // Set for directories created while watching, their content is reported as created
+    FSWatchEvents *events;
+} FSWatchScan;
+
+static int fs_watch_add_tree(FSWatcher *watcher, const char *path, FSWatchEvents *events);
+
+static int fs_watch_scan_entry(void *opaque, const char *name, size_t name_length, int type) {
+    FSWatchScan *scan = opaque;
+    int error = 0;
+
+    if (type != FS_TYPE_DIRECTORY && !scan->events) {
+        return 0;
+    }
+
+    char *path = fs_watch_join(scan->dir, name, name_length);
+    if (!path) {
+        return ENOMEM;
+    }
+
+    if (type == FS_TYPE_DIRECTORY) {
+        error = fs_watch_add_tree(scan->watcher, path, scan->events);
+    }
+
+    if (scan->events && !error) {
+        // Entries may have been created before the watch on their directory existed, so they are reported here
+        return fs_watch_events_add(scan->events, path, FS_WATCH_CREATE, type == FS_TYPE_DIRECTORY);
+    }
+
+    free(path);
+    return error;
+}
+
+// Watches a directory and everything below it, symlinks are not followed
+static int fs_watch_add_tree(FSWatcher *watcher, const char *path, FSWatchEvents *events) {
+    FSWatchScan scan = {watcher, path, events};
+
+    int error = fs_watch_add(watcher, path);
+    if (error) {
+        // Directories that vanished or cannot be read are left out instead of failing the whole watch
+        return error == ENOMEM || error == ENOSPC ? error : 0;
+    }
+
+    error = yaje_fs_read_dir(path, fs_watch_scan_entry, &scan);
+    return error == ENOMEM || error == ENOSPC ? error : 0;
+}
+
+static int fs_watch_mask_events(uint32_t mask) {
+    int events = 0;
+
+    if (mask & IN_CREATE) {
+        events |= FS_WATCH_CREATE;
+    }
+    if (mask & IN_MODIFY) {
+        events |= FS_WATCH_MODIFY;
+    }
+    if (mask & IN_ATTRIB) {
+        events |= FS_WATCH_ATTRIB;
+    }
+    if (mask & (IN_DELETE | IN_DELETE_SELF)) {
+        events |= FS_WATCH_DELETE;
+    }
+    if (mask & (IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF)) {
+        events |= FS_WATCH_RENAME;
+    }
+
+    return events;
+}
+
+// Reads and merges all queued events, returns 0 or an errno value
+static int fs_watch_drain(FSWatcher *watcher, FSWatchEvents *events) {
+    while (true) {
+        ssize_t length = read(watcher->fd, watcher->buffer, FS_WATCH_BUFFER_SIZE);
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN ? 0 : errno;
+        }
+
+        for (ssize_t offset = 0; offset < length;) {
+            struct inotify_event *event = (struct inotify_event *)(watcher->buffer + offset);
+            offset += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                char *path = strdup(watcher->root);
+                if (!path || fs_watch_events_add(events, path, FS_WATCH_OVERFLOW, true)) {
+                    return ENOMEM;
+                }
+                continue;
+            }
+
+            if (event->wd < 0 || event->wd >= watcher->path_count || !watcher->paths[event->wd]) {
+                continue;
+            }
+
+            const char *dir = watcher->paths[event->wd];
+
+            if (event->mask & IN_IGNORED) {
+                // The watched path was deleted or unmounted, the kernel dropped its descriptor
+                free(watcher->paths[event->wd]);
+                watcher->paths[event->wd] = NULL;
+                continue;
+            }
+
+            int mask = fs_watch_mask_events(event->mask);
+            bool directory = (event->mask & IN_ISDIR) != 0;
+            // Events about a watched path itself carry no name
+            char *path = event->len > 0 ? fs_watch_join(dir, event->name, strlen(event->name)) : strdup(dir);
+            if (!path) {
+                return ENOMEM;
+            }
+
+            if (watcher->recursive && directory && (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+                int error = fs_watch_add_tree(watcher, path, events);
+                if (error) {
+                    free(path);
+                    return error;
+                }
+            }
+
+            if (mask && fs_watch_events_add(events, path, mask, directory)) {
+                return ENOMEM;
+            }
+            if (!mask) {
+                free(path);
+            }
+        }
+    }
+}
+
+static int64_t fs_watch_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// Waits up to timeout_ms (-1 forever) for the descriptor, returns 1 if readable, 0 on timeout or an -errno value
+static int fs_watch_poll(int fd, int timeout_ms) {
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+
+    while (true) {
+        int64_t start = fs_watch_now_ms();
+        int result = poll(&pfd, 1, timeout_ms);
+        if (result >= 0) {
+            return result;
+        }
+        if (errno != EINTR) {
+            return -errno;
+        }
+        if (timeout_ms > 0) {
+            timeout_ms -= (int)(fs_watch_now_ms() - start);
+            if (timeout_ms < 0) {
+                timeout_ms = 0;
+            }
+        }
+    }
+}
+
+static void fs_watcher_close(FSWatcher *watcher) {
+    if (watcher->fd >= 0) {
+        close(watcher->fd);
+        watcher->fd = -1;
+    }
+
+    for (int i = 0; i < watcher->path_count; i++) {
+        free(watcher->paths[i]);
+    }
+    free(watcher->paths);
+    watcher->paths = NULL;
+    watcher->path_count = 0;
+
+    free(watcher->buffer);
+    watcher->buffer = NULL;
+    free(watcher->root);
+    watcher->root = NULL;
+}
+
+static void fs_watcher_finalizer(JSRuntime *rt, JSValue val) {
+    FSWatcher *watcher = JS_GetOpaque(val, fs_watcher_class_id);
+    if (watcher) {
+        fs_watcher_close(watcher);
+        free(watcher);
+    }
+}
+
+static JSClassDef fs_watcher_class = {
+    .class_name = "FSWatcher",
+    .finalizer = fs_watcher_finalizer,
+};
+
+static FSWatcher *fs_watcher_get(JSContext *ctx, int argc, JSValueConst *argv) {
+    if (argc < 1) {
+        JS_ThrowTypeError(ctx, "Expected 1 argument: watcher");
+        return NULL;
+    }
+
+    FSWatcher *watcher = JS_GetOpaque(argv[0], fs_watcher_class_id);
+    if (!watcher) {
+        JS_ThrowTypeError(ctx, "Invalid watcher");
+        return NULL;
+    }
+
+    if (watcher->fd < 0) {
+        JS_ThrowTypeError(ctx, "Watcher is closed");
+        return NULL;
+    }
+
+    return watcher;
+}
+
+#endif
+
+static JSValue fs_watch_open(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifndef __linux__
+    return JS_ThrowInternalError(ctx, "Watching files is not supported on this platform");
+#else
+    const char *path;
+    int coalesce_ms;
+    struct stat st;
+    int error;
+
+    if (argc < 3) {
+        return JS_ThrowTypeError(ctx, "Expected 3 arguments: path, recursive and coalesceMs");
+    }
+
+    if (JS_ToInt32(ctx, &coalesce_ms, argv[2])) {
+        return JS_EXCEPTION;
+    }
+
+    FSWatcher *watcher = calloc(1, sizeof(FSWatcher));
+    if (!watcher) {
+        return JS_ThrowInternalError(ctx, "Memory allocation failed");
+    }
+
+    watcher->recursive = JS_ToBool(ctx, argv[1]);
+    watcher->coalesce_ms = coalesce_ms < 0 ? 0 : coalesce_ms;
+    watcher->buffer = malloc(FS_WATCH_BUFFER_SIZE);
+    watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (!watcher->buffer || watcher->fd < 0) {
+        error = watcher->buffer ? errno : ENOMEM;
+        fs_watcher_close(watcher);
+        free(watcher);
+        return JS_ThrowInternalError(ctx, "Failed to start watching: %s", strerror(error));
+    }
+
+    path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        fs_watcher_close(watcher);
+        free(watcher);
+        return JS_EXCEPTION;
+    }
+
+    watcher->root = strdup(path);
+    if (!watcher->root) {
+        error = ENOMEM;
+    } else if (stat(path, &st) != 0) {
+        error = errno;
+    } else if (watcher->recursive && S_ISDIR(st.st_mode)) {
+        error = fs_watch_add_tree(watcher, path, NULL);
+    } else {
+        error = fs_watch_add(watcher, path);
+    }
+    JS_FreeCString(ctx, path);
+
+    if (error) {
+        fs_watcher_close(watcher);
+        free(watcher);
+        if (error == ENOSPC) {
+            return JS_ThrowInternalError(ctx, "Failed to start watching: inotify watch limit reached (fs.inotify.max_user_watches)");
+        }
+        return JS_ThrowInternalError(ctx, "Failed to start watching: %s", strerror(error));
+    }
+
+    JSValue handle = JS_NewObjectClass(ctx, fs_watcher_class_id);
+    if (JS_IsException(handle)) {
+        fs_watcher_close(watcher);
+        free(watcher);
+        return JS_EXCEPTION;
+    }
+
+    JS_SetOpaque(handle, watcher);
+    return handle;
+#endif
+}
+
+static JSValue fs_watch_fd(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifndef __linux__
+    return JS_ThrowInternalError(ctx, "Watching files is not supported on this platform");
+#else
+    FSWatcher *watcher = fs_watcher_get(ctx, argc, argv);
+    if (!watcher) {
+        return JS_EXCEPTION;
+    }
+
+    return JS_NewInt32(ctx, watcher->fd);
+#endif
+}
+
+static JSValue fs_watch_next(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifndef __linux__
+    return JS_ThrowInternalError(ctx, "Watching files is not supported on this platform");
+#else
+    FSWatchEvents events = {0};
+    int timeout_ms;
+    int error = 0;
+
+    FSWatcher *watcher = fs_watcher_get(ctx, argc, argv);
+    if (!watcher) {
+        return JS_EXCEPTION;
+    }
+
+    if (argc < 2) {
+        return JS_ThrowTypeError(ctx, "Expected 2 arguments: watcher and timeoutMs");
+    }
+
+    if (JS_ToInt32(ctx, &timeout_ms, argv[1])) {
+        return JS_EXCEPTION;
+    }
+
+    int ready = fs_watch_poll(watcher->fd, timeout_ms < 0 ? -1 : timeout_ms);
+    if (ready < 0) {
+        error = -ready;
+    } else if (ready > 0) {
+        // A burst of writes produces one event per write, everything arriving within the window is merged per path
+        int64_t deadline = fs_watch_now_ms() + watcher->coalesce_ms;
+        while (!error) {
+            error = fs_watch_drain(watcher, &events);
+
+            int64_t remaining = deadline - fs_watch_now_ms();
+            if (error || remaining <= 0) {
+                break;
+            }
+
+            ready = fs_watch_poll(watcher->fd, (int)remaining);
+            if (ready <= 0) {
+                error = ready < 0 ? -ready : 0;
+                break;
+            }
+        }
+    }
+
+    if (error) {
+        fs_watch_events_free(&events);
+        return JS_ThrowInternalError(ctx, "Failed to read file events: %s", strerror(error));
+    }
+
+    JSValue result = JS_NewArray(ctx);
+    JSAtom path_atom = JS_NewAtom(ctx, "path");
+    JSAtom events_atom = JS_NewAtom(ctx, "events");
+    JSAtom directory_atom = JS_NewAtom(ctx, "directory");
+
+    for (uint32_t i = 0; i < events.count; i++) {
+        FSWatchEvent *event = &events.items[i];
+        JSValue entry = JS_NewObject(ctx);
+        JS_DefinePropertyValue(ctx, entry, path_atom, JS_NewString(ctx, event->path), JS_PROP_C_W_E);
+        JS_DefinePropertyValue(ctx, entry, events_atom, JS_NewInt32(ctx, event->events), JS_PROP_C_W_E);
+        JS_DefinePropertyValue(ctx, entry, directory_atom, JS_NewBool(ctx, event->directory), JS_PROP_C_W_E);
+        JS_DefinePropertyValueUint32(ctx, result, i, entry, JS_PROP_C_W_E);
+    }
+
+    JS_FreeAtom(ctx, path_atom);
+    JS_FreeAtom(ctx, events_atom);
+    JS_FreeAtom(ctx, directory_atom);
+    fs_watch_events_free(&events);
+    return result;
+#endif
+}
+
+static JSValue fs_watch_close(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef __linux__
+    FSWatcher *watcher;
+
+    if (argc < 1) {
+        return JS_ThrowTypeError(ctx, "Expected 1 argument: watcher");
+    }
+
+    watcher = JS_GetOpaque(argv[0], fs_watcher_class_id);
+    if (!watcher) {
+        return JS_ThrowTypeError(ctx, "Invalid watcher");
+    }
+
+    fs_watcher_close(watcher);
+#endif
+    return JS_UNDEFINED;
+}
+
+void yaje_fs_watch_init(JSRuntime *rt, JSContext *ctx, JSValue sync_fs) {
+#ifdef __linux__
+    JS_NewClassID(rt, &fs_watcher_class_id);
+    JS_NewClass(rt, fs_watcher_class_id, &fs_watcher_class);
+#endif
+
+    JS_SetPropertyStr(ctx, sync_fs, "watchOpen", JS_NewCFunction(ctx, fs_watch_open, "watchOpen", 3));
+    JS_SetPropertyStr(ctx, sync_fs, "watchFd", JS_NewCFunction(ctx, fs_watch_fd, "watchFd", 1));
+    JS_SetPropertyStr(ctx, sync_fs, "watchNext", JS_NewCFunction(ctx, fs_watch_next, "watchNext", 2));
+    JS_SetPropertyStr(ctx, sync_fs, "watchClose", JS_NewCFunction(ctx, fs_watch_close, "watchClose", 1));
+}
@@ -0,0 +1,442 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#endif
+
+#include "quickjs.h"
+#include "fs.h"
+
+// Flags of writerOpen, must match WriterFlags in src/writer.ts
+#define FS_WRITER_APPEND 1
+#define FS_WRITER_ATOMIC 2
+
+#ifndef _WIN32
+
+typedef struct {
+    int fd;
+    char *buffer;
+    size_t length;
+    size_t capacity;
+    // Atomic writers write into a temporary file next to path and rename it over path on close
+    char *path;
+    char *temp_path;
+} FSWriter;
+
+static JSClassID fs_writer_class_id;
+
+// Writes all iovecs, retrying partial writes, returns 0 or an errno value
+static int fs_writev_all(int fd, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+
+        while (count > 0 && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+
+    return 0;
+}
+
+// Writes the buffered data followed by data, both in a single writev, returns 0 or an errno value
+static int fs_writer_flush_with(FSWriter *writer, const char *data, size_t length) {
+    struct iovec iov[2];
+    int count = 0;
+
+    if (writer->length > 0) {
+        iov[count].iov_base = writer->buffer;
+        iov[count].iov_len = writer->length;
+        count++;
+    }
+
+    if (length > 0) {
+        iov[count].iov_base = (void *)data;
+        iov[count].iov_len = length;
+        count++;
+    }
+
+    int error = fs_writev_all(writer->fd, iov, count);
+    if (!error) {
+        writer->length = 0;
+    }
+
+    return error;
+}
+
+static int fs_writer_datasync(FSWriter *writer) {
+#if defined(__APPLE__)
+    // macOS has no fdatasync, fsync flushes the data and the metadata
+    return fsync(writer->fd) == 0 ? 0 : errno;
+#else
+    return fdatasync(writer->fd) == 0 ? 0 : errno;
+#endif
+}
+
+// Makes a rename durable by syncing the directory that contains the file
+static void fs_sync_parent_dir(const char *path) {
+    const char *slash = strrchr(path, '/');
+    char *dir = slash ? strndup(path, slash == path ? 1 : (size_t)(slash - path)) : strdup(".");
+    if (!dir) {
+        return;
+    }
+
+    int fd = open(dir, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+
+    free(dir);
+}
+
+// Closes the descriptor, an atomic writer with commit false leaves path untouched and removes its temporary file
+static int fs_writer_finish(FSWriter *writer, bool commit) {
+    int error = 0;
+
+    if (writer->fd < 0) {
+        return 0;
+    }
+
+    if (commit) {
+        error = fs_writer_flush_with(writer, NULL, 0);
+        // The data must be on disk before the rename, otherwise a crash can leave an empty file under the final name
+        if (!error && writer->temp_path && fsync(writer->fd) != 0) {
+            error = errno;
+        }
+    }
+
+    if (close(writer->fd) != 0 && !error) {
+        error = errno;
+    }
+    writer->fd = -1;
+
+    if (writer->temp_path) {
+        if (commit && !error) {
+            if (rename(writer->temp_path, writer->path) == 0) {
+                fs_sync_parent_dir(writer->path);
+            } else {
+                error = errno;
+            }
+        }
+
+        if (!commit || error) {
+            unlink(writer->temp_path);
+        }
+    }
+
+    return error;
+}
+
+static void fs_writer_free(FSWriter *writer) {
+    free(writer->buffer);
+    free(writer->path);
+    free(writer->temp_path);
+    free(writer);
+}
+
+static void fs_writer_finalizer(JSRuntime *rt, JSValue val) {
+    FSWriter *writer = JS_GetOpaque(val, fs_writer_class_id);
+    if (writer) {
+        // A normal writer keeps what was written, an atomic one that was never closed must not replace the file
+        fs_writer_finish(writer, writer->temp_path == NULL);
+        fs_writer_free(writer);
+    }
+}
+
+static JSClassDef fs_writer_class = {
+    .class_name = "FSWriter",
+    .finalizer = fs_writer_finalizer,
+};
+
+static FSWriter *fs_writer_get(JSContext *ctx, int argc, JSValueConst *argv) {
+    if (argc < 1) {
+        JS_ThrowTypeError(ctx, "Expected 1 argument: writer");
+        return NULL;
+    }
+
+    FSWriter *writer = JS_GetOpaque(argv[0], fs_writer_class_id);
+    if (!writer) {
+        JS_ThrowTypeError(ctx, "Invalid writer");
+        return NULL;
+    }
+
+    if (writer->fd < 0) {
+        JS_ThrowTypeError(ctx, "Writer is closed");
+        return NULL;
+    }
+
+    return writer;
+}
+
+#endif
+
+static JSValue fs_writer_open(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Writers are not supported on this platform");
+#else
+    const char *path;
+    uint64_t buffer_size;
+    int flags;
+    FSWriter *writer;
+
+    if (argc < 3) {
+        return JS_ThrowTypeError(ctx, "Expected 3 arguments: path, bufferSize and flags");
+    }
+
+    if (JS_ToIndex(ctx, &buffer_size, argv[1])) {
+        return JS_EXCEPTION;
+    }
+
+    if (JS_ToInt32(ctx, &flags, argv[2])) {
+        return JS_EXCEPTION;
+    }
+
+    if ((flags & FS_WRITER_APPEND) && (flags & FS_WRITER_ATOMIC)) {
+        return JS_ThrowTypeError(ctx, "A writer cannot both append and replace atomically");
+    }
+
+    writer = calloc(1, sizeof(FSWriter));
+    if (!writer) {
+        return JS_ThrowInternalError(ctx, "Memory allocation failed");
+    }
+    writer->fd = -1;
+
+    if (buffer_size > 0) {
+        writer->buffer = malloc(buffer_size);
+        if (!writer->buffer) {
+            fs_writer_free(writer);
+            return JS_ThrowInternalError(ctx, "Memory allocation failed");
+        }
+        writer->capacity = buffer_size;
+    }
+
+    path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        fs_writer_free(writer);
+        return JS_EXCEPTION;
+    }
+
+    if (flags & FS_WRITER_ATOMIC) {
+        size_t path_length = strlen(path);
+        writer->path = strdup(path);
+        writer->temp_path = malloc(path_length + sizeof(".XXXXXX"));
+        JS_FreeCString(ctx, path);
+
+        if (!writer->path || !writer->temp_path) {
+            fs_writer_free(writer);
+            return JS_ThrowInternalError(ctx, "Memory allocation failed");
+        }
+
+        // The temporary file lives in the same directory, a rename is only atomic within one file system
+        memcpy(writer->temp_path, writer->path, path_length);
+        memcpy(writer->temp_path + path_length, ".XXXXXX", sizeof(".XXXXXX"));
+
+        writer->fd = mkstemp(writer->temp_path);
+        if (writer->fd < 0) {
+            int error = errno;
+            fs_writer_free(writer);
+            return JS_ThrowInternalError(ctx, "Failed to open file: %s", strerror(error));
+        }
+        fcntl(writer->fd, F_SETFD, FD_CLOEXEC);
+
+        // mkstemp creates the file as 0600, the replacement gets the mode of the file it replaces
+        struct stat st;
+        if (stat(writer->path, &st) == 0) {
+            fchmod(writer->fd, st.st_mode & 07777);
+        } else {
+            mode_t mask = umask(0);
+            umask(mask);
+            fchmod(writer->fd, 0666 & ~mask);
+        }
+    } else {
+        int open_flags = O_WRONLY | O_CREAT | O_CLOEXEC | ((flags & FS_WRITER_APPEND) ? O_APPEND : O_TRUNC);
+        writer->fd = open(path, open_flags, 0666);
+        JS_FreeCString(ctx, path);
+
+        if (writer->fd < 0) {
+            int error = errno;
+            fs_writer_free(writer);
+            return JS_ThrowInternalError(ctx, "Failed to open file: %s", strerror(error));
+        }
+    }
+
+    JSValue handle = JS_NewObjectClass(ctx, fs_writer_class_id);
+    if (JS_IsException(handle)) {
+        fs_writer_finish(writer, false);
+        fs_writer_free(writer);
+        return JS_EXCEPTION;
+    }
+
+    JS_SetOpaque(handle, writer);
+    return handle;
+#endif
+}
+
+static JSValue fs_writer_write(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Writers are not supported on this platform");
+#else
+    FSWriter *writer;
+    const char *string = NULL;
+    const char *data;
+    size_t length;
+    int error = 0;
+
+    writer = fs_writer_get(ctx, argc, argv);
+    if (!writer) {
+        return JS_EXCEPTION;
+    }
+
+    if (argc < 2) {
+        return JS_ThrowTypeError(ctx, "Expected 2 arguments: writer and data");
+    }
+
+    // Bytes are written as they are, anything else as its UTF-8 string
+    if (JS_IsArrayBuffer(argv[1])) {
+        data = (const char *)JS_GetArrayBuffer(ctx, &length, argv[1]);
+        if (!data) {
+            return JS_EXCEPTION;
+        }
+    } else if (JS_GetTypedArrayType(argv[1]) >= 0) {
+        size_t offset;
+        JSValue buffer = JS_GetTypedArrayBuffer(ctx, argv[1], &offset, &length, NULL);
+        if (JS_IsException(buffer)) {
+            return JS_EXCEPTION;
+        }
+
+        size_t buffer_length;
+        data = (const char *)JS_GetArrayBuffer(ctx, &buffer_length, buffer);
+        JS_FreeValue(ctx, buffer);
+        if (!data) {
+            return JS_EXCEPTION;
+        }
+        data += offset;
+    } else {
+        string = JS_ToCStringLen(ctx, &length, argv[1]);
+        if (!string) {
+            return JS_EXCEPTION;
+        }
+        data = string;
+    }
+
+    if (writer->length + length <= writer->capacity) {
+        // An unbuffered writer has no buffer, memcpy must not get its NULL pointer even for an empty write
+        if (length > 0) {
+            memcpy(writer->buffer + writer->length, data, length);
+            writer->length += length;
+        }
+    } else {
+        // Data that does not fit goes out together with the buffer instead of being copied into it first
+        error = fs_writer_flush_with(writer, data, length);
+    }
+
+    if (string) {
+        JS_FreeCString(ctx, string);
+    }
+
+    if (error) {
+        return JS_ThrowInternalError(ctx, "Failed to write to file: %s", strerror(error));
+    }
+
+    return JS_UNDEFINED;
+#endif
+}
+
+static JSValue fs_writer_flush(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Writers are not supported on this platform");
+#else
+    FSWriter *writer = fs_writer_get(ctx, argc, argv);
+    if (!writer) {
+        return JS_EXCEPTION;
+    }
+
+    int error = fs_writer_flush_with(writer, NULL, 0);
+    if (error) {
+        return JS_ThrowInternalError(ctx, "Failed to write to file: %s", strerror(error));
+    }
+
+    return JS_UNDEFINED;
+#endif
+}
+
+static JSValue fs_writer_datasync_fn(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Writers are not supported on this platform");
+#else
+    FSWriter *writer = fs_writer_get(ctx, argc, argv);
+    if (!writer) {
+        return JS_EXCEPTION;
+    }
+
+    int error = fs_writer_flush_with(writer, NULL, 0);
+    if (!error) {
+        error = fs_writer_datasync(writer);
+    }
+
+    if (error) {
+        return JS_ThrowInternalError(ctx, "Failed to sync file: %s", strerror(error));
+    }
+
+    return JS_UNDEFINED;
+#endif
+}
+
+static JSValue fs_writer_close_common(JSContext *ctx, int argc, JSValueConst *argv, bool commit) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Writers are not supported on this platform");
+#else
+    FSWriter *writer = fs_writer_get(ctx, argc, argv);
+    if (!writer) {
+        return JS_EXCEPTION;
+    }
+
+    int error = fs_writer_finish(writer, commit);
+    if (error) {
+        return JS_ThrowInternalError(ctx, "Failed to close file: %s", strerror(error));
+    }
+
+    return JS_UNDEFINED;
+#endif
+}
+
+static JSValue fs_writer_close(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    return fs_writer_close_common(ctx, argc, argv, true);
+}
+
+static JSValue fs_writer_abort(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    return fs_writer_close_common(ctx, argc, argv, false);
+}
+
+void yaje_fs_writer_init(JSRuntime *rt, JSContext *ctx, JSValue sync_fs) {
+#ifndef _WIN32
+    JS_NewClassID(rt, &fs_writer_class_id);
+    JS_NewClass(rt, fs_writer_class_id, &fs_writer_class);
+#endif
+
+    JS_SetPropertyStr(ctx, sync_fs, "writerOpen", JS_NewCFunction(ctx, fs_writer_open, "writerOpen", 3));
+    JS_SetPropertyStr(ctx, sync_fs, "writerWrite", JS_NewCFunction(ctx, fs_writer_write, "writerWrite", 2));
+    JS_SetPropertyStr(ctx, sync_fs, "writerFlush", JS_NewCFunction(ctx, fs_writer_flush, "writerFlush", 1));
+    JS_SetPropertyStr(ctx, sync_fs, "writerDatasync", JS_NewCFunction(ctx, fs_writer_datasync_fn, "writerDatasync", 1));
+    JS_SetPropertyStr(ctx, sync_fs, "writerClose", JS_NewCFunction(ctx, fs_writer_close, "writerClose", 1));
+    JS_SetPropertyStr(ctx, sync_fs, "writerAbort", JS_NewCFunction(ctx, fs_writer_abort, "writerAbort", 1));
+}
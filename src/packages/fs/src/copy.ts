@@ -0,0 +1,77 @@
+import "@yaje/core";
+
+/**
+ * Flags of copyFileSync, they can be combined with a bitwise or.
+ */
+export const enum CopyFlags {
+    NONE = 0,
+    /**
+     * Fails if the destination already exists.
+     */
+    EXCL = 1,
+    /**
+     * Fails if the file system cannot share the extents of the source (reflink) instead of falling back to a copy.
+     */
+    CLONE_FORCE = 2,
+    /**
+     * Always copies the data, even where a reflink would be possible.
+     */
+    NO_CLONE = 4
+}
+
+/**
+ * Interface for the copy and move operations of the "fs.sync" native module. The data is copied by the kernel and never
+ * enters JS memory.
+ */
+interface CopyFS {
+    /**
+     * Copies a file including its permissions. A reflink is tried first, then copy_file_range, sendfile and finally a
+     * plain read/write loop.
+     *
+     * @param source      - The path to the file to copy.
+     * @param destination - The path to the copy, an existing file is replaced.
+     * @param flags       - A combination of CopyFlags.
+     */
+    copyFile(source: string, destination: string, flags: CopyFlags): void;
+
+    /**
+     * Copies a range of bytes from one file into another. The destination is created if needed but neither truncated
+     * nor otherwise changed outside the range.
+     *
+     * @param source            - The path to the file to copy from.
+     * @param sourceOffset      - The offset in the source to start at.
+     * @param destination       - The path to the file to copy to.
+     * @param destinationOffset - The offset in the destination to write to.
+     * @param length            - The number of bytes to copy.
+     *
+     * @returns The number of bytes copied, less than length if the source ended first.
+     */
+    copyRange(source: string, sourceOffset: number, destination: string, destinationOffset: number, length: number): number;
+
+    /**
+     * Renames a file, replacing an existing destination. Files are moved across file systems by copying them and
+     * removing the source.
+     *
+     * @param source      - The current path.
+     * @param destination - The new path.
+     */
+    rename(source: string, destination: string): void;
+}
+
+const native: CopyFS = Native.getModule("fs.sync");
+
+export const copy = {
+    native
+}
+
+export function copyFileSync(source: string, destination: string, flags: CopyFlags = CopyFlags.NONE): void {
+    native.copyFile(source, destination, flags);
+}
+
+export function copyRangeSync(source: string, sourceOffset: number, destination: string, destinationOffset: number, length: number): number {
+    return native.copyRange(source, sourceOffset, destination, destinationOffset, length);
+}
+
+export function renameSync(source: string, destination: string): void {
+    native.rename(source, destination);
+}
@@ -0,0 +1,270 @@
+import "@yaje/core";
+
+export const enum FileType {
+    UNKNOWN,
+    FILE,
+    DIRECTORY,
+    SYMLINK,
+    BLOCK_DEVICE,
+    CHARACTER_DEVICE,
+    FIFO,
+    SOCKET
+}
+
+/**
+ * Index of every field in the array returned by the native stat and lstat.
+ */
+const enum StatField {
+    DEV,
+    INO,
+    MODE,
+    NLINK,
+    UID,
+    GID,
+    RDEV,
+    SIZE,
+    BLKSIZE,
+    BLOCKS,
+    ATIME_MS,
+    MTIME_MS,
+    CTIME_MS
+}
+
+const S_IFMT: number = 0o170000;
+
+/**
+ * An entry of a directory listing.
+ */
+export interface DirEntry {
+    name: string;
+    type: FileType;
+}
+
+/**
+ * An entry found while walking a directory tree, the path starts with the root that was walked.
+ */
+export interface WalkEntry {
+    path: string;
+    type: FileType;
+}
+
+export interface WalkOptions {
+    /**
+     * Called for every entry on the calling thread, entries for which it returns false are not yielded. Directories are
+     * still descended into, use exclude to prune them.
+     */
+    filter?: (entry: WalkEntry) => boolean;
+    /**
+     * Number of threads reading directories, defaults to the number of CPUs.
+     */
+    threads?: number;
+    /**
+     * Names of entries to skip, matching directories are not descended into (e.g. "node_modules" or ".git").
+     */
+    exclude?: string[];
+}
+
+/**
+ * Opaque handle of a running walk.
+ */
+interface Walker {
+}
+
+/**
+ * Interface for the directory and metadata operations of the "fs.sync" native module.
+ */
+interface DirFS {
+    /**
+     * Lists a directory without the "." and ".." entries, the order is the one of the file system.
+     *
+     * @param path - The path to the directory.
+     *
+     * @returns The entries, their type comes from the directory itself and costs no stat.
+     */
+    readdir(path: string): DirEntry[];
+
+    /**
+     * Returns the metadata of a file, following symlinks.
+     *
+     * @param path - The path to the file.
+     *
+     * @returns The fields in StatField order.
+     */
+    stat(path: string): Float64Array;
+
+    /**
+     * Returns the metadata of a file without following a symlink.
+     *
+     * @param path - The path to the file.
+     *
+     * @returns The fields in StatField order.
+     */
+    lstat(path: string): Float64Array;
+
+    /**
+     * Starts walking a directory tree on a pool of threads. Symlinks are reported but never followed, directories that
+     * cannot be read are skipped.
+     *
+     * @param root    - The directory to walk.
+     * @param threads - The number of threads, 0 picks the number of CPUs.
+     * @param exclude - Names of entries to skip.
+     *
+     * @returns A handle for walkNext and walkClose.
+     */
+    walkOpen(root: string, threads: number, exclude: string[]): Walker;
+
+    /**
+     * Waits for the next batch of entries.
+     *
+     * @param walker - The walk handle.
+     *
+     * @returns The entries or null once the walk is finished.
+     */
+    walkNext(walker: Walker): WalkEntry[] | null;
+
+    /**
+     * Stops a walk and its threads, a walk that is not closed is stopped once the handle is collected.
+     *
+     * @param walker - The walk handle.
+     */
+    walkClose(walker: Walker): void;
+}
+
+const native: DirFS = Native.getModule("fs.sync");
+
+export const dir = {
+    native
+}
+
+export class Stats {
+    private readonly fields: Float64Array;
+
+    public constructor(fields: Float64Array) {
+        this.fields = fields;
+    }
+
+    public get dev(): number {
+        return this.fields[StatField.DEV]!;
+    }
+
+    public get ino(): number {
+        return this.fields[StatField.INO]!;
+    }
+
+    public get mode(): number {
+        return this.fields[StatField.MODE]!;
+    }
+
+    public get nlink(): number {
+        return this.fields[StatField.NLINK]!;
+    }
+
+    public get uid(): number {
+        return this.fields[StatField.UID]!;
+    }
+
+    public get gid(): number {
+        return this.fields[StatField.GID]!;
+    }
+
+    public get rdev(): number {
+        return this.fields[StatField.RDEV]!;
+    }
+
+    public get size(): number {
+        return this.fields[StatField.SIZE]!;
+    }
+
+    public get blksize(): number {
+        return this.fields[StatField.BLKSIZE]!;
+    }
+
+    public get blocks(): number {
+        return this.fields[StatField.BLOCKS]!;
+    }
+
+    public get atimeMs(): number {
+        return this.fields[StatField.ATIME_MS]!;
+    }
+
+    public get mtimeMs(): number {
+        return this.fields[StatField.MTIME_MS]!;
+    }
+
+    public get ctimeMs(): number {
+        return this.fields[StatField.CTIME_MS]!;
+    }
+
+    public get type(): FileType {
+        switch (this.mode & S_IFMT) {
+            case 0o100000:
+                return FileType.FILE;
+            case 0o040000:
+                return FileType.DIRECTORY;
+            case 0o120000:
+                return FileType.SYMLINK;
+            case 0o060000:
+                return FileType.BLOCK_DEVICE;
+            case 0o020000:
+                return FileType.CHARACTER_DEVICE;
+            case 0o010000:
+                return FileType.FIFO;
+            case 0o140000:
+                return FileType.SOCKET;
+            default:
+                return FileType.UNKNOWN;
+        }
+    }
+
+    public isFile(): boolean {
+        return this.type == FileType.FILE;
+    }
+
+    public isDirectory(): boolean {
+        return this.type == FileType.DIRECTORY;
+    }
+
+    public isSymbolicLink(): boolean {
+        return this.type == FileType.SYMLINK;
+    }
+}
+
+export function readdirSync(path: string): DirEntry[] {
+    return native.readdir(path);
+}
+
+export function statSync(path: string): Stats {
+    return new Stats(native.stat(path));
+}
+
+export function lstatSync(path: string): Stats {
+    return new Stats(native.lstat(path));
+}
+
+/**
+ * Walks a directory tree and yields its entries in batches as the threads find them, the order is not deterministic.
+ * Breaking out of the loop stops the walk.
+ *
+ * @param root    - The directory to walk.
+ * @param options - Filter, thread count and excluded names.
+ */
+export function* walkSync(root: string, options: WalkOptions = {}): Generator<WalkEntry[], void, undefined> {
+    const {filter, threads = 0, exclude = []} = options;
+    const walker: Walker = native.walkOpen(root, threads, exclude);
+
+    try {
+        let batch: WalkEntry[] | null;
+        while ((batch = native.walkNext(walker)) !== null) {
+            if (filter) {
+                batch = batch.filter(filter);
+                if (batch.length == 0) {
+                    continue;
+                }
+            }
+
+            yield batch;
+        }
+    } finally {
+        native.walkClose(walker);
+    }
+}
@@ -1 +1,5 @@
-export * from "./sync.js";
\ No newline at end of file
+export * from "./sync.js";
+export * from "./dir.js";
+export * from "./copy.js";
+export * from "./writer.js";
+export * from "./watch.js";
\ No newline at end of file
@@ -0,0 +1,140 @@
+import "@yaje/core";
+
+/**
+ * Kinds of changes, an event carries all kinds that happened to its path within the coalescing window.
+ */
+export const enum WatchEvent {
+    CREATE = 1,
+    MODIFY = 2,
+    DELETE = 4,
+    RENAME = 8,
+    ATTRIB = 16,
+    /**
+     * Events were lost because the kernel queue overflowed, the path is the watched root and has to be rescanned.
+     */
+    OVERFLOW = 32
+}
+
+export interface WatchChange {
+    path: string;
+    events: WatchEvent;
+    directory: boolean;
+}
+
+export interface WatchOptions {
+    /**
+     * Watches all directories below the path, including the ones created later.
+     */
+    recursive?: boolean;
+    /**
+     * Time in milliseconds that events are collected and merged per path after the first one arrived. Defaults to 50.
+     */
+    coalesceMs?: number;
+}
+
+/**
+ * Opaque handle of a watch.
+ */
+interface WatcherHandle {
+}
+
+/**
+ * Interface for the inotify based watches of the "fs.sync" native module.
+ */
+interface WatchFS {
+    /**
+     * Starts watching a file or directory.
+     *
+     * @param path       - The path to watch.
+     * @param recursive  - Whether directories below path are watched too.
+     * @param coalesceMs - The coalescing window in milliseconds.
+     *
+     * @returns A handle for the other watch functions.
+     */
+    watchOpen(path: string, recursive: boolean, coalesceMs: number): WatcherHandle;
+
+    /**
+     * Returns the inotify descriptor, it is readable whenever changes are pending.
+     *
+     * @param watcher - The watch handle.
+     *
+     * @returns The file descriptor.
+     */
+    watchFd(watcher: WatcherHandle): number;
+
+    /**
+     * Waits for changes and returns them merged per path.
+     *
+     * @param watcher   - The watch handle.
+     * @param timeoutMs - The time to wait for the first change, -1 waits forever and 0 only collects pending changes.
+     *
+     * @returns The changes, empty if none arrived in time.
+     */
+    watchNext(watcher: WatcherHandle, timeoutMs: number): WatchChange[];
+
+    /**
+     * Stops watching, a watch that is not closed is stopped once the handle is collected.
+     *
+     * @param watcher - The watch handle.
+     */
+    watchClose(watcher: WatcherHandle): void;
+}
+
+const native: WatchFS = Native.getModule("fs.sync");
+
+export const watcher = {
+    native
+}
+
+/**
+ * A running watch, the callback is called from next() on the calling thread.
+ */
+export class Watcher {
+    private readonly handle: WatcherHandle;
+    private readonly callback: (change: WatchChange) => void;
+
+    public constructor(handle: WatcherHandle, callback: (change: WatchChange) => void) {
+        this.handle = handle;
+        this.callback = callback;
+    }
+
+    /**
+     * The descriptor to wait on in an own poll loop before calling next(0).
+     */
+    public get fd(): number {
+        return native.watchFd(this.handle);
+    }
+
+    /**
+     * Waits for changes and passes each of them to the callback.
+     *
+     * @param timeoutMs - The time to wait for the first change, -1 waits forever and 0 only handles pending changes.
+     *
+     * @returns The number of changes handled.
+     */
+    public next(timeoutMs: number = -1): number {
+        const changes: WatchChange[] = native.watchNext(this.handle, timeoutMs);
+        for (const change of changes) {
+            this.callback(change);
+        }
+
+        return changes.length;
+    }
+
+    public close(): void {
+        native.watchClose(this.handle);
+    }
+}
+
+/**
+ * Watches a file or directory with inotify (Linux only). Bursts of changes, like many writes to one file, are merged
+ * natively into a single change per path before they reach JS.
+ *
+ * @param path     - The path to watch.
+ * @param options  - Recursion and coalescing window.
+ * @param callback - Called for every change.
+ */
+export function watch(path: string, options: WatchOptions, callback: (change: WatchChange) => void): Watcher {
+    const {recursive = false, coalesceMs = 50} = options;
+    return new Watcher(native.watchOpen(path, recursive, coalesceMs), callback);
+}
@@ -0,0 +1,136 @@
+import "@yaje/core";
+
+/**
+ * Flags of the native writerOpen, must match native/writer.c.
+ */
+const enum WriterFlags {
+    NONE = 0,
+    APPEND = 1,
+    ATOMIC = 2
+}
+
+export interface WriterOptions {
+    /**
+     * Size of the native buffer in bytes, 0 writes every call through. Defaults to 64 KiB.
+     */
+    bufferSize?: number;
+    /**
+     * Appends to the file instead of truncating it.
+     */
+    append?: boolean;
+    /**
+     * Writes into a temporary file that replaces the file on close, readers see either the old or the complete new
+     * content. Cannot be combined with append.
+     */
+    atomic?: boolean;
+}
+
+/**
+ * Opaque handle of an open writer.
+ */
+interface WriterHandle {
+}
+
+/**
+ * Interface for the buffered writers of the "fs.sync" native module.
+ */
+interface WriterFS {
+    /**
+     * Opens a file for buffered writing.
+     *
+     * @param path       - The path to the file.
+     * @param bufferSize - The size of the buffer in bytes.
+     * @param flags      - A combination of WriterFlags.
+     *
+     * @returns A handle for the other writer functions.
+     */
+    writerOpen(path: string, bufferSize: number, flags: WriterFlags): WriterHandle;
+
+    /**
+     * Appends data to the buffer, writing the buffer and the data with a single writev once it does not fit.
+     *
+     * @param writer - The writer handle.
+     * @param data   - A string, written as UTF-8, or bytes.
+     */
+    writerWrite(writer: WriterHandle, data: string | ArrayBuffer | ArrayBufferView): void;
+
+    /**
+     * Writes the buffer to the file.
+     *
+     * @param writer - The writer handle.
+     */
+    writerFlush(writer: WriterHandle): void;
+
+    /**
+     * Writes the buffer and waits until the data is on disk.
+     *
+     * @param writer - The writer handle.
+     */
+    writerDatasync(writer: WriterHandle): void;
+
+    /**
+     * Writes the buffer and closes the file, an atomic writer replaces the file now.
+     *
+     * @param writer - The writer handle.
+     */
+    writerClose(writer: WriterHandle): void;
+
+    /**
+     * Closes the file without writing the buffer, an atomic writer leaves the file untouched.
+     *
+     * @param writer - The writer handle.
+     */
+    writerAbort(writer: WriterHandle): void;
+}
+
+const native: WriterFS = Native.getModule("fs.sync");
+
+export const writer = {
+    native
+}
+
+/**
+ * A file opened for writing many small pieces, the data is collected in a native buffer and written in large chunks.
+ * A writer that is not closed is closed once it is collected, an atomic one without replacing the file.
+ */
+export class Writer {
+    private readonly handle: WriterHandle;
+
+    public constructor(handle: WriterHandle) {
+        this.handle = handle;
+    }
+
+    public write(data: string | ArrayBuffer | ArrayBufferView): void {
+        native.writerWrite(this.handle, data);
+    }
+
+    public flush(): void {
+        native.writerFlush(this.handle);
+    }
+
+    public fdatasync(): void {
+        native.writerDatasync(this.handle);
+    }
+
+    public close(): void {
+        native.writerClose(this.handle);
+    }
+
+    public abort(): void {
+        native.writerAbort(this.handle);
+    }
+}
+
+export function openWriter(path: string, options: WriterOptions = {}): Writer {
+    const {bufferSize = 64 * 1024, append = false, atomic = false} = options;
+
+    let flags: WriterFlags = WriterFlags.NONE;
+    if (append) {
+        flags |= WriterFlags.APPEND;
+    }
+    if (atomic) {
+        flags |= WriterFlags.ATOMIC;
+    }
+
+    return new Writer(native.writerOpen(path, bufferSize, flags));
+}
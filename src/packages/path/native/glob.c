@@ -0,0 +1,878 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "quickjs.h"
+#include "path.h"
+
+// Upper bound for the patterns a single glob expands to through braces
+#define GLOB_MAX_EXPANSIONS 1024
+
+enum {
+    GLOB_SEGMENT_LITERAL,
+    GLOB_SEGMENT_PATTERN,
+    // "**", matches any number of directories
+    GLOB_SEGMENT_GLOBSTAR,
+    // Ends every pattern, a path that reaches it is matched
+    GLOB_SEGMENT_ACCEPT
+};
+
+typedef struct {
+    int type;
+    // Unescaped text of literals, pattern source otherwise
+    char *text;
+    size_t length;
+    // Set on the accept segment of patterns ending with a slash
+    bool directory_only;
+} GlobSegment;
+
+// All brace expansions of a pattern are compiled into one list of segments, each pattern ends with an accept segment.
+// Matching runs all of them at once: a path state is the set of segment indices reached so far.
+typedef struct {
+    GlobSegment *segments;
+    int segment_count;
+    int start_count;
+    int *starts;
+    // uint64_t words of a state set
+    int word_count;
+    bool absolute;
+    bool dot;
+} Glob;
+
+static JSClassID glob_class_id;
+
+static void glob_free(Glob *glob) {
+    for (int i = 0; i < glob->segment_count; i++) {
+        free(glob->segments[i].text);
+    }
+    free(glob->segments);
+    free(glob->starts);
+    free(glob);
+}
+
+static size_t glob_utf8_length(unsigned char c) {
+    if (c < 0xC0) {
+        return 1;
+    }
+    return c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+}
+
+// Decodes one character, bytes that are not valid UTF-8 are taken as they are
+static uint32_t glob_utf8_decode(const char **p, const char *end) {
+    const unsigned char *s = (const unsigned char *)*p;
+    size_t length = glob_utf8_length(*s);
+
+    if (length == 1 || (const char *)s + length > end) {
+        (*p)++;
+        return *s;
+    }
+
+    uint32_t c = *s & (0x7F >> length);
+    for (size_t i = 1; i < length; i++) {
+        c = (c << 6) | (s[i] & 0x3F);
+    }
+
+    *p += length;
+    return c;
+}
+
+// Matches one character of name against the class starting at the "[" at *p, moves *p behind the class.
+// Returns -1 if the class is not terminated, the "[" is a literal then.
+static int glob_match_class(const char **p, const char *pe, uint32_t c) {
+    const char *q = *p + 1;
+    bool negate = q < pe && (*q == '!' || *q == '^');
+    bool matched = false;
+
+    if (negate) {
+        q++;
+    }
+
+    // A "]" right at the start is part of the class
+    for (bool first = true; q < pe && (*q != ']' || first); first = false) {
+        if (*q == '\\' && q + 1 < pe) {
+            q++;
+        }
+        uint32_t low = glob_utf8_decode(&q, pe);
+        uint32_t high = low;
+
+        if (q + 1 < pe && *q == '-' && q[1] != ']') {
+            q++;
+            if (*q == '\\' && q + 1 < pe) {
+                q++;
+            }
+            high = glob_utf8_decode(&q, pe);
+        }
+
+        if (c >= low && c <= high) {
+            matched = true;
+        }
+    }
+
+    if (q >= pe) {
+        return -1;
+    }
+
+    *p = q + 1;
+    return matched != negate;
+}
+
+// Matches a single path segment against a pattern with "*", "?", "[...]" and "\" escapes
+static bool glob_match(const char *p, const char *pe, const char *s, const char *se) {
+    const char *star_p = NULL;
+    const char *star_s = NULL;
+
+    while (s < se) {
+        if (p < pe && *p == '*') {
+            while (p < pe && *p == '*') {
+                p++;
+            }
+            if (p == pe) {
+                return true;
+            }
+            star_p = p;
+            star_s = s;
+            continue;
+        }
+
+        if (p < pe) {
+            const char *next_p = p;
+            const char *next_s = s;
+            bool matched;
+
+            if (*p == '?') {
+                glob_utf8_decode(&next_s, se);
+                next_p++;
+                matched = true;
+            } else if (*p == '[') {
+                uint32_t c = glob_utf8_decode(&next_s, se);
+                int result = glob_match_class(&next_p, pe, c);
+                if (result < 0) {
+                    next_s = s + 1;
+                    next_p = p + 1;
+                    matched = *s == '[';
+                } else {
+                    matched = result;
+                }
+            } else {
+                if (*p == '\\' && p + 1 < pe) {
+                    next_p++;
+                }
+                matched = *next_p == *s;
+                next_p++;
+                next_s++;
+            }
+
+            if (matched) {
+                p = next_p;
+                s = next_s;
+                continue;
+            }
+        }
+
+        // Let the last "*" take one more character and retry from there
+        if (!star_p) {
+            return false;
+        }
+        glob_utf8_decode(&star_s, se);
+        p = star_p;
+        s = star_s;
+    }
+
+    while (p < pe && *p == '*') {
+        p++;
+    }
+    return p == pe;
+}
+
+static bool glob_segment_matches(const Glob *glob, const GlobSegment *segment, const char *name, size_t name_length) {
+    if (segment->type == GLOB_SEGMENT_LITERAL) {
+        return segment->length == name_length && memcmp(segment->text, name, name_length) == 0;
+    }
+
+    // Hidden entries are only matched by wildcards if dot is set or the pattern itself starts with a dot
+    if (name[0] == '.' && !glob->dot && segment->text[0] != '.') {
+        return false;
+    }
+
+    return glob_match(segment->text, segment->text + segment->length, name, name + name_length);
+}
+
+static inline bool glob_state_has(const uint64_t *states, int index) {
+    return (states[index >> 6] >> (index & 63)) & 1;
+}
+
+static inline void glob_state_add(uint64_t *states, int index) {
+    states[index >> 6] |= (uint64_t)1 << (index & 63);
+}
+
+// "**" also matches no directory at all, so reaching it reaches the segment after it too
+static void glob_closure(const Glob *glob, uint64_t *states) {
+    for (int i = 0; i < glob->segment_count; i++) {
+        if (glob_state_has(states, i) && glob->segments[i].type == GLOB_SEGMENT_GLOBSTAR) {
+            glob_state_add(states, i + 1);
+        }
+    }
+}
+
+// Advances states over one path segment, follow_globstar is false to stop "**" from continuing below the segment
+static void glob_step(const Glob *glob, const uint64_t *states, const char *name, size_t name_length,
+                      bool follow_globstar, uint64_t *next) {
+    memset(next, 0, glob->word_count * sizeof(uint64_t));
+
+    for (int i = 0; i < glob->segment_count; i++) {
+        if (!glob_state_has(states, i)) {
+            continue;
+        }
+
+        const GlobSegment *segment = &glob->segments[i];
+        switch (segment->type) {
+            case GLOB_SEGMENT_GLOBSTAR:
+                if (follow_globstar && (name[0] != '.' || glob->dot)) {
+                    glob_state_add(next, i);
+                }
+                break;
+            case GLOB_SEGMENT_LITERAL:
+            case GLOB_SEGMENT_PATTERN:
+                if (glob_segment_matches(glob, segment, name, name_length)) {
+                    glob_state_add(next, i + 1);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    glob_closure(glob, next);
+}
+
+// Returns whether the states match a path, is_directory tells whether the path is a directory
+static bool glob_accepts(const Glob *glob, const uint64_t *states, bool is_directory) {
+    for (int i = 0; i < glob->segment_count; i++) {
+        const GlobSegment *segment = &glob->segments[i];
+        if (segment->type == GLOB_SEGMENT_ACCEPT && glob_state_has(states, i) &&
+            (is_directory || !segment->directory_only)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns whether any pattern can still match something below a directory in these states
+static bool glob_can_descend(const Glob *glob, const uint64_t *states) {
+    for (int i = 0; i < glob->segment_count; i++) {
+        if (glob_state_has(states, i) && glob->segments[i].type != GLOB_SEGMENT_ACCEPT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+typedef struct {
+    char **patterns;
+    int count;
+} GlobExpansion;
+
+static int glob_expansion_add(GlobExpansion *expansion, char *pattern) {
+    if (expansion->count >= GLOB_MAX_EXPANSIONS) {
+        free(pattern);
+        return E2BIG;
+    }
+
+    char **patterns = realloc(expansion->patterns, (expansion->count + 1) * sizeof(char *));
+    if (!patterns) {
+        free(pattern);
+        return ENOMEM;
+    }
+
+    expansion->patterns = patterns;
+    expansion->patterns[expansion->count++] = pattern;
+    return 0;
+}
+
+// Expands the first "{a,b}" of pattern and recurses into the results, braces without a comma are literals
+static int glob_expand_braces(const char *pattern, GlobExpansion *expansion) {
+    size_t length = strlen(pattern);
+
+    for (size_t open = 0; open < length; open++) {
+        if (pattern[open] == '\\') {
+            open++;
+            continue;
+        }
+        if (pattern[open] != '{') {
+            continue;
+        }
+
+        int depth = 0;
+        size_t close = open;
+        bool has_comma = false;
+        for (size_t i = open; i < length; i++) {
+            if (pattern[i] == '\\') {
+                i++;
+            } else if (pattern[i] == '{') {
+                depth++;
+            } else if (pattern[i] == '}' && --depth == 0) {
+                close = i;
+                break;
+            } else if (pattern[i] == ',' && depth == 1) {
+                has_comma = true;
+            }
+        }
+
+        if (close == open || !has_comma) {
+            continue;
+        }
+
+        size_t start = open + 1;
+        depth = 0;
+        for (size_t i = open + 1; i <= close; i++) {
+            if (pattern[i] == '\\') {
+                i++;
+                continue;
+            }
+            if (pattern[i] == '{') {
+                depth++;
+                continue;
+            }
+            if (pattern[i] == '}' && depth > 0) {
+                depth--;
+                continue;
+            }
+            if ((pattern[i] == ',' && depth == 0) || i == close) {
+                size_t alternative_length = i - start;
+                size_t suffix_length = length - close - 1;
+                char *expanded = malloc(open + alternative_length + suffix_length + 1);
+                if (!expanded) {
+                    return ENOMEM;
+                }
+
+                memcpy(expanded, pattern, open);
+                memcpy(expanded + open, pattern + start, alternative_length);
+                memcpy(expanded + open + alternative_length, pattern + close + 1, suffix_length);
+                expanded[open + alternative_length + suffix_length] = '\0';
+
+                int error = glob_expand_braces(expanded, expansion);
+                free(expanded);
+                if (error) {
+                    return error;
+                }
+                start = i + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    char *copy = strdup(pattern);
+    return copy ? glob_expansion_add(expansion, copy) : ENOMEM;
+}
+
+static bool glob_has_magic(const char *text, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '\\') {
+            i++;
+        } else if (text[i] == '*' || text[i] == '?' || text[i] == '[') {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int glob_add_segment(Glob *glob, int *capacity, int type, const char *text, size_t length) {
+    if (glob->segment_count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 16;
+        GlobSegment *segments = realloc(glob->segments, *capacity * sizeof(GlobSegment));
+        if (!segments) {
+            return ENOMEM;
+        }
+        glob->segments = segments;
+    }
+
+    GlobSegment *segment = &glob->segments[glob->segment_count];
+    memset(segment, 0, sizeof(GlobSegment));
+    segment->type = type;
+
+    if (text) {
+        segment->text = malloc(length + 1);
+        if (!segment->text) {
+            return ENOMEM;
+        }
+
+        if (type == GLOB_SEGMENT_LITERAL) {
+            // Literals are compared as they are, so their escapes are resolved now
+            size_t out = 0;
+            for (size_t i = 0; i < length; i++) {
+                if (text[i] == '\\' && i + 1 < length) {
+                    i++;
+                }
+                segment->text[out++] = text[i];
+            }
+            length = out;
+        } else {
+            memcpy(segment->text, text, length);
+        }
+
+        segment->text[length] = '\0';
+        segment->length = length;
+    }
+
+    glob->segment_count++;
+    return 0;
+}
+
+// Compiles a brace free pattern and appends its segments, returns 0, an errno value or -1 on mixed absolute patterns
+static int glob_compile_pattern(Glob *glob, int *capacity, const char *pattern, bool first) {
+    size_t length = strlen(pattern);
+    bool absolute = length > 0 && pattern[0] == '/';
+    int error;
+
+    if (first) {
+        glob->absolute = absolute;
+    } else if (glob->absolute != absolute) {
+        return -1;
+    }
+
+    int *starts = realloc(glob->starts, (glob->start_count + 1) * sizeof(int));
+    if (!starts) {
+        return ENOMEM;
+    }
+    glob->starts = starts;
+    glob->starts[glob->start_count++] = glob->segment_count;
+
+    for (size_t i = 0; i < length;) {
+        while (i < length && pattern[i] == '/') {
+            i++;
+        }
+
+        size_t start = i;
+        while (i < length && pattern[i] != '/') {
+            i += pattern[i] == '\\' && i + 1 < length ? 2 : 1;
+        }
+
+        size_t segment_length = i - start;
+        const char *segment = pattern + start;
+
+        if (segment_length == 0 || (segment_length == 1 && segment[0] == '.')) {
+            continue;
+        }
+
+        if (segment_length == 2 && segment[0] == '*' && segment[1] == '*') {
+            // "**/**" is the same as "**"
+            if (glob->segment_count > glob->starts[glob->start_count - 1] &&
+                glob->segments[glob->segment_count - 1].type == GLOB_SEGMENT_GLOBSTAR) {
+                continue;
+            }
+            error = glob_add_segment(glob, capacity, GLOB_SEGMENT_GLOBSTAR, NULL, 0);
+        } else {
+            int type = glob_has_magic(segment, segment_length) ? GLOB_SEGMENT_PATTERN : GLOB_SEGMENT_LITERAL;
+            error = glob_add_segment(glob, capacity, type, segment, segment_length);
+        }
+
+        if (error) {
+            return error;
+        }
+    }
+
+    error = glob_add_segment(glob, capacity, GLOB_SEGMENT_ACCEPT, NULL, 0);
+    if (!error) {
+        glob->segments[glob->segment_count - 1].directory_only = length > 0 && pattern[length - 1] == '/';
+    }
+    return error;
+}
+
+static void glob_initial_states(const Glob *glob, uint64_t *states) {
+    memset(states, 0, glob->word_count * sizeof(uint64_t));
+    for (int i = 0; i < glob->start_count; i++) {
+        glob_state_add(states, glob->starts[i]);
+    }
+    glob_closure(glob, states);
+}
+
+static void glob_finalizer(JSRuntime *rt, JSValue val) {
+    Glob *glob = JS_GetOpaque(val, glob_class_id);
+    if (glob) {
+        glob_free(glob);
+    }
+}
+
+static JSClassDef glob_class = {
+    .class_name = "Glob",
+    .finalizer = glob_finalizer,
+};
+
+static JSValue glob_compile(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    const char *pattern;
+    GlobExpansion expansion = {0};
+    int capacity = 0;
+    int error;
+
+    if (argc < 2) {
+        return JS_ThrowTypeError(ctx, "Expected 2 arguments: pattern and dot");
+    }
+
+    Glob *glob = calloc(1, sizeof(Glob));
+    if (!glob) {
+        return JS_ThrowInternalError(ctx, "Memory allocation failed");
+    }
+    glob->dot = JS_ToBool(ctx, argv[1]);
+
+    pattern = JS_ToCString(ctx, argv[0]);
+    if (!pattern) {
+        glob_free(glob);
+        return JS_EXCEPTION;
+    }
+
+    error = glob_expand_braces(pattern, &expansion);
+    JS_FreeCString(ctx, pattern);
+
+    for (int i = 0; i < expansion.count && !error; i++) {
+        error = glob_compile_pattern(glob, &capacity, expansion.patterns[i], i == 0);
+    }
+
+    for (int i = 0; i < expansion.count; i++) {
+        free(expansion.patterns[i]);
+    }
+    free(expansion.patterns);
+
+    if (error) {
+        glob_free(glob);
+        if (error == -1) {
+            return JS_ThrowTypeError(ctx, "A pattern cannot mix absolute and relative alternatives");
+        }
+        if (error == E2BIG) {
+            return JS_ThrowRangeError(ctx, "Pattern expands to more than %d alternatives", GLOB_MAX_EXPANSIONS);
+        }
+        return JS_ThrowInternalError(ctx, "Memory allocation failed");
+    }
+
+    glob->word_count = (glob->segment_count + 63) / 64;
+
+    JSValue handle = JS_NewObjectClass(ctx, glob_class_id);
+    if (JS_IsException(handle)) {
+        glob_free(glob);
+        return JS_EXCEPTION;
+    }
+
+    JS_SetOpaque(handle, glob);
+    return handle;
+}
+
+static Glob *glob_get(JSContext *ctx, JSValueConst value) {
+    Glob *glob = JS_GetOpaque(value, glob_class_id);
+    if (!glob) {
+        JS_ThrowTypeError(ctx, "Invalid glob");
+    }
+    return glob;
+}
+
+static JSValue glob_match_path(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    size_t length;
+    const char *path;
+
+    if (argc < 2) {
+        return JS_ThrowTypeError(ctx, "Expected 2 arguments: glob and path");
+    }
+
+    Glob *glob = glob_get(ctx, argv[0]);
+    if (!glob) {
+        return JS_EXCEPTION;
+    }
+
+    path = JS_ToCStringLen(ctx, &length, argv[1]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    if ((length > 0 && path[0] == '/') != glob->absolute) {
+        JS_FreeCString(ctx, path);
+        return JS_FALSE;
+    }
+
+    uint64_t *states = js_malloc(ctx, glob->word_count * 2 * sizeof(uint64_t));
+    if (!states) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    uint64_t *next = states + glob->word_count;
+    glob_initial_states(glob, states);
+
+    // Segments are matched the way the walk would match them, a trailing slash marks the path as a directory
+    for (size_t i = 0; i < length;) {
+        while (i < length && path[i] == '/') {
+            i++;
+        }
+
+        size_t start = i;
+        while (i < length && path[i] != '/') {
+            i++;
+        }
+
+        if (i == start || (i - start == 1 && path[start] == '.')) {
+            continue;
+        }
+
+        glob_step(glob, states, path + start, i - start, true, next);
+        memcpy(states, next, glob->word_count * sizeof(uint64_t));
+    }
+
+    bool matched = glob_accepts(glob, states, length > 0 && path[length - 1] == '/');
+    js_free(ctx, states);
+    JS_FreeCString(ctx, path);
+    return JS_NewBool(ctx, matched);
+}
+
+#ifndef _WIN32
+
+typedef struct {
+    JSContext *ctx;
+    const Glob *glob;
+    JSValue results;
+    uint32_t count;
+    char *path;
+    size_t path_capacity;
+    bool failed;
+} GlobWalk;
+
+static bool glob_walk_append_name(GlobWalk *walk, size_t path_length, const char *name, size_t name_length,
+                                  size_t *new_length) {
+    bool separator = path_length > 0 && walk->path[path_length - 1] != '/';
+    size_t length = path_length + separator + name_length;
+
+    if (length + 1 > walk->path_capacity) {
+        size_t capacity = walk->path_capacity * 2;
+        while (capacity < length + 1) {
+            capacity *= 2;
+        }
+        char *path = realloc(walk->path, capacity);
+        if (!path) {
+            return false;
+        }
+        walk->path = path;
+        walk->path_capacity = capacity;
+    }
+
+    if (separator) {
+        walk->path[path_length] = '/';
+    }
+    memcpy(walk->path + path_length + separator, name, name_length);
+    walk->path[length] = '\0';
+    *new_length = length;
+    return true;
+}
+
+static void glob_walk_dir(GlobWalk *walk, int dir_fd, size_t path_length, const uint64_t *states);
+
+// Matches one directory entry and descends into it if a pattern can still match below it
+static void glob_walk_entry(GlobWalk *walk, int dir_fd, size_t path_length, const uint64_t *states,
+                            const char *name, unsigned char d_type) {
+    const Glob *glob = walk->glob;
+    size_t name_length = strlen(name);
+    bool is_directory = d_type == DT_DIR;
+    bool is_symlink = d_type == DT_LNK;
+    struct stat st;
+
+    if (d_type == DT_UNKNOWN) {
+        if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            return;
+        }
+        is_directory = S_ISDIR(st.st_mode);
+        is_symlink = S_ISLNK(st.st_mode);
+    }
+
+    // Symlinks get a second set of states to descend with
+    uint64_t *next = malloc(glob->word_count * (is_symlink ? 2 : 1) * sizeof(uint64_t));
+    if (!next) {
+        walk->failed = true;
+        return;
+    }
+
+    glob_step(glob, states, name, name_length, true, next);
+
+    bool accepted = glob_accepts(glob, next, is_directory);
+    uint64_t *descend_states = next;
+
+    // Symlinks are matched by "**" like any other entry, but only explicit segments enter linked directories
+    if (is_symlink) {
+        descend_states = next + glob->word_count;
+        glob_step(glob, states, name, name_length, false, descend_states);
+    }
+
+    bool descend = glob_can_descend(glob, descend_states);
+
+    if (is_symlink && (descend || !accepted)) {
+        is_directory = fstatat(dir_fd, name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+        accepted = glob_accepts(glob, next, is_directory);
+    }
+
+    if (!accepted && !(descend && is_directory)) {
+        free(next);
+        return;
+    }
+
+    size_t new_length;
+    if (!glob_walk_append_name(walk, path_length, name, name_length, &new_length)) {
+        walk->failed = true;
+        free(next);
+        return;
+    }
+
+    if (accepted) {
+        JSValue path = JS_NewStringLen(walk->ctx, walk->path, new_length);
+        if (JS_IsException(path) ||
+            JS_DefinePropertyValueUint32(walk->ctx, walk->results, walk->count++, path, JS_PROP_C_W_E) < 0) {
+            walk->failed = true;
+        }
+    }
+
+    if (descend && is_directory && !walk->failed) {
+        int fd = openat(dir_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd >= 0) {
+            glob_walk_dir(walk, fd, new_length, descend_states);
+        }
+    }
+
+    free(next);
+}
+
+// Reads a directory, takes ownership of dir_fd
+static void glob_walk_dir(GlobWalk *walk, int dir_fd, size_t path_length, const uint64_t *states) {
+    const Glob *glob = walk->glob;
+    bool only_literals = true;
+
+    for (int i = 0; i < glob->segment_count && only_literals; i++) {
+        if (glob_state_has(states, i)) {
+            int type = glob->segments[i].type;
+            only_literals = type == GLOB_SEGMENT_LITERAL || type == GLOB_SEGMENT_ACCEPT;
+        }
+    }
+
+    if (only_literals) {
+        // No wildcard is active, the names are looked up directly instead of reading the whole directory
+        for (int i = 0; i < glob->segment_count && !walk->failed; i++) {
+            const GlobSegment *segment = &glob->segments[i];
+            if (!glob_state_has(states, i) || segment->type != GLOB_SEGMENT_LITERAL) {
+                continue;
+            }
+
+            // Alternatives with the same name are advanced together by glob_step
+            bool seen = false;
+            for (int j = 0; j < i && !seen; j++) {
+                seen = glob_state_has(states, j) && glob->segments[j].type == GLOB_SEGMENT_LITERAL &&
+                       strcmp(glob->segments[j].text, segment->text) == 0;
+            }
+
+            struct stat st;
+            if (seen || fstatat(dir_fd, segment->text, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+
+            unsigned char d_type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISLNK(st.st_mode) ? DT_LNK : DT_REG;
+            glob_walk_entry(walk, dir_fd, path_length, states, segment->text, d_type);
+        }
+
+        close(dir_fd);
+        return;
+    }
+
+    DIR *dir = fdopendir(dir_fd);
+    if (!dir) {
+        close(dir_fd);
+        return;
+    }
+
+    struct dirent *entry;
+    while (!walk->failed && (entry = readdir(dir)) != NULL) {
+        const char *name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+
+        glob_walk_entry(walk, dirfd(dir), path_length, states, name, entry->d_type);
+    }
+
+    closedir(dir);
+}
+
+#endif
+
+static JSValue glob_walk(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+#ifdef _WIN32
+    return JS_ThrowInternalError(ctx, "Globbing the file system is not supported on this platform");
+#else
+    const char *cwd;
+
+    if (argc < 2) {
+        return JS_ThrowTypeError(ctx, "Expected 2 arguments: glob and cwd");
+    }
+
+    Glob *glob = glob_get(ctx, argv[0]);
+    if (!glob) {
+        return JS_EXCEPTION;
+    }
+
+    cwd = JS_ToCString(ctx, argv[1]);
+    if (!cwd) {
+        return JS_EXCEPTION;
+    }
+
+    // Relative patterns yield paths relative to cwd, absolute ones absolute paths
+    int root_fd = open(glob->absolute ? "/" : cwd, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    JS_FreeCString(ctx, cwd);
+    if (root_fd < 0) {
+        return JS_ThrowInternalError(ctx, "Failed to open directory: %s", strerror(errno));
+    }
+
+    GlobWalk walk = {
+        .ctx = ctx,
+        .glob = glob,
+        .results = JS_NewArray(ctx),
+        .path_capacity = 256,
+    };
+    walk.path = malloc(walk.path_capacity);
+    uint64_t *states = malloc(glob->word_count * sizeof(uint64_t));
+
+    if (!walk.path || !states) {
+        free(walk.path);
+        free(states);
+        close(root_fd);
+        JS_FreeValue(ctx, walk.results);
+        return JS_ThrowInternalError(ctx, "Memory allocation failed");
+    }
+
+    size_t path_length = 0;
+    if (glob->absolute) {
+        walk.path[path_length++] = '/';
+    }
+    walk.path[path_length] = '\0';
+
+    glob_initial_states(glob, states);
+    glob_walk_dir(&walk, root_fd, path_length, states);
+
+    free(walk.path);
+    free(states);
+
+    if (walk.failed) {
+        JS_FreeValue(ctx, walk.results);
+        return JS_ThrowInternalError(ctx, "Memory allocation failed");
+    }
+
+    return walk.results;
+#endif
+}
+
+void yaje_path_glob_init(JSRuntime *rt, JSContext *ctx, JSValue path) {
+    JS_NewClassID(rt, &glob_class_id);
+    JS_NewClass(rt, glob_class_id, &glob_class);
+
+    JS_SetPropertyStr(ctx, path, "globCompile", JS_NewCFunction(ctx, glob_compile, "globCompile", 2));
+    JS_SetPropertyStr(ctx, path, "globMatch", JS_NewCFunction(ctx, glob_match_path, "globMatch", 2));
+    JS_SetPropertyStr(ctx, path, "globWalk", JS_NewCFunction(ctx, glob_walk, "globWalk", 2));
+}
@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#define getcwd _getcwd
+#else
+#include <unistd.h>
+#endif
+
+#include "quickjs.h"
+#include "yaje.h"
+#include "path.h"
+
+// Paths are handled as the UTF-8 bytes of the JS strings, "/" and "." never occur inside a multi byte sequence
+
+size_t yaje_path_normalize(const char *path, size_t length, char *out) {
+    bool absolute = length > 0 && path[0] == '/';
+    bool trailing = length > 0 && path[length - 1] == '/';
+    // Segments are written behind the leading slash of an absolute path
+    char *segments = out + absolute;
+    size_t out_length = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        while (i < length && path[i] == '/') {
+            i++;
+        }
+
+        size_t start = i;
+        while (i < length && path[i] != '/') {
+            i++;
+        }
+
+        size_t segment_length = i - start;
+        if (segment_length == 0 || (segment_length == 1 && path[start] == '.')) {
+            continue;
+        }
+
+        if (segment_length == 2 && path[start] == '.' && path[start + 1] == '.') {
+            bool last_is_parent = out_length >= 2 && segments[out_length - 1] == '.' &&
+                                  segments[out_length - 2] == '.' &&
+                                  (out_length == 2 || segments[out_length - 3] == '/');
+
+            if (out_length > 0 && !last_is_parent) {
+                while (out_length > 0 && segments[out_length - 1] != '/') {
+                    out_length--;
+                }
+                if (out_length > 0) {
+                    out_length--;
+                }
+                continue;
+            }
+
+            // Nothing is above the root
+            if (absolute) {
+                continue;
+            }
+        }
+
+        if (out_length > 0) {
+            segments[out_length++] = '/';
+        }
+        memcpy(segments + out_length, path + start, segment_length);
+        out_length += segment_length;
+    }
+
+    if (absolute) {
+        out[0] = '/';
+        out_length++;
+    } else if (out_length == 0) {
+        out[out_length++] = '.';
+    }
+
+    // The root already ends with its slash
+    if (trailing && !(absolute && out_length == 1)) {
+        out[out_length++] = '/';
+    }
+
+    return out_length;
+}
+
+// Concatenates the arguments from first on with "/", skipping empty ones, the result is not normalized
+static char *path_concat(JSContext *ctx, int first, int argc, JSValueConst *argv, size_t *length) {
+    size_t capacity = 256;
+    size_t out_length = 0;
+    char *out = js_malloc(ctx, capacity);
+    if (!out) {
+        return NULL;
+    }
+
+    for (int i = first; i < argc; i++) {
+        size_t part_length;
+        const char *part = JS_ToCStringLen(ctx, &part_length, argv[i]);
+        if (!part) {
+            js_free(ctx, out);
+            return NULL;
+        }
+
+        if (part_length > 0) {
+            // Room for the separator and the two bytes normalizing may add
+            if (out_length + part_length + 3 > capacity) {
+                while (out_length + part_length + 3 > capacity) {
+                    capacity *= 2;
+                }
+                char *grown = js_realloc(ctx, out, capacity);
+                if (!grown) {
+                    JS_FreeCString(ctx, part);
+                    js_free(ctx, out);
+                    return NULL;
+                }
+                out = grown;
+            }
+
+            if (out_length > 0) {
+                out[out_length++] = '/';
+            }
+            memcpy(out + out_length, part, part_length);
+            out_length += part_length;
+        }
+
+        JS_FreeCString(ctx, part);
+    }
+
+    *length = out_length;
+    return out;
+}
+
+// Resolves the arguments to a normalized absolute path without a trailing slash
+static char *path_resolve_args(JSContext *ctx, int argc, JSValueConst *argv, size_t *length) {
+    int first = 0;
+
+    // Everything before the last absolute argument is irrelevant
+    for (int i = argc - 1; i >= 0; i--) {
+        size_t part_length;
+        const char *part = JS_ToCStringLen(ctx, &part_length, argv[i]);
+        if (!part) {
+            return NULL;
+        }
+
+        bool absolute = part_length > 0 && part[0] == '/';
+        JS_FreeCString(ctx, part);
+
+        if (absolute) {
+            first = i;
+            break;
+        }
+    }
+
+    size_t joined_length;
+    char *joined = path_concat(ctx, first, argc, argv, &joined_length);
+    if (!joined) {
+        return NULL;
+    }
+
+    if (joined_length == 0 || joined[0] != '/') {
+        char cwd[4096];
+        if (!getcwd(cwd, sizeof(cwd))) {
+            js_free(ctx, joined);
+            JS_ThrowInternalError(ctx, "Failed to get the working directory: %s", strerror(errno));
+            return NULL;
+        }
+
+        size_t cwd_length = strlen(cwd);
+        char *absolute = js_malloc(ctx, cwd_length + 1 + joined_length + 3);
+        if (!absolute) {
+            js_free(ctx, joined);
+            return NULL;
+        }
+
+        memcpy(absolute, cwd, cwd_length);
+        absolute[cwd_length] = '/';
+        memcpy(absolute + cwd_length + 1, joined, joined_length);
+        js_free(ctx, joined);
+
+        joined = absolute;
+        joined_length += cwd_length + 1;
+    }
+
+    char *out = js_malloc(ctx, joined_length + 2);
+    if (!out) {
+        js_free(ctx, joined);
+        return NULL;
+    }
+
+    size_t out_length = yaje_path_normalize(joined, joined_length, out);
+    js_free(ctx, joined);
+
+    if (out_length > 1 && out[out_length - 1] == '/') {
+        out_length--;
+    }
+
+    *length = out_length;
+    return out;
+}
+
+static JSValue path_join(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    size_t joined_length;
+    char *joined = path_concat(ctx, 0, argc, argv, &joined_length);
+    if (!joined) {
+        return JS_EXCEPTION;
+    }
+
+    char *out = js_malloc(ctx, joined_length + 2);
+    if (!out) {
+        js_free(ctx, joined);
+        return JS_EXCEPTION;
+    }
+
+    size_t out_length = yaje_path_normalize(joined, joined_length, out);
+    JSValue result = JS_NewStringLen(ctx, out, out_length);
+    js_free(ctx, joined);
+    js_free(ctx, out);
+    return result;
+}
+
+static JSValue path_normalize(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    size_t length;
+    const char *path;
+
+    if (argc < 1) {
+        return JS_ThrowTypeError(ctx, "Expected 1 argument: path");
+    }
+
+    path = JS_ToCStringLen(ctx, &length, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    char *out = js_malloc(ctx, length + 2);
+    if (!out) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    size_t out_length = yaje_path_normalize(path, length, out);
+    JSValue result = JS_NewStringLen(ctx, out, out_length);
+    JS_FreeCString(ctx, path);
+    js_free(ctx, out);
+    return result;
+}
+
+static JSValue path_resolve(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    size_t length;
+    char *resolved = path_resolve_args(ctx, argc, argv, &length);
+    if (!resolved) {
+        return JS_EXCEPTION;
+    }
+
+    JSValue result = JS_NewStringLen(ctx, resolved, length);
+    js_free(ctx, resolved);
+    return result;
+}
+
+// Length of the segment starting at path, which points behind a slash
+static size_t path_segment_length(const char *path, const char *end) {
+    const char *slash = memchr(path, '/', end - path);
+    return (slash ? slash : end) - path;
+}
+
+static JSValue path_relative(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    size_t from_length;
+    size_t to_length;
+
+    if (argc < 2) {
+        return JS_ThrowTypeError(ctx, "Expected 2 arguments: from and to");
+    }
+
+    char *from = path_resolve_args(ctx, 1, argv, &from_length);
+    if (!from) {
+        return JS_EXCEPTION;
+    }
+
+    char *to = path_resolve_args(ctx, 1, argv + 1, &to_length);
+    if (!to) {
+        js_free(ctx, from);
+        return JS_EXCEPTION;
+    }
+
+    // Both start with "/", the root is the only path that also ends with one
+    const char *from_end = from + from_length;
+    const char *to_end = to + to_length;
+    const char *f = from_length > 1 ? from + 1 : from_end;
+    const char *t = to_length > 1 ? to + 1 : to_end;
+
+    while (f < from_end && t < to_end) {
+        size_t f_length = path_segment_length(f, from_end);
+        size_t t_length = path_segment_length(t, to_end);
+        if (f_length != t_length || memcmp(f, t, f_length) != 0) {
+            break;
+        }
+
+        f += f_length + (f + f_length < from_end);
+        t += t_length + (t + t_length < to_end);
+    }
+
+    size_t ups = 0;
+    for (const char *p = f; p < from_end; p += path_segment_length(p, from_end) + 1) {
+        ups++;
+    }
+
+    size_t rest_length = to_end - t;
+    char *out = js_malloc(ctx, ups * 3 + rest_length + 1);
+    if (!out) {
+        js_free(ctx, from);
+        js_free(ctx, to);
+        return JS_EXCEPTION;
+    }
+
+    size_t out_length = 0;
+    for (size_t i = 0; i < ups; i++) {
+        if (out_length > 0) {
+            out[out_length++] = '/';
+        }
+        out[out_length++] = '.';
+        out[out_length++] = '.';
+    }
+
+    if (rest_length > 0) {
+        if (out_length > 0) {
+            out[out_length++] = '/';
+        }
+        memcpy(out + out_length, t, rest_length);
+        out_length += rest_length;
+    }
+
+    JSValue result = JS_NewStringLen(ctx, out, out_length);
+    js_free(ctx, from);
+    js_free(ctx, to);
+    js_free(ctx, out);
+    return result;
+}
+
+void yaje_path_init(JSRuntime *rt, JSContext *ctx) {
+    JSValue path = JS_NewObject(ctx);
+
+    JS_SetPropertyStr(ctx, path, "join", JS_NewCFunction(ctx, path_join, "join", 0));
+    JS_SetPropertyStr(ctx, path, "normalize", JS_NewCFunction(ctx, path_normalize, "normalize", 1));
+    JS_SetPropertyStr(ctx, path, "resolve", JS_NewCFunction(ctx, path_resolve, "resolve", 0));
+    JS_SetPropertyStr(ctx, path, "relative", JS_NewCFunction(ctx, path_relative, "relative", 2));
+
+    yaje_path_glob_init(rt, ctx, path);
+
+    yaje_core_register_native(ctx, JS_DupValue(ctx, path), "path");
+    JS_FreeValue(ctx, path);
+}
@@ -0,0 +1,12 @@
+#ifndef YAJE_PATH_H
+#define YAJE_PATH_H
+
+#include "quickjs.h"
+
+// Normalizes length bytes of path into out, which needs room for length + 2 bytes, and returns the new length.
+// "." and empty segments are dropped, ".." removes the segment before it and a trailing slash is kept.
+size_t yaje_path_normalize(const char *path, size_t length, char *out);
+
+void yaje_path_glob_init(JSRuntime *rt, JSContext *ctx, JSValue path);
+
+#endif
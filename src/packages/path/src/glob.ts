@@ -0,0 +1,90 @@
+import "@yaje/core";
+
+export interface GlobOptions {
+    /**
+     * Directory relative patterns are matched against, defaults to the working directory.
+     */
+    cwd?: string;
+    /**
+     * Lets wildcards match names starting with a dot, defaults to false.
+     */
+    dot?: boolean;
+}
+
+/**
+ * Opaque handle of a compiled pattern.
+ */
+interface GlobHandle {
+}
+
+/**
+ * Interface for the glob functions of the "path" native module.
+ */
+interface GlobNative {
+    /**
+     * Compiles a pattern with "*", "?", "[...]", "**" and "{a,b}" once for any number of matches and walks.
+     *
+     * @param pattern - The pattern, either absolute or relative in all of its brace alternatives.
+     * @param dot     - Whether wildcards match names starting with a dot.
+     *
+     * @returns A handle for globMatch and globWalk.
+     */
+    globCompile(pattern: string, dot: boolean): GlobHandle;
+
+    /**
+     * Matches a path without touching the file system, a trailing slash marks the path as a directory.
+     *
+     * @param glob - The compiled pattern.
+     * @param path - The path to match.
+     *
+     * @returns Whether the path matches.
+     */
+    globMatch(glob: GlobHandle, path: string): boolean;
+
+    /**
+     * Walks the file system and only enters directories that can still contain a match. "**" does not follow symlinks,
+     * directories that cannot be read are skipped.
+     *
+     * @param glob - The compiled pattern.
+     * @param cwd  - The directory relative patterns start in.
+     *
+     * @returns The matching paths, relative to cwd for relative patterns and absolute otherwise.
+     */
+    globWalk(glob: GlobHandle, cwd: string): string[];
+}
+
+const native: GlobNative = Native.getModule("path");
+
+export const globber = {
+    native
+}
+
+/**
+ * A compiled glob pattern.
+ */
+export class Glob {
+    private readonly handle: GlobHandle;
+
+    public constructor(pattern: string, dot: boolean = false) {
+        this.handle = native.globCompile(pattern, dot);
+    }
+
+    public match(path: string): boolean {
+        return native.globMatch(this.handle, path);
+    }
+
+    public walk(cwd: string = "."): string[] {
+        return native.globWalk(this.handle, cwd);
+    }
+}
+
+/**
+ * Returns the paths matching a pattern, the order is the one of the file system.
+ *
+ * @param pattern - The pattern to match.
+ * @param options - Working directory and dot handling.
+ */
+export function glob(pattern: string, options: GlobOptions = {}): string[] {
+    const {cwd = ".", dot = false} = options;
+    return new Glob(pattern, dot).walk(cwd);
+}
@@ -0,0 +1,2 @@
+export * from "./path.js";
+export * from "./glob.js";
\ No newline at end of file
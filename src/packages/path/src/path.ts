@@ -0,0 +1,72 @@
+import "@yaje/core";
+
+/**
+ * Interface for the "path" native module. Paths use POSIX semantics, "/" is the only separator.
+ */
+interface PathNative {
+    /**
+     * Joins the non empty segments with "/" and normalizes the result.
+     *
+     * @param segments - The segments to join.
+     *
+     * @returns The joined path, "." if it is empty.
+     */
+    join(...segments: string[]): string;
+
+    /**
+     * Resolves "." and ".." segments and collapses repeated slashes, a trailing slash is kept.
+     *
+     * @param path - The path to normalize.
+     *
+     * @returns The normalized path, "." if it is empty.
+     */
+    normalize(path: string): string;
+
+    /**
+     * Resolves the segments from right to left until an absolute path is formed, the working directory is used if none
+     * is absolute.
+     *
+     * @param segments - The segments to resolve.
+     *
+     * @returns A normalized absolute path without a trailing slash.
+     */
+    resolve(...segments: string[]): string;
+
+    /**
+     * Computes the path from one location to another after resolving both.
+     *
+     * @param from - The start location.
+     * @param to   - The target location.
+     *
+     * @returns The relative path, empty if both resolve to the same path.
+     */
+    relative(from: string, to: string): string;
+}
+
+const native: PathNative = Native.getModule("path");
+
+export const path = {
+    native
+}
+
+export const sep: string = "/";
+
+export function join(...segments: string[]): string {
+    return native.join(...segments);
+}
+
+export function normalize(path: string): string {
+    return native.normalize(path);
+}
+
+export function resolve(...segments: string[]): string {
+    return native.resolve(...segments);
+}
+
+export function relative(from: string, to: string): string {
+    return native.relative(from, to);
+}
+
+export function isAbsolute(path: string): boolean {
+    return path.startsWith(sep);
+}